@@ -23,7 +23,7 @@ auto main() -> int
 	const mth::Matrix<int> m1(3, 3, { 1, 2, 3, 4, 5, 6, 7, 8, 9 });
 	const mth::Matrix<int> m2(3, 3, { 9, 8, 7, 6, 5, 4, 3, 2, 1 });
 
-	const auto test = m1 - m2;
+	const mth::Matrix<int> test = m1 - m2;
 
 	std::cout << test << "\n\n";
 
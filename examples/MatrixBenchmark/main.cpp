@@ -0,0 +1,839 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <charconv>
+#include <string_view>
+#include <numeric>
+
+#include <CustomLibrary/Matrix.h>
+#include <CustomLibrary/Decomposition.h>
+#include <CustomLibrary/MatrixFile.h>
+#include <CustomLibrary/NeuralNet.h>
+#include <CustomLibrary/NetworkFile.h>
+#include <CustomLibrary/ConvNet.h>
+#include <CustomLibrary/Allocator.h>
+#include <CustomLibrary/SparseMatrix.h>
+#include <CustomLibrary/GeneticAlgorithm.h>
+#include <CustomLibrary/RandomGenerator.h>
+#include <CustomLibrary/Timer.h>
+#include <CustomLibrary/Streamer.h>
+
+using namespace ctl;
+
+static rnd::Random<rnd::Mersenne> g_rand;
+
+template<typename F>
+auto seconds(F &&f, size_t reps) -> double
+{
+	Timer t;
+	t.start();
+	for (size_t i = 0; i < reps; ++i) f();
+	return t.ticks<std::chrono::microseconds>().count() / 1e6 / reps;
+}
+
+auto gflops(size_t n, double secs) -> double { return 2. * n * n * n / secs / 1e9; }
+
+// Textbook factorizations the blocked ones are compared against
+
+void lu_naive(mth::Matrix<double> &a)
+{
+	const auto n = a.dim().h;
+	for (size_t k = 0; k < n; ++k)
+	{
+		auto p = k;
+		for (auto i = k + 1; i < n; ++i)
+			if (std::abs(a(k, i)) > std::abs(a(k, p)))
+				p = i;
+		for (size_t j = 0; j < n; ++j) std::swap(a(j, k), a(j, p));
+
+		for (auto i = k + 1; i < n; ++i)
+		{
+			a(k, i) /= a(k, k);
+			for (auto j = k + 1; j < n; ++j) a(j, i) -= a(k, i) * a(j, k);
+		}
+	}
+}
+
+void cholesky_naive(mth::Matrix<double> &a)
+{
+	const auto n = a.dim().h;
+	for (size_t j = 0; j < n; ++j)
+	{
+		for (size_t p = 0; p < j; ++p) a(j, j) -= a(p, j) * a(p, j);
+		a(j, j) = std::sqrt(a(j, j));
+
+		for (auto i = j + 1; i < n; ++i)
+		{
+			for (size_t p = 0; p < j; ++p) a(j, i) -= a(p, i) * a(p, j);
+			a(j, i) /= a(j, j);
+		}
+	}
+}
+
+void qr_naive(mth::Matrix<double> &a)
+{
+	const auto m = a.dim().h, n = a.dim().w;
+	for (size_t k = 0; k < n; ++k)
+	{
+		double norm = 0.;
+		for (auto i = k; i < m; ++i) norm += a(k, i) * a(k, i);
+
+		const auto beta = a(k, k) > 0 ? -std::sqrt(norm) : std::sqrt(norm);
+		const auto v0	= a(k, k) - beta;
+		for (auto i = k + 1; i < m; ++i) a(k, i) /= v0;
+
+		const auto tau = (beta - a(k, k)) / beta;
+		a(k, k)		   = beta;
+
+		for (auto j = k + 1; j < n; ++j)
+		{
+			auto w = a(j, k);
+			for (auto i = k + 1; i < m; ++i) w += a(k, i) * a(j, i);
+			a(j, k) -= tau * w;
+			for (auto i = k + 1; i < m; ++i) a(j, i) -= tau * w * a(k, i);
+		}
+	}
+}
+
+// Largest element of |A * X - B|
+template<typename X>
+auto residual(const mth::Matrix<double> &a, const X &x, const mth::Matrix<double> &b) -> double
+{
+	const auto r = a.dot_product(x);
+
+	double e = 0.;
+	for (size_t i = 0; i < r.size(); ++i) e = std::max(e, std::abs(r.data()[i] - b.data()[i]));
+
+	return e;
+}
+
+// Individual of the genetic algorithm section
+struct Agent
+{
+	std::array<float, 16> genes{};
+	double				  score = 0.;
+
+	auto fitness() const noexcept -> double { return score; }
+};
+
+// Uniform crossover with a small mutation
+template<typename G>
+void breed(const Agent &a, const Agent &b, Agent &child, G &rng)
+{
+	std::uniform_real_distribution<float> mutate(-.01f, .01f);
+	for (size_t i = 0; i < child.genes.size(); ++i) child.genes[i] = ((rng() & 1) ? a : b).genes[i] + mutate(rng);
+}
+
+// Roulette selection scanning the population for every parent, which mcl::select replaced
+void select_naive(const std::vector<Agent> &pop, std::vector<Agent> &next, rnd::Mersenne &rng)
+{
+	auto total = 0.;
+	for (const auto &a : pop) total += a.fitness() + 1.;
+
+	std::uniform_real_distribution<> peak(0., total);
+	for (auto &child : next)
+	{
+		const Agent *parents[2];
+		for (auto &parent : parents)
+		{
+			auto i = pop.begin();
+			for (auto p = peak(rng); p >= 0.; ++i) p -= i->fitness() + 1.;
+			parent = &*(i - 1);
+		}
+		breed(*parents[0], *parents[1], child, rng);
+	}
+}
+
+auto main(int argc, char **argv) -> int
+{
+	size_t max_n = 2048, scale_n = 1024;
+	if (argc > 1)
+		std::from_chars(argv[1], argv[1] + std::string_view(argv[1]).size(), max_n);
+	if (argc > 2)
+		std::from_chars(argv[2], argv[2] + std::string_view(argv[2]).size(), scale_n);
+
+	const auto init = [] { return g_rand.rand_number(-1., 1.); };
+
+	// --------------------------------- GEMM -----------------------------------------
+
+	std::cout << std::setw(6) << "n" << std::setw(16) << "naive GFLOP/s" << std::setw(16) << "blocked GFLOP/s"
+			  << std::setw(12) << "max error" << '\n';
+
+	for (size_t n = 64; n <= max_n; n *= 2)
+	{
+		const mth::Matrix<double> a(n, n, init), b(n, n, init);
+		const auto				  reps = std::max<size_t>(1, (256 * 256 * 256) / (n * n * n));
+
+		mth::Matrix<double> c_naive(n, n, 0.), c_blocked(n, n, 0.);
+
+		// Naive loop is only timed where it finishes in reasonable time
+		double t_naive = 0.;
+		if (n <= 1024)
+			t_naive = seconds(
+				[&] {
+					c_naive = 0.;
+					mth::kernel::gemm_naive(n, n, n, a.data(), n, 1, b.data(), n, 1, c_naive.data(), n);
+				},
+				reps);
+
+		const auto t_blocked = seconds(
+			[&] {
+				c_blocked = 0.;
+				mth::kernel::gemm_blocked(n, n, n, a.data(), n, 1, b.data(), n, 1, c_blocked.data(), n);
+			},
+			reps);
+
+		double err = 0.;
+		if (n <= 1024)
+			for (size_t i = 0; i < c_naive.size(); ++i) err = std::max(err, std::abs(c_naive[i] - c_blocked[i]));
+
+		std::cout << std::setw(6) << n << std::setw(16) << (n <= 1024 ? gflops(n, t_naive) : 0.) << std::setw(16)
+				  << gflops(n, t_blocked) << std::setw(12) << err << '\n';
+	}
+
+	// --------------------------------- Transpose -----------------------------------------
+
+	std::cout << '\n'
+			  << std::setw(6) << "n" << std::setw(14) << "naive GB/s" << std::setw(14) << "tiled GB/s" << std::setw(14)
+			  << "square GB/s" << std::setw(14) << "cycles GB/s" << '\n';
+
+	for (size_t n = 256; n <= max_n * 2; n *= 2)
+	{
+		mth::Matrix<float> a(n, n, [] { return g_rand.rand_number(-1.f, 1.f); }), t(n, n, 0.f);
+		mth::Matrix<float> rect(n, n / 2, [] { return g_rand.rand_number(-1.f, 1.f); });
+
+		const auto reps	 = std::max<size_t>(1, (1024 * 1024) / (n * n));
+		const auto bytes = 2. * sizeof(float) * n * n;
+
+		const auto t_naive = seconds(
+			[&] {
+				for (size_t x = 0; x < n; ++x)
+					for (size_t y = 0; y < n; ++y) t[x * n + y] = a[y * n + x];
+			},
+			reps);
+		const auto t_tiled	= seconds([&] { t = a.transpose(); }, reps);
+		const auto t_square = seconds([&] { a.transpose_inplace(); }, reps);
+		const auto t_cycles = seconds([&] { rect.transpose_inplace(); }, reps);
+
+		std::cout << std::setw(6) << n << std::setw(14) << bytes / t_naive / 1e9 << std::setw(14)
+				  << bytes / t_tiled / 1e9 << std::setw(14) << bytes / t_square / 1e9 << std::setw(14)
+				  << bytes / 2 / t_cycles / 1e9 << '\n';
+	}
+
+	// --------------------------------- Temporaries -----------------------------------------
+
+	{
+		// A small layer step producing several temporaries, once through malloc and once from a arena reset per step
+		const auto step = [&]<typename A>(const A &alloc) {
+			const mth::Matrix<double, A> w(16, 16, 0.5, alloc), x(16, 1, 1., alloc), b(16, 1, 0.1, alloc);
+
+			for (size_t i = 0; i < 200000; ++i)
+			{
+				mem::ArenaScope scope;
+
+				const mth::Matrix<double, A> y = w.dot_product(x) + b;
+				const mth::Matrix<double, A> d = (y - x) * 0.5;
+				const auto					 g = d.dot_product(x.view().transpose());
+			}
+		};
+
+		const auto t_malloc = seconds([&] { step(std::allocator<double>()); }, 1);
+		const auto t_arena	= seconds([&] { step(mem::ArenaAllocator<double>()); }, 1);
+
+		std::cout << "\nTemporaries  malloc: " << t_malloc << "s  arena: " << t_arena << "s\n";
+	}
+
+	// --------------------------------- Sparse -----------------------------------------
+
+	std::cout << '\n'
+			  << std::setw(10) << "density" << std::setw(14) << "dense ms" << std::setw(14) << "CSR ms" << std::setw(14)
+			  << "CSC ms" << std::setw(14) << "dense MiB" << std::setw(14) << "CSR MiB" << '\n';
+
+	for (const auto density : { 0.2, 0.05, 0.01 })
+	{
+		const auto n = std::min<size_t>(max_n, 1024);
+
+		const mth::Matrix<double> a(n, n, [&] { return g_rand.rand_number(0., 1.) < density ? init() : 0.; });
+		const mth::Matrix<double> b(n, 64, init);
+
+		const mth::CSRMatrix<double> csr(a);
+		const mth::CSCMatrix<double> csc(csr);
+
+		const auto t_dense = seconds([&] { (void)a.dot_product(b); }, 3);
+		const auto t_csr   = seconds([&] { (void)csr.dot_product(b); }, 3);
+		const auto t_csc   = seconds([&] { (void)csc.dot_product(b); }, 3);
+
+		const auto bytes_csr = csr.nnz() * (sizeof(double) + sizeof(std::uint32_t)) + (n + 1) * sizeof(size_t);
+
+		std::cout << std::setw(10) << density << std::setw(14) << t_dense * 1e3 << std::setw(14) << t_csr * 1e3
+				  << std::setw(14) << t_csc * 1e3 << std::setw(14) << a.size() * sizeof(double) / 1048576.
+				  << std::setw(14) << bytes_csr / 1048576. << '\n';
+	}
+
+	// --------------------------------- Reductions -----------------------------------------
+
+	{
+		const auto				  n = std::min<size_t>(max_n, 2048);
+		const mth::Matrix<double> a(n, n, init), bias(n, 1, init);
+		mth::Matrix<double>		  out(n, n, 0.);
+
+		double	   sink		= 0.;
+		const auto t_scalar = seconds(
+			[&] {
+				double s = 0.;
+				for (const auto x : a) s += x;
+				sink += s;
+			},
+			20);
+		const auto t_sum = seconds([&] { sink += mth::sum(a); }, 20);
+		const auto t_par = seconds([&] { sink += mth::sum(exe::par(), a); }, 20);
+
+		// Bias column added to every column of a batch, once through a full size copy of the bias
+		const auto t_full = seconds(
+			[&] {
+				const mth::Matrix<double> full(n, n, [&, i = size_t(0)]() mutable { return bias[i++ / n]; });
+				out = a + full;
+			},
+			10);
+		const auto t_bcast = seconds([&] { out = a + mth::broadcast(bias, a.dim()); }, 10);
+
+		const auto gbs = [&](double t) { return a.size() * sizeof(double) / t / 1e9; };
+		std::cout << "\nSum GB/s  scalar: " << gbs(t_scalar) << "  simd: " << gbs(t_sum) << "  parallel: " << gbs(t_par)
+				  << "\nBias ms  materialized: " << t_full * 1e3 << "  broadcast: " << t_bcast * 1e3 << "  (" << sink
+				  << ")\n";
+	}
+
+	// --------------------------------- Mixed Precision -----------------------------------------
+
+	{
+		const auto				  n = std::min<size_t>(max_n, 2048);
+		const mth::Matrix<double> a(n, n, init), x(n, 1, init);
+		const mth::Matrix<float>  af(a);
+		const mth::Matrix<mth::f16>	 ah(af);
+		const mth::Matrix<mth::bf16> ab(af);
+
+		mth::Matrix<float> back(n, n, 0.f);
+
+		const auto t_to_half	= seconds([&] { (void)mth::Matrix<mth::f16>(af); }, 10);
+		const auto t_from_half	= seconds([&] { back = ah; }, 10);
+		const auto t_to_bfloat	= seconds([&] { (void)mth::Matrix<mth::bf16>(af); }, 10);
+		const auto t_from_bfloat = seconds([&] { back = ab; }, 10);
+
+		// Matrix vector products are bound by the bandwidth of the weights
+		double	   sink = 0.;
+		const auto t_double = seconds([&] { sink += a.dot_product(x)[0]; }, 20);
+		const auto t_half	= seconds([&] { sink += ah.dot_product(x)[0]; }, 20);
+		const auto t_bfloat = seconds([&] { sink += ab.dot_product(x)[0]; }, 20);
+
+		const auto y = a.dot_product(x), yh = ah.dot_product(x), yb = ab.dot_product(x);
+
+		double e_half = 0., e_bfloat = 0.;
+		for (size_t i = 0; i < n; ++i)
+			e_half = std::max(e_half, std::abs(y[i] - yh[i])), e_bfloat = std::max(e_bfloat, std::abs(y[i] - yb[i]));
+
+		const auto gbs = [&](double t) { return af.size() * (sizeof(float) + 2) / t / 1e9; };
+		std::cout << "\nConvert GB/s  float->f16: " << gbs(t_to_half) << "  f16->float: " << gbs(t_from_half)
+				  << "  float->bf16: " << gbs(t_to_bfloat) << "  bf16->float: " << gbs(t_from_bfloat)
+				  << "\nGEMV ms  double: " << t_double * 1e3 << "  f16: " << t_half * 1e3
+				  << "  bf16: " << t_bfloat * 1e3 << "  max error f16: " << e_half << "  bf16: " << e_bfloat << "  ("
+				  << sink << ")\n";
+	}
+
+	// --------------------------------- Quantization -----------------------------------------
+
+	{
+		const auto				   n = std::min<size_t>(max_n, 2048);
+		const mth::Matrix<double>  a(n, n, init), x(n, 1, init);
+		const mth::QuantizedMatrix aq(a);
+
+		double	   sink		= 0.;
+		const auto t_double = seconds([&] { sink += a.dot_product(x)[0]; }, 20);
+		const auto t_int8	= seconds([&] { sink += aq.dot_product(x)[0]; }, 20);
+
+		const auto y = a.dot_product(x), yq = aq.dot_product(x);
+
+		double err = 0., mag = 0.;
+		for (size_t i = 0; i < n; ++i) err = std::max(err, std::abs(y[i] - yq[i])), mag = std::max(mag, std::abs(y[i]));
+
+		// Scoring sized network, dynamic and calibrated activation ranges
+		const mcl::BasicNeuralNetwork nn({ 784, 256, 128, 10 }, [] { return g_rand.rand_number(-.1, .1); });
+
+		std::vector<mth::Matrix<double>> samples;
+		for (size_t i = 0; i < 64; ++i) samples.emplace_back(784, 1, [] { return g_rand.rand_number(0., 1.); });
+
+		const mcl::QuantizedNeuralNetwork qnn(nn), qnn_cal(nn, samples.begin(), samples.end());
+
+		size_t	   s	   = 0;
+		const auto t_query = seconds([&] { sink += nn.query(samples[s++ % samples.size()])[0]; }, 200);
+		const auto t_qdyn  = seconds([&] { sink += qnn.query(samples[s++ % samples.size()])[0]; }, 200);
+		const auto t_qcal  = seconds([&] { sink += qnn_cal.query(samples[s++ % samples.size()])[0]; }, 200);
+
+		double nn_err = 0.;
+		for (const auto &in : samples)
+		{
+			const auto p = nn.query(in), q = qnn_cal.query(in);
+			for (size_t i = 0; i < p.size(); ++i) nn_err = std::max(nn_err, std::abs(p[i] - q[i]));
+		}
+
+		std::cout << "\nGEMV ms  double: " << t_double * 1e3 << "  int8: " << t_int8 * 1e3
+				  << "  relative error: " << err / mag << "\nQuery us  double: " << t_query * 1e6
+				  << "  int8 dynamic: " << t_qdyn * 1e6 << "  int8 calibrated: " << t_qcal * 1e6
+				  << "  max output error: " << nn_err << "  (" << sink << ")\n";
+	}
+
+	// --------------------------------- Batched Inference -----------------------------------------
+
+	{
+		const mcl::BasicNeuralNetwork nn({ 784, 256, 128, 10 }, [] { return g_rand.rand_number(-.1, .1); });
+
+		std::cout << '\n' << std::setw(8) << "batch" << std::setw(20) << "query samples/s" << std::setw(20)
+				  << "batch samples/s" << std::setw(20) << "parallel samples/s" << '\n';
+
+		for (const size_t batch : { 1, 16, 64, 256 })
+		{
+			const mth::Matrix<double> x(784, batch, [] { return g_rand.rand_number(0., 1.); });
+
+			std::vector<mth::Matrix<double>> columns;
+			for (size_t j = 0; j < batch; ++j) columns.emplace_back(x.col(j));
+
+			double	   sink	   = 0.;
+			const auto reps	   = std::max<size_t>(1, 256 / batch);
+			const auto t_query = seconds([&] { for (const auto &c : columns) sink += nn.query(c)[0]; }, reps);
+			const auto t_batch = seconds([&] { sink += nn.query_batch(x)[0]; }, reps);
+			const auto t_par   = seconds([&] { sink += nn.query_batch(exe::par(), x)[0]; }, reps);
+
+			std::cout << std::setw(8) << batch << std::setw(20) << batch / t_query << std::setw(20) << batch / t_batch
+					  << std::setw(20) << batch / t_par << (sink == 0. ? "!" : "") << '\n';
+		}
+
+		// Single sample latency: query vs. the frozen network
+		mcl::FrozenNeuralNetwork frozen(nn);
+
+		const mth::Matrix<double> x(784, 1, [] { return g_rand.rand_number(0., 1.); });
+		std::vector<float>		  in(x.data(), x.data() + x.size()), out(frozen.outputs());
+
+		double	   sink		= 0.;
+		const auto t_query	= seconds([&] { sink += nn.query(x)[0]; }, 1000);
+		const auto t_frozen = seconds(
+			[&] {
+				frozen.infer(in, out);
+				sink += out[0];
+			},
+			1000);
+
+		std::cout << "Single sample us  query: " << t_query * 1e6 << "  frozen: " << t_frozen * 1e6
+				  << (sink == 0. ? "!" : "") << '\n';
+	}
+
+	// --------------------------------- Training -----------------------------------------
+
+	{
+		// Synthetic dataset: the target is a fixed random network's output on random inputs
+		const size_t				  samples = 4096;
+		const mcl::BasicNeuralNetwork teacher({ 64, 32, 10 }, [] { return g_rand.rand_number(-1., 1.); });
+
+		const mth::Matrix<double> inputs(64, samples, [] { return g_rand.rand_number(0., 1.); });
+		const auto				  outputs = teacher.query_batch(inputs);
+
+		std::vector<mth::Matrix<double>> in_cols, out_cols;
+		for (size_t j = 0; j < samples; ++j) in_cols.emplace_back(inputs.col(j)), out_cols.emplace_back(outputs.col(j));
+
+		const auto small = [] { return g_rand.rand_number(-.1, .1); };
+
+		auto	   online	= mcl::BasicNeuralNetwork({ 64, 128, 10 }, small);
+		const auto t_online = seconds(
+			[&] {
+				for (size_t j = 0; j < samples; ++j) mcl::fit(online, in_cols[j], out_cols[j]);
+			},
+			1);
+
+		auto batched = mcl::BasicNeuralNetwork({ 64, 128, 10 }, small), parallel = batched;
+		mcl::MiniBatchTrainer seq_trainer(batched, 32), par_trainer(parallel, 32, exe::par());
+
+		const auto t_seq = seconds([&] { seq_trainer.fit_epoch(inputs, outputs); }, 3);
+		const auto t_par = seconds([&] { par_trainer.fit_epoch(exe::par(), inputs, outputs); }, 3);
+
+		std::cout << "\nEpoch samples/s  online fit: " << samples / t_online << "  batch 32: " << samples / t_seq
+				  << "  batch 32 with " << par_trainer.shards() << " shards: " << samples / t_par << '\n';
+
+		// Loss after a few epochs per optimizer, same start and batches
+		const auto mse	 = [&](const auto &nn) { return mcl::loss(nn, inputs, outputs); };
+		const auto start = mcl::BasicNeuralNetwork({ 64, 128, 10 }, small);
+
+		const auto train = [&](auto opt) {
+			auto				  nn = start;
+			mcl::MiniBatchTrainer trainer(nn, 32);
+			for (size_t e = 0; e < 5; ++e) trainer.fit_epoch(inputs, outputs, opt);
+			return mse(nn);
+		};
+
+		std::cout << "MSE after 5 epochs  initial: " << mse(start) << "  sgd: " << train(mcl::SGD(.1))
+				  << "  momentum: " << train(mcl::Momentum(.01)) << "  rmsprop: " << train(mcl::RMSProp(.001))
+				  << "  adam: " << train(mcl::Adam(.001)) << '\n';
+
+		// One Adam step over a parameter matrix, fused vs. with matrix temporaries
+		const auto				  n = std::min<size_t>(max_n, 1024);
+		const mth::Matrix<double> g(n, n, init);
+		mth::Matrix<double>		  p(n, n, init), m(n, n, 0.), v(n, n, 0.);
+
+		mcl::Adam adam;
+		adam.init(0, p.size());
+
+		const auto t_fused = seconds(
+			[&] {
+				adam.step();
+				adam.update(0, p.data(), g.data(), 0, p.size(), 1.);
+			},
+			20);
+		const auto t_temps = seconds(
+			[&] {
+				m = .9 * m + .1 * g;
+				v = .999 * v + .001 * g * g;
+				mth::Matrix<double> root(v);
+				root.apply([](double x) { return std::sqrt(x) + 1e-8; });
+				p += .001 * m / root;
+			},
+			20);
+
+		std::cout << "Adam step ms  fused: " << t_fused * 1e3 << "  temporaries: " << t_temps * 1e3 << '\n';
+
+		// Data parallel replicas: copy the network and average the parameters back, one buffer each
+		const auto	big = mcl::BasicNeuralNetwork({ 784, 1024, 1024, 10 }, small);
+		std::vector replicas(4, big);
+
+		const auto t_copy	 = seconds([&] { replicas.front() = big; }, 10);
+		const auto t_average = seconds(
+			[&] {
+				auto avg = replicas.front().parameters();
+				for (auto r = replicas.begin() + 1; r != replicas.end(); ++r)
+					simd::transform(avg.data(), avg.data(), r->parameters().data(), avg.size(), simd::Add{});
+				simd::transform(avg.data(), avg.data(), 1. / replicas.size(), avg.size(), simd::Mul{});
+			},
+			10);
+
+		std::cout << "Replicas of " << big.parameters().size_bytes() / 1048576. << " MiB ms  copy: " << t_copy * 1e3
+				  << "  average of " << replicas.size() << ": " << t_average * 1e3 << '\n';
+
+		// Dataset evaluation: per sample cost vs. batched loss
+		const auto t_cost = seconds([&] { mcl::cost(start, in_cols.begin(), in_cols.end(), out_cols.begin()); }, 3);
+		const auto t_loss = seconds([&] { static_cast<void>(mcl::loss(start, inputs, outputs)); }, 10);
+		const auto t_ploss = seconds([&] { static_cast<void>(mcl::loss(exe::par(), start, inputs, outputs)); }, 10);
+
+		std::cout << "Dataset loss samples/s  cost: " << samples / t_cost << "  loss: " << samples / t_loss
+				  << "  parallel loss: " << samples / t_ploss << '\n';
+	}
+
+	// --------------------------------- Activations -----------------------------------------
+
+	{
+		// A hidden layer's outputs for a batch of 256
+		const mth::Matrix<double> z(1024, 256, [] { return g_rand.rand_number(-4., 4.); });
+		mth::Matrix<double>		  a(z.dim().h, z.dim().w, 0.);
+
+		const auto t_scalar = seconds([&] { (a = z).apply(sigmoid<double>); }, 20);
+
+		std::cout << "\nActivation Melem/s  scalar sigmoid: " << z.size() / t_scalar / 1e6;
+		for (const auto &[name, f] :
+			 { std::pair{ "sigmoid", mcl::Activation::sigmoid }, std::pair{ "tanh", mcl::Activation::tanh },
+			   std::pair{ "relu", mcl::Activation::relu }, std::pair{ "softmax", mcl::Activation::softmax } })
+		{
+			const auto t = seconds(
+				[&] {
+					a = z;
+					mcl::activate(f, a.data(), a.dim().h, a.dim().w);
+				},
+				20);
+			std::cout << "  " << name << ": " << z.size() / t / 1e6;
+		}
+		std::cout << '\n';
+	}
+
+	// --------------------------------- Convolution -----------------------------------------
+
+	{
+		// Every layer type on its own for a batch of 64 images
+		const size_t batch = 64;
+		const auto	 init  = [] { return g_rand.rand_number(-.1, .1); };
+
+		std::cout << '\n' << std::setw(32) << "layer" << std::setw(16) << "samples/s" << std::setw(10) << "GFLOP/s\n";
+
+		const auto run = [&](const char *name, mcl::Shape in, auto &&build, size_t macs) {
+			mcl::ConvNeuralNetwork nn(in);
+			build(nn);
+			nn.initialize(init);
+
+			const mth::Matrix<double> x(in.size(), batch, [] { return g_rand.rand_number(0., 1.); });
+
+			const auto t = seconds([&] { static_cast<void>(nn.query_batch(x)); }, 5);
+
+			std::cout << std::setw(32) << name << std::setw(16) << batch / t << std::setw(10);
+			if (macs > 0)
+				std::cout << 2. * macs * batch / t / 1e9;
+			std::cout << '\n';
+		};
+
+		for (const auto &[name, algo] : { std::pair{ "im2col", mcl::ConvAlgorithm::im2col },
+										 std::pair{ "direct", mcl::ConvAlgorithm::direct } })
+		{
+			run((std::string("conv 3x3 1->16 28x28 ") + name).c_str(), { 1, 28, 28 },
+				[&](auto &nn) { nn.add_conv2d(16, 3, mcl::Activation::relu, 1, 1, algo); }, 16 * 9 * 28 * 28);
+			run((std::string("conv 3x3 16->32 14x14 ") + name).c_str(), { 16, 14, 14 },
+				[&](auto &nn) { nn.add_conv2d(32, 3, mcl::Activation::relu, 1, 1, algo); }, 32 * 16 * 9 * 14 * 14);
+		}
+		run("conv 5x5 16->32 14x14 im2col", { 16, 14, 14 },
+			[](auto &nn) { nn.add_conv2d(32, 5, mcl::Activation::relu, 1, 2); }, 32 * 16 * 25 * 14 * 14);
+		run("max pool 2x2 16x28x28", { 16, 28, 28 }, [](auto &nn) { nn.add_max_pool(2); }, 0);
+		run("avg pool 2x2 16x28x28", { 16, 28, 28 }, [](auto &nn) { nn.add_avg_pool(2); }, 0);
+		run("flatten + dense 3136->10", { 16, 14, 14 },
+			[](auto &nn) {
+				nn.add_flatten();
+				nn.add_dense(10, mcl::Activation::softmax);
+			},
+			3136 * 10);
+
+		// Training throughput of a small image classifier
+		mcl::ConvNeuralNetwork cnn({ 1, 28, 28 });
+		cnn.add_conv2d(8, 3, mcl::Activation::relu, 1, 1);
+		cnn.add_max_pool(2);
+		cnn.add_conv2d(16, 3, mcl::Activation::relu, 1, 1);
+		cnn.add_max_pool(2);
+		cnn.add_flatten();
+		cnn.add_dense(10, mcl::Activation::softmax);
+		cnn.initialize(init);
+
+		const mth::Matrix<double> x(784, batch, [] { return g_rand.rand_number(0., 1.); });
+		mth::Matrix<double>		  y(10, batch, 0.);
+		for (size_t j = 0; j < batch; ++j) y.data()[(j % 10) * batch + j] = 1.;
+
+		mcl::Adam  opt;
+		const auto t_query = seconds([&] { static_cast<void>(cnn.query_batch(x)); }, 5);
+		const auto t_fit   = seconds([&] { mcl::fit(cnn, x, y, opt); }, 5);
+
+		std::cout << "CNN 28x28 samples/s  query: " << batch / t_query << "  fit: " << batch / t_fit << '\n';
+	}
+
+	// --------------------------------- Serialization -----------------------------------------
+
+	{
+		const auto				  n = std::min<size_t>(max_n, 1024);
+		const mth::Matrix<double> a(n, n, init);
+
+		const auto dir = std::filesystem::temp_directory_path();
+		const auto txt = dir / "ctl_bench.txt", bin = dir / "ctl_bench.bin";
+
+		{
+			std::ofstream t(txt), b(bin, std::ios::binary);
+			t << a;
+			mth::write(b, a);
+		}
+
+		mth::Matrix<double> m;
+
+		const auto t_text = seconds(
+			[&] {
+				std::ifstream in(txt);
+				in >> m;
+			},
+			1);
+		const auto t_bin = seconds(
+			[&] {
+				std::ifstream in(bin, std::ios::binary);
+				m = mth::read<double>(in);
+			},
+			3);
+		const auto t_map = seconds([&] { (void)mth::map_matrix<double>(bin); }, 3);
+		const auto t_sum = seconds([&] { (void)mth::sum(mth::map_matrix<double>(bin)); }, 3);
+
+		std::cout << "\nLoad " << a.size() * sizeof(double) / 1048576. << " MiB ms  text: " << t_text * 1e3
+				  << "  binary: " << t_bin * 1e3 << "  mmap: " << t_map * 1e3 << "  mmap + sum: " << t_sum * 1e3
+				  << '\n';
+
+		std::filesystem::remove(txt);
+		std::filesystem::remove(bin);
+
+		// Cold start of a scoring network: parse the text format, read or map the binary checkpoint
+		const mcl::BasicNeuralNetwork nn({ 784, 1024, 1024, 10 }, [] { return g_rand.rand_number(-.1, .1); });
+		const mth::Matrix<double>	  x(784, 1, [] { return g_rand.rand_number(0., 1.); });
+
+		const auto ck = dir / "ctl_bench.ckpt";
+		{
+			std::ofstream t(txt);
+			t << nn;
+		}
+		mcl::save(ck, nn);
+
+		double	   sink		= 0.;
+		const auto t_nn_txt = seconds(
+			[&] {
+				std::ifstream			in(txt);
+				mcl::BasicNeuralNetwork loaded;
+				in >> loaded;
+				sink += loaded.query(x)[0];
+			},
+			1);
+		const auto t_nn_bin = seconds([&] { sink += mcl::load(ck).query(x)[0]; }, 3);
+		const auto t_nn_map = seconds([&] { sink += mcl::MappedNeuralNetwork(ck).query(x)[0]; }, 3);
+
+		std::cout << "Network load + first query ms  text: " << t_nn_txt * 1e3 << "  checkpoint: " << t_nn_bin * 1e3
+				  << "  mapped checkpoint: " << t_nn_map * 1e3 << "  (" << sink << ")\n";
+
+		std::filesystem::remove(txt);
+		std::filesystem::remove(ck);
+	}
+
+	// --------------------------------- Genetic Algorithm -----------------------------------------
+
+	{
+		const auto score = [](std::span<Agent> pop) {
+			for (auto &a : pop) a.score = std::abs(std::accumulate(a.genes.begin(), a.genes.end(), 0.f));
+		};
+
+		std::cout << '\n'
+				  << std::setw(8) << "agents" << std::setw(14) << "naive ms" << std::setw(14) << "select ms"
+				  << std::setw(14) << "engine ms" << std::setw(16) << "engine par ms" << '\n';
+
+		exe::ThreadPool pool;
+
+		for (size_t n : { 1000, 10000, 100000 })
+		{
+			std::vector<Agent> pop(n), next(n);
+			for (auto &a : pop)
+				for (auto &g : a.genes) g = g_rand.rand_number(-1.f, 1.f);
+			score(pop);
+
+			rnd::Mersenne rng(1);
+			const auto	  select = [&] {
+				   mcl::select(pop.begin(), pop.end(), next.begin(), g_rand, [&](const Agent &a, const Agent &b) {
+					   Agent c;
+					   breed(a, b, c, rng);
+					   return c;
+				   });
+			};
+
+			const auto t_naive	= n <= 10000 ? seconds([&] { select_naive(pop, next, rng); }, 1) : 0.;
+			const auto t_select = seconds(select, 3);
+
+			mcl::GeneticEngine<Agent> seq(pop, 1), par(pop, 1);
+
+			const auto t_seq = seconds([&] { seq.evolve(breed<rnd::Mersenne>); }, 3);
+			const auto t_par = seconds([&] { par.evolve(exe::par(pool), breed<rnd::Mersenne>); }, 3);
+
+			score(seq.population());
+
+			std::cout << std::setw(8) << n << std::setw(14);
+			if (t_naive > 0.)
+				std::cout << t_naive * 1e3;
+			else
+				std::cout << "";
+			std::cout << std::setw(14) << t_select * 1e3 << std::setw(14) << t_seq * 1e3 << std::setw(16) << t_par * 1e3
+					  << '\n';
+		}
+
+		std::cout << '\n'
+				  << std::setw(12) << "strategy" << std::setw(14) << "100k gen ms" << std::setw(18) << "score after 50"
+				  << '\n';
+
+		const std::pair<const char *, mcl::Strategy> strategies[] = {
+			{ "roulette", { mcl::Selection::roulette } },		 { "rank", { mcl::Selection::rank } },
+			{ "tournament", { mcl::Selection::tournament, 4 } }, { "universal", { mcl::Selection::universal } },
+			{ "elite 2%", { mcl::Selection::tournament, 4, 20 } }
+		};
+
+		for (const auto &[name, strategy] : strategies)
+		{
+			std::vector<Agent> pop(100000);
+			for (auto &a : pop)
+				for (auto &g : a.genes) g = g_rand.rand_number(-1.f, 1.f);
+			score(pop);
+
+			mcl::GeneticEngine<Agent> timed(pop, 1, strategy), small({ pop.begin(), pop.begin() + 1000 }, 1, strategy);
+
+			const auto t_gen = seconds([&] { timed.evolve(exe::par(pool), breed<rnd::Mersenne>); }, 3);
+
+			for (size_t g = 0; g < 50; ++g)
+			{
+				small.evolve(breed<rnd::Mersenne>);
+				score(small.population());
+			}
+
+			double best = 0.;
+			for (const auto &a : small.population()) best = std::max(best, a.score);
+
+			std::cout << std::setw(12) << name << std::setw(14) << t_gen * 1e3 << std::setw(18) << best << '\n';
+		}
+	}
+
+	// --------------------------------- Decompositions -----------------------------------------
+
+	std::cout << '\n'
+			  << std::setw(6) << "n" << std::setw(14) << "LU naive ms" << std::setw(12) << "LU ms"
+			  << std::setw(14) << "Chol naive ms" << std::setw(12) << "Chol ms" << std::setw(14) << "QR naive ms"
+			  << std::setw(12) << "QR ms" << std::setw(12) << "LU error" << std::setw(12) << "Chol error"
+			  << std::setw(12) << "QR error" << '\n';
+
+	for (size_t n = 128; n <= std::min<size_t>(max_n, 1024); n *= 2)
+	{
+		const mth::Matrix<double> a(n, n, init), b(n, 1, init);
+
+		// Symmetric positive definite by adding a dominant diagonal
+		auto spd = a.dot_product(a.view().transpose());
+		for (size_t i = 0; i < n; ++i) spd(i, i) += n;
+
+		auto	   a_lu = a, a_chol = spd, a_qr = a;
+		const auto t_lu_naive	= seconds([&] { a_lu = a, lu_naive(a_lu); }, 1);
+		const auto t_chol_naive = seconds([&] { a_chol = spd, cholesky_naive(a_chol); }, 1);
+		const auto t_qr_naive	= seconds([&] { a_qr = a, qr_naive(a_qr); }, 1);
+
+		const auto t_lu	  = seconds([&] { (void)mth::LU<double>(a); }, 1);
+		const auto t_chol = seconds([&] { (void)mth::Cholesky<double>(spd); }, 1);
+		const auto t_qr	  = seconds([&] { (void)mth::QR<double>(a); }, 1);
+
+		std::cout << std::setw(6) << n << std::setw(14) << t_lu_naive * 1e3 << std::setw(12) << t_lu * 1e3
+				  << std::setw(14) << t_chol_naive * 1e3 << std::setw(12) << t_chol * 1e3 << std::setw(14)
+				  << t_qr_naive * 1e3 << std::setw(12) << t_qr * 1e3 << std::setw(12)
+				  << residual(a, mth::LU<double>(a).solve(b), b) << std::setw(12)
+				  << residual(spd, mth::Cholesky<double>(spd).solve(b), b) << std::setw(12)
+				  << residual(a, mth::QR<double>(a).solve(b), b) << '\n';
+	}
+
+	// --------------------------------- Scaling -----------------------------------------
+
+	std::cout << '\n'
+			  << std::setw(8) << "threads" << std::setw(16) << "GEMM GFLOP/s" << std::setw(10) << "speedup"
+			  << std::setw(16) << "a + b GB/s" << std::setw(10) << "speedup" << '\n';
+
+	const mth::Matrix<double> a(scale_n, scale_n, init), b(scale_n, scale_n, init);
+	mth::Matrix<double>		  c(scale_n, scale_n, 0.);
+
+	const auto hw	 = std::max(1u, std::thread::hardware_concurrency());
+	double	   gemm1 = 0., add1 = 0.;
+
+	for (size_t t = 1; t <= hw; t = t * 2 > hw && t != hw ? hw : t * 2)
+	{
+		exe::ThreadPool pool(t - 1);
+		const auto		policy = exe::par(pool);
+
+		const auto t_gemm = seconds([&] { c = a.dot_product(policy, b); }, 3);
+		const auto t_add  = seconds([&] { c.assign(policy, a + b); }, 20);
+
+		if (t == 1)
+			gemm1 = t_gemm, add1 = t_add;
+
+		std::cout << std::setw(8) << t << std::setw(16) << gflops(scale_n, t_gemm) << std::setw(10) << gemm1 / t_gemm
+				  << std::setw(16) << 3. * sizeof(double) * c.size() / t_add / 1e9 << std::setw(10) << add1 / t_add
+				  << '\n';
+	}
+
+	// The standard parallel algorithms over all hardware threads
+	{
+		const auto t_gemm = seconds([&] { c = a.dot_product(exe::par_unseq, b); }, 3);
+		const auto t_add  = seconds([&] { c.assign(exe::par_unseq, a + b); }, 20);
+
+		std::cout << std::setw(8) << "unseq" << std::setw(16) << gflops(scale_n, t_gemm) << std::setw(10)
+				  << gemm1 / t_gemm << std::setw(16) << 3. * sizeof(double) * c.size() / t_add / 1e9 << std::setw(10)
+				  << add1 / t_add << '\n';
+	}
+
+	return 0;
+}
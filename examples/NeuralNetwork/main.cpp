@@ -11,7 +11,7 @@ using namespace ctl;
 
 rnd::Random<rnd::Mersenne> g_rand;
 
-auto highest(const mth::Matrix<double> &e) { return std::distance(e.begin(), std::max_element(e.begin(), e.end())); }
+auto highest(const mth::Matrix<double> &e) { return mth::argmax(e); }
 
 int main(int argc, char **argv)
 {
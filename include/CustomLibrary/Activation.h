@@ -0,0 +1,266 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "Simd.h"
+
+namespace ctl::mcl
+{
+	// -----------------------------------------------------------------------------
+	// Activation Functions
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Activation function of a layer
+	 */
+	enum class Activation : std::uint8_t
+	{
+		identity,
+		sigmoid,
+		tanh,
+		relu,
+		leaky_relu,
+		softmax, ///< Normalizes every column (sample) to a probability distribution
+	};
+
+	/**
+	 * @brief Slope of the leaky ReLU for negative inputs
+	 */
+	inline constexpr double LEAKY_RELU_SLOPE = 0.01;
+
+	namespace act
+	{
+		/**
+		 * @brief 1 / (1 + e^-x)
+		 */
+		struct Sigmoid
+		{
+			template<typename T>
+			auto operator()(T x) const noexcept -> T
+			{
+				return T(1) / (T(1) + std::exp(-x));
+			}
+			template<typename P, typename R>
+			static auto pack(R a) noexcept -> decltype(simd::Exp::pack<P>(a))
+			{
+				const auto one = P::set1(1);
+				return P::div(one, P::add(one, simd::Exp::pack<P>(P::sub(P::set1(0), a))));
+			}
+		};
+
+		/**
+		 * @brief Hyperbolic tangent. The pack version uses 1 - 2 / (e^2x + 1).
+		 */
+		struct Tanh
+		{
+			template<typename T>
+			auto operator()(T x) const noexcept -> T
+			{
+				return std::tanh(x);
+			}
+			template<typename P, typename R>
+			static auto pack(R a) noexcept -> decltype(simd::Exp::pack<P>(a))
+			{
+				const auto one = P::set1(1), two = P::set1(2);
+				return P::sub(one, P::div(two, P::add(simd::Exp::pack<P>(P::mul(a, two)), one)));
+			}
+		};
+
+		/**
+		 * @brief max(x, 0)
+		 */
+		struct ReLU
+		{
+			template<typename T>
+			auto operator()(T x) const noexcept -> T
+			{
+				return x > T(0) ? x : T(0);
+			}
+			template<typename P, typename R>
+			static auto pack(R a) noexcept -> decltype(P::max(a, a))
+			{
+				return P::max(a, P::set1(0));
+			}
+		};
+
+		/**
+		 * @brief x for positive x, otherwise LEAKY_RELU_SLOPE * x. As the slope is below 1 that is max(x, slope * x).
+		 */
+		struct LeakyReLU
+		{
+			template<typename T>
+			auto operator()(T x) const noexcept -> T
+			{
+				return x > T(0) ? x : static_cast<T>(LEAKY_RELU_SLOPE) * x;
+			}
+			template<typename P, typename R>
+			static auto pack(R a) noexcept -> decltype(P::max(a, a))
+			{
+				return P::max(a, P::mul(a, P::set1(LEAKY_RELU_SLOPE)));
+			}
+		};
+
+		/**
+		 * @brief Error times the sigmoid derivative from the output: e * o * (1 - o)
+		 */
+		struct SigmoidGrad
+		{
+			template<typename T>
+			auto operator()(T e, T o) const noexcept -> T
+			{
+				return e * o * (T(1) - o);
+			}
+			template<typename P, typename R>
+			static auto pack(R e, R o) noexcept -> decltype(P::mul(e, o))
+			{
+				return P::mul(e, P::mul(o, P::sub(P::set1(1), o)));
+			}
+		};
+
+		/**
+		 * @brief Error times the tanh derivative from the output: e * (1 - o^2)
+		 */
+		struct TanhGrad
+		{
+			template<typename T>
+			auto operator()(T e, T o) const noexcept -> T
+			{
+				return e * (T(1) - o * o);
+			}
+			template<typename P, typename R>
+			static auto pack(R e, R o) noexcept -> decltype(P::mul(e, o))
+			{
+				return P::mul(e, P::sub(P::set1(1), P::mul(o, o)));
+			}
+		};
+	} // namespace act
+
+	namespace detail
+	{
+		/**
+		 * @brief Column wise softmax of a row major rows x cols block. Vectorized across columns so a column never
+		 * has to be gathered.
+		 */
+		template<typename T>
+		void softmax(T *x, size_t rows, size_t cols) noexcept
+		{
+			if (rows == 0)
+				return;
+
+			size_t c = 0;
+
+			if constexpr (simd::vectorizable_unary<simd::Exp, T>)
+			{
+				using P = simd::Pack<T>;
+
+				for (; c + P::width <= cols; c += P::width)
+				{
+					auto mx = P::load(x + c);
+					for (size_t r = 1; r < rows; ++r) mx = P::max(mx, P::load(x + r * cols + c));
+
+					auto sum = P::set1(0);
+					for (size_t r = 0; r < rows; ++r)
+					{
+						const auto v = simd::Exp::pack<P>(P::sub(P::load(x + r * cols + c), mx));
+						P::store(x + r * cols + c, v);
+						sum = P::add(sum, v);
+					}
+
+					const auto inv = P::div(P::set1(1), sum);
+					for (size_t r = 0; r < rows; ++r)
+						P::store(x + r * cols + c, P::mul(P::load(x + r * cols + c), inv));
+				}
+			}
+
+			for (; c < cols; ++c)
+			{
+				auto mx = x[c];
+				for (size_t r = 1; r < rows; ++r) mx = std::max(mx, x[r * cols + c]);
+
+				T sum = 0;
+				for (size_t r = 0; r < rows; ++r) sum += (x[r * cols + c] = std::exp(x[r * cols + c] - mx));
+				for (size_t r = 0; r < rows; ++r) x[r * cols + c] /= sum;
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Applies an activation in place to a row major rows x cols block holding one sample per column
+	 *
+	 * @param f Activation
+	 * @param x Data
+	 * @param rows Neurons
+	 * @param cols Samples
+	 */
+	template<typename T>
+	void activate(Activation f, T *x, size_t rows, size_t cols) noexcept
+	{
+		const auto n = rows * cols;
+
+		switch (f)
+		{
+		case Activation::identity:
+			break;
+		case Activation::sigmoid:
+			simd::transform(x, x, n, act::Sigmoid{});
+			break;
+		case Activation::tanh:
+			simd::transform(x, x, n, act::Tanh{});
+			break;
+		case Activation::relu:
+			simd::transform(x, x, n, act::ReLU{});
+			break;
+		case Activation::leaky_relu:
+			simd::transform(x, x, n, act::LeakyReLU{});
+			break;
+		case Activation::softmax:
+			detail::softmax(x, rows, cols);
+			break;
+		}
+	}
+
+	/**
+	 * @brief Multiplies errors in place with the derivative of the activation, taken from the activation's outputs.
+	 * For softmax this is the product with its Jacobian: e_i = o_i * (e_i - sum_j o_j * e_j) per column.
+	 *
+	 * @param f Activation
+	 * @param out Outputs of the activation
+	 * @param err Errors of the outputs
+	 * @param rows Neurons
+	 * @param cols Samples
+	 */
+	template<typename T>
+	void derive(Activation f, const T *out, T *err, size_t rows, size_t cols) noexcept
+	{
+		const auto n = rows * cols;
+
+		switch (f)
+		{
+		case Activation::identity:
+			break;
+		case Activation::sigmoid:
+			simd::transform(err, err, out, n, act::SigmoidGrad{});
+			break;
+		case Activation::tanh:
+			simd::transform(err, err, out, n, act::TanhGrad{});
+			break;
+		case Activation::relu:
+			for (size_t i = 0; i < n; ++i) err[i] = out[i] > T(0) ? err[i] : T(0);
+			break;
+		case Activation::leaky_relu:
+			for (size_t i = 0; i < n; ++i) err[i] *= out[i] > T(0) ? T(1) : static_cast<T>(LEAKY_RELU_SLOPE);
+			break;
+		case Activation::softmax:
+			for (size_t c = 0; c < cols; ++c)
+			{
+				T dot = 0;
+				for (size_t r = 0; r < rows; ++r) dot += out[r * cols + c] * err[r * cols + c];
+				for (size_t r = 0; r < rows; ++r) err[r * cols + c] = out[r * cols + c] * (err[r * cols + c] - dot);
+			}
+			break;
+		}
+	}
+
+} // namespace ctl::mcl
@@ -0,0 +1,481 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+
+namespace ctl::mem
+{
+	// -----------------------------------------------------------------------------
+	// Arena
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Bump allocator. Allocating moves a pointer forward, deallocating does nothing. Memory is handed back all
+	 * at once using reset or rewinding to a marker. Not thread safe, use one arena per thread.
+	 */
+	class Arena final : public std::pmr::memory_resource
+	{
+	public:
+		/**
+		 * @brief Position inside the arena to rewind to
+		 */
+		struct Marker
+		{
+			size_t		block;
+			std::byte *ptr;
+		};
+
+		/**
+		 * @brief Create a empty arena. Nothing is allocated until first use.
+		 *
+		 * @param block_size Size of the first block. Following blocks double in size.
+		 * @param upstream Resource the blocks are allocated from
+		 */
+		explicit Arena(size_t block_size = 1 << 20,
+					   std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) noexcept
+			: m_block_size(block_size)
+			, m_upstream(upstream)
+		{
+		}
+
+		Arena(const Arena &) = delete;
+		auto operator=(const Arena &) -> Arena & = delete;
+
+		~Arena() override { release(); }
+
+		/**
+		 * @brief Get the current position
+		 * @return Marker
+		 */
+		[[nodiscard]] auto mark() const noexcept -> Marker { return { m_current, m_ptr }; }
+
+		/**
+		 * @brief Free everything allocated after the marker
+		 * @param m Marker from mark()
+		 */
+		void rewind(Marker m) noexcept
+		{
+			m_current = m.block;
+
+			// A marker of a fresh arena has no pointer yet, it points to the start of the first block
+			if (m_blocks.empty())
+				m_ptr = m_end = nullptr;
+			else
+			{
+				m_ptr = m.ptr ? m.ptr : m_blocks[m_current].ptr;
+				m_end = m_blocks[m_current].ptr + m_blocks[m_current].size;
+			}
+		}
+
+		/**
+		 * @brief Free everything. If the arena had to grow, its blocks are merged into one so the next round of the
+		 * same allocations fits into a single block.
+		 */
+		void reset()
+		{
+			if (m_blocks.size() > 1)
+			{
+				size_t total = 0;
+				for (const auto &b : m_blocks) total += b.size;
+
+				release();
+				_add_block_(total);
+			}
+
+			rewind({ 0, m_blocks.empty() ? nullptr : m_blocks.front().ptr });
+		}
+
+		/**
+		 * @brief Hand all blocks back to the upstream resource
+		 */
+		void release() noexcept
+		{
+			for (const auto &b : m_blocks) m_upstream->deallocate(b.ptr, b.size, alignof(std::max_align_t));
+
+			m_blocks.clear();
+			m_current = 0;
+			m_ptr = m_end = nullptr;
+		}
+
+		/**
+		 * @brief Get the amount of bytes in use
+		 * @return size
+		 */
+		[[nodiscard]] auto used() const noexcept -> size_t
+		{
+			size_t s = 0;
+			for (size_t i = 0; i < m_current; ++i) s += m_blocks[i].size;
+
+			return m_blocks.empty() ? 0 : s + (m_ptr - m_blocks[m_current].ptr);
+		}
+
+		/**
+		 * @brief Get the amount of bytes owned
+		 * @return size
+		 */
+		[[nodiscard]] auto capacity() const noexcept -> size_t
+		{
+			size_t s = 0;
+			for (const auto &b : m_blocks) s += b.size;
+
+			return s;
+		}
+
+	private:
+		struct Block
+		{
+			std::byte *ptr;
+			size_t		size;
+		};
+
+		std::vector<Block> m_blocks;
+		size_t			   m_current = 0;
+		std::byte		  *m_ptr	 = nullptr;
+		std::byte		  *m_end	 = nullptr;
+
+		size_t					   m_block_size;
+		std::pmr::memory_resource *m_upstream;
+
+		void _add_block_(size_t size)
+		{
+			auto *p = static_cast<std::byte *>(m_upstream->allocate(size, alignof(std::max_align_t)));
+
+			m_blocks.push_back({ p, size });
+			m_block_size = std::max(m_block_size, size) * 2;
+		}
+
+		static auto _align_(std::byte *p, size_t align) noexcept -> std::byte *
+		{
+			return reinterpret_cast<std::byte *>((reinterpret_cast<std::uintptr_t>(p) + align - 1) & ~(align - 1));
+		}
+
+		auto do_allocate(size_t bytes, size_t align) -> void * override
+		{
+			if (auto *p = _align_(m_ptr, align); m_ptr && p + bytes <= m_end)
+			{
+				m_ptr = p + bytes;
+				return p;
+			}
+
+			// Move on to the next block that fits, growing if there is none. The current block is only skipped if it
+			// is in use already.
+			for (m_current += m_ptr ? 1 : 0; m_current < m_blocks.size(); ++m_current)
+				if (m_blocks[m_current].size >= bytes + align)
+					break;
+
+			if (m_current >= m_blocks.size())
+				_add_block_(std::max(m_block_size, bytes + align)), m_current = m_blocks.size() - 1;
+
+			auto *p = _align_(m_blocks[m_current].ptr, align);
+			m_ptr	= p + bytes;
+			m_end	= m_blocks[m_current].ptr + m_blocks[m_current].size;
+
+			return p;
+		}
+
+		void do_deallocate(void *, size_t, size_t) noexcept override {}
+
+		[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &o) const noexcept -> bool override
+		{
+			return this == &o;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Pool
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Size class pool. Requests are rounded up to a power of 2 and served from a free list of that class, so
+	 * freed memory is reused by the next request of similar size. Requests above MAX_CLASS go to the upstream resource.
+	 * Not thread safe, use one pool per thread.
+	 */
+	class Pool final : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr size_t MIN_CLASS = 16;
+		static constexpr size_t MAX_CLASS = 1 << 22;
+		static constexpr size_t CHUNK	  = 1 << 16;
+
+		/**
+		 * @brief Create a empty pool
+		 * @param upstream Resource the chunks are allocated from
+		 */
+		explicit Pool(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) noexcept
+			: m_upstream(upstream)
+		{
+		}
+
+		Pool(const Pool &) = delete;
+		auto operator=(const Pool &) -> Pool & = delete;
+
+		~Pool() override { release(); }
+
+		/**
+		 * @brief Hand all chunks back to the upstream resource. Everything allocated from the pool becomes invalid.
+		 */
+		void release() noexcept
+		{
+			for (const auto &c : m_chunks) m_upstream->deallocate(c.ptr, c.size, c.align);
+
+			m_chunks.clear();
+			m_free.fill(nullptr);
+		}
+
+	private:
+		static constexpr size_t CLASSES	  = std::countr_zero(MAX_CLASS) - std::countr_zero(MIN_CLASS) + 1;
+		static constexpr size_t MAX_ALIGN = 4096;
+
+		struct Node
+		{
+			Node *next;
+		};
+
+		struct Chunk
+		{
+			void  *ptr;
+			size_t size;
+			size_t align;
+		};
+
+		std::array<Node *, CLASSES> m_free = {};
+		std::vector<Chunk>			m_chunks;
+		std::pmr::memory_resource  *m_upstream;
+
+		static auto _class_(size_t bytes, size_t align) noexcept -> size_t
+		{
+			return std::countr_zero(std::bit_ceil(std::max({ bytes, align, MIN_CLASS })))
+				- std::countr_zero(MIN_CLASS);
+		}
+
+		static constexpr auto _class_size_(size_t c) noexcept -> size_t { return MIN_CLASS << c; }
+
+		static auto _is_large_(size_t bytes, size_t align) noexcept -> bool
+		{
+			return bytes > MAX_CLASS || align > MAX_ALIGN;
+		}
+
+		void _refill_(size_t c)
+		{
+			const auto size	 = _class_size_(c);
+			const auto bytes = std::max(CHUNK, size * 4);
+			const auto align = std::min(size, MAX_ALIGN);
+
+			auto *p = static_cast<std::byte *>(m_upstream->allocate(bytes, align));
+			m_chunks.push_back({ p, bytes, align });
+
+			// Blocks of a class are a multiple of the class size apart so they keep the chunk's alignment
+			for (size_t off = bytes; off >= size; off -= size)
+			{
+				auto *n	  = reinterpret_cast<Node *>(p + off - size);
+				n->next	  = m_free[c];
+				m_free[c] = n;
+			}
+		}
+
+		auto do_allocate(size_t bytes, size_t align) -> void * override
+		{
+			if (_is_large_(bytes, align))
+				return m_upstream->allocate(bytes, align);
+
+			const auto c = _class_(bytes, align);
+			if (m_free[c] == nullptr)
+				_refill_(c);
+
+			auto *n	  = m_free[c];
+			m_free[c] = n->next;
+
+			return n;
+		}
+
+		void do_deallocate(void *p, size_t bytes, size_t align) noexcept override
+		{
+			if (_is_large_(bytes, align))
+				return m_upstream->deallocate(p, bytes, align);
+
+			const auto c = _class_(bytes, align);
+
+			auto *n	  = static_cast<Node *>(p);
+			n->next	  = m_free[c];
+			m_free[c] = n;
+		}
+
+		[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &o) const noexcept -> bool override
+		{
+			return this == &o;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Thread Resources
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Get the resource of the calling thread. Every thread has its own instance per resource type.
+	 * @tparam Resource Arena or Pool
+	 * @return Resource
+	 */
+	template<typename Resource>
+	auto thread_resource() -> Resource &
+	{
+		thread_local Resource res;
+		return res;
+	}
+
+	/**
+	 * @brief Get the arena of the calling thread
+	 * @return Arena
+	 */
+	inline auto thread_arena() -> Arena & { return thread_resource<Arena>(); }
+
+	/**
+	 * @brief Rewinds a arena to the position it had on construction. Scopes can be nested.
+	 */
+	class ArenaScope
+	{
+	public:
+		/**
+		 * @brief Mark the arena
+		 * @param a Arena to rewind on destruction
+		 */
+		explicit ArenaScope(Arena &a = thread_arena()) noexcept
+			: m_arena(a)
+			, m_marker(a.mark())
+		{
+		}
+
+		ArenaScope(const ArenaScope &) = delete;
+		auto operator=(const ArenaScope &) -> ArenaScope & = delete;
+
+		~ArenaScope() { m_arena.rewind(m_marker); }
+
+	private:
+		Arena		 &m_arena;
+		Arena::Marker m_marker;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Allocators
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Typed allocator onto a Arena or Pool. Calls go straight to the resource without virtual dispatch. Default
+	 * constructed allocators use the resource of the constructing thread. Allocations from 64 bytes on are aligned to
+	 * the cache line for the SIMD kernels.
+	 *
+	 * @tparam T Element type
+	 * @tparam Resource Arena or Pool
+	 */
+	template<typename T, typename Resource>
+	class ResourceAllocator
+	{
+		template<typename, typename>
+		friend class ResourceAllocator;
+
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind
+		{
+			using other = ResourceAllocator<U, Resource>;
+		};
+
+		ResourceAllocator() noexcept
+			: m_res(&thread_resource<Resource>())
+		{
+		}
+		ResourceAllocator(Resource &res) noexcept
+			: m_res(&res)
+		{
+		}
+		template<typename U>
+		ResourceAllocator(const ResourceAllocator<U, Resource> &o) noexcept
+			: m_res(o.m_res)
+		{
+		}
+
+		[[nodiscard]] auto allocate(size_t n) -> T *
+		{
+			return static_cast<T *>(m_res->allocate(n * sizeof(T), _align_(n)));
+		}
+		void deallocate(T *p, size_t n) noexcept { m_res->deallocate(p, n * sizeof(T), _align_(n)); }
+
+		/**
+		 * @brief Get the resource
+		 * @return Resource
+		 */
+		[[nodiscard]] auto resource() const noexcept -> Resource * { return m_res; }
+
+		template<typename U>
+		auto operator==(const ResourceAllocator<U, Resource> &o) const noexcept -> bool
+		{
+			return m_res == o.m_res;
+		}
+
+	private:
+		Resource *m_res;
+
+		static constexpr auto _align_(size_t n) noexcept -> size_t
+		{
+			return n * sizeof(T) >= 64 && alignof(T) < 64 ? 64 : alignof(T);
+		}
+	};
+
+	/**
+	 * @brief Allocator on the global heap aligning every allocation to Align bytes
+	 *
+	 * @tparam T Element type
+	 * @tparam Align Alignment. Power of 2.
+	 */
+	template<typename T, size_t Align = 64>
+	class AlignedAllocator
+	{
+		static_assert(std::has_single_bit(Align), "Alignment must be a power of 2.");
+
+	public:
+		using value_type = T;
+
+		template<typename U>
+		struct rebind
+		{
+			using other = AlignedAllocator<U, Align>;
+		};
+
+		AlignedAllocator() noexcept = default;
+		template<typename U>
+		AlignedAllocator(const AlignedAllocator<U, Align> &) noexcept
+		{
+		}
+
+		[[nodiscard]] auto allocate(size_t n) -> T *
+		{
+			return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t{ _align_() }));
+		}
+		void deallocate(T *p, size_t) noexcept { ::operator delete(p, std::align_val_t{ _align_() }); }
+
+		template<typename U>
+		auto operator==(const AlignedAllocator<U, Align> &) const noexcept -> bool
+		{
+			return true;
+		}
+
+	private:
+		static constexpr auto _align_() noexcept -> size_t { return std::max(Align, alignof(T)); }
+	};
+
+	template<typename T>
+	using ArenaAllocator = ResourceAllocator<T, Arena>;
+
+	template<typename T>
+	using PoolAllocator = ResourceAllocator<T, Pool>;
+
+} // namespace ctl::mem
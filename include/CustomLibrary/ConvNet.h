@@ -0,0 +1,807 @@
+#pragma once
+
+#include "NeuralNet.h"
+
+#include <cstdint>
+#include <utility>
+
+namespace ctl::mcl
+{
+	// -----------------------------------------------------------------------------
+	// Spatial Layers
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Shape of the feature maps of a sample. A sample is one column of channels * height * width elements,
+	 * channel by channel and row by row. Batches are the columns of a matrix, so element (c, y, x) of sample n lies at
+	 * ((c * height + y) * width + x) * batch + n and every pixel holds its batch contiguously.
+	 */
+	struct Shape
+	{
+		size_t channels = 1, height = 1, width = 1;
+
+		[[nodiscard]] constexpr auto size() const noexcept { return channels * height * width; }
+		[[nodiscard]] constexpr auto flat() const noexcept { return height == 1 && width == 1; }
+
+		constexpr auto operator==(const Shape &) const noexcept -> bool = default;
+	};
+
+	/**
+	 * @brief Operation of a spatial layer
+	 */
+	enum class LayerType : std::uint8_t
+	{
+		dense,
+		conv2d,
+		max_pool,
+		avg_pool,
+		flatten,
+	};
+
+	/**
+	 * @brief How a convolution is computed
+	 */
+	enum class ConvAlgorithm : std::uint8_t
+	{
+		automatic, ///< direct where possible, otherwise im2col
+		im2col,	   ///< Patches are unfolded into a matrix and multiplied with a single GEMM
+		direct,	   ///< Vectorized over rows of pixels, only for 3x3 kernels with stride 1
+	};
+
+	/**
+	 * @brief Spatial layer descriptor. The weights and biases view the parameter buffer of the network, pooling and
+	 * flatten layers have none. Convolution weights are a channels x (input channels * kernel * kernel) matrix with
+	 * a row per filter, ordered by input channel, then kernel row and column.
+	 *
+	 * @tparam T Parameter type
+	 */
+	template<typename T = double>
+	struct SpatialLayer
+	{
+		LayerType		   type;
+		Shape			   in, out;
+		size_t			   kernel = 1, stride = 1, padding = 0;
+		mth::MatrixView<T> weights, biases;
+		Activation		   activation = Activation::identity;
+		bool			   direct	  = false;
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Unfolds the patches of a convolution into a (channels * k * k) x (out pixels * batch) matrix.
+		 * Patch elements outside of the input are zero.
+		 */
+		template<typename T>
+		void im2col(const T *in, Shape s, size_t k, size_t stride, size_t pad, Shape o, size_t batch,
+					T *cols) noexcept
+		{
+			for (size_t c = 0; c < s.channels; ++c)
+				for (size_t ky = 0; ky < k; ++ky)
+					for (size_t kx = 0; kx < k; ++kx)
+					{
+						auto *dst = cols + ((c * k + ky) * k + kx) * o.height * o.width * batch;
+
+						for (size_t oy = 0; oy < o.height; ++oy)
+						{
+							if (const auto iy = oy * stride + ky; iy < pad || iy - pad >= s.height)
+							{
+								std::fill_n(dst, o.width * batch, T(0));
+								dst += o.width * batch;
+								continue;
+							}
+
+							const auto *row = in + (c * s.height + oy * stride + ky - pad) * s.width * batch;
+							for (size_t ox = 0; ox < o.width; ++ox, dst += batch)
+								if (const auto ix = ox * stride + kx; ix < pad || ix - pad >= s.width)
+									std::fill_n(dst, batch, T(0));
+								else
+									std::copy_n(row + (ix - pad) * batch, batch, dst);
+						}
+					}
+		}
+
+		/**
+		 * @brief Sums the patches of an unfolded matrix back onto the input they were taken from
+		 */
+		template<typename T>
+		void col2im(const T *cols, Shape s, size_t k, size_t stride, size_t pad, Shape o, size_t batch,
+					T *in) noexcept
+		{
+			for (size_t c = 0; c < s.channels; ++c)
+				for (size_t ky = 0; ky < k; ++ky)
+					for (size_t kx = 0; kx < k; ++kx)
+					{
+						const auto *src = cols + ((c * k + ky) * k + kx) * o.height * o.width * batch;
+
+						for (size_t oy = 0; oy < o.height; ++oy, src += o.width * batch)
+						{
+							if (const auto iy = oy * stride + ky; iy < pad || iy - pad >= s.height)
+								continue;
+
+							auto *row = in + (c * s.height + oy * stride + ky - pad) * s.width * batch;
+							for (size_t ox = 0; ox < o.width; ++ox)
+								if (const auto ix = ox * stride + kx; ix >= pad && ix - pad < s.width)
+									simd::transform(row + (ix - pad) * batch, row + (ix - pad) * batch,
+													src + ox * batch, batch, simd::Add{});
+						}
+					}
+		}
+
+		/**
+		 * @brief Accumulates a 3x3 convolution with stride 1 of the filters [co0, co1) onto out. A row of output
+		 * pixels with its batch is contiguous, as are the input rows, so every tap is a shifted vector load. Blocks of
+		 * 4 packs of a row of 2 filters stay in registers over all input channels and taps, every input load feeds
+		 * both filters. Pixels whose taps all lie inside the input run on packs, the border pixels a batch at a time.
+		 */
+		template<typename T, typename W>
+		void conv3x3(const T *in, Shape s, const W *w, size_t pad, Shape o, size_t batch, T *out, size_t co0,
+					 size_t co1) noexcept
+		{
+			const auto row_n = o.width * batch, plane = s.height * s.width * batch, filter = s.channels * 9;
+
+			// Output pixels [x0, x1) read no padding
+			const auto x0 = std::min(pad, o.width);
+			const auto x1 = std::max(x0, std::min(o.width, s.width + pad > 2 ? s.width + pad - 2 : 0));
+
+			// Output rows outermost, so the input rows they read stay in cache for all filters
+			for (size_t oy = 0; oy < o.height; ++oy)
+			{
+				// Kernel rows inside the input and the offset of their input row in a channel
+				size_t kys[3], offset[3], rows = 0;
+				for (size_t ky = 0; ky < 3; ++ky)
+					if (const auto iy = oy + ky; iy >= pad && iy - pad < s.height)
+						kys[rows] = ky, offset[rows++] = (iy - pad) * s.width * batch;
+
+				// Accumulates the taps [k0, k1) of every kernel row onto the elements [j, j + n) of filter co's row
+				const auto scalar = [&](size_t co, size_t j, size_t n, size_t k0, size_t k1) {
+					auto *orow = out + (co * o.height + oy) * row_n;
+
+					for (auto e = j; e < j + n; ++e)
+					{
+						auto acc = orow[e];
+						for (size_t ci = 0; ci < s.channels; ++ci)
+							for (size_t r = 0; r < rows; ++r)
+								for (auto kx = k0; kx < k1; ++kx)
+									acc += in[ci * plane + offset[r] + e + kx * batch - pad * batch]
+										 * static_cast<T>(w[co * filter + ci * 9 + kys[r] * 3 + kx]);
+						orow[e] = acc;
+					}
+				};
+
+				// Same for the filters [co, co + F) on packs, returns the elements done
+				const auto packed = [&]<size_t F>(size_t co, size_t j, size_t n, size_t k0, size_t k1) -> size_t {
+					if constexpr (simd::vectorizable<simd::Add, T>)
+					{
+						using P = simd::Pack<T>;
+
+						// Accumulator I is pack I % U of filter I / U, unrolled so they stay in registers
+						const auto block = [&]<size_t... I>(size_t j, std::index_sequence<I...>) {
+							constexpr auto U = sizeof...(I) / F;
+
+							auto		   *orow	= out + (co * o.height + oy) * row_n + j;
+							typename P::reg acc[] = { P::load(orow + I / U * o.height * row_n + I % U * P::width)... };
+
+							const auto tap = [&]<size_t i>(const T *x, const W *wk) {
+								const auto wv = P::set1(static_cast<T>(wk[i / U * filter]));
+								acc[i]		  = simd::detail::madd<P>(P::load(x + i % U * P::width), wv, acc[i]);
+							};
+
+							for (size_t ci = 0; ci < s.channels; ++ci)
+								for (size_t r = 0; r < rows; ++r)
+								{
+									// The tap offset is added before the padding is taken off, so left border pixels
+									// never point before the input
+									const auto	src = ci * plane + offset[r] + j;
+									const auto *wr	= w + co * filter + ci * 9 + kys[r] * 3;
+
+									for (auto kx = k0; kx < k1; ++kx)
+									{
+										const auto *x = in + (src + kx * batch - pad * batch), *wk = wr + kx;
+										(tap.template operator()<I>(x, wk), ...);
+									}
+								}
+
+							(P::store(orow + I / U * o.height * row_n + I % U * P::width, acc[I]), ...);
+						};
+
+						size_t i = 0;
+						for (; i + 4 * P::width <= n; i += 4 * P::width)
+							block(j + i, std::make_index_sequence<F * 4>());
+						for (; i + P::width <= n; i += P::width) block(j + i, std::make_index_sequence<F>());
+						return i;
+					}
+					else
+						return 0;
+				};
+
+				const auto run = [&]<size_t F>(size_t co, size_t j, size_t n, size_t k0, size_t k1) {
+					const auto done = packed.template operator()<F>(co, j, n, k0, k1);
+					for (size_t f = 0; f < F; ++f) scalar(co + f, j + done, n - done, k0, k1);
+				};
+
+				// Border pixels only use the taps inside the input, a batch at a time
+				const auto row = [&]<size_t F>(size_t co) {
+					const auto border = [&](size_t ox) {
+						const auto k0 = ox < pad ? pad - ox : 0;
+						const auto k1 = ox < s.width + pad ? std::min<size_t>(3, s.width + pad - ox) : 0;
+						if (k0 < k1)
+							run.template operator()<F>(co, ox * batch, batch, k0, k1);
+					};
+
+					for (size_t ox = 0; ox < x0; ++ox) border(ox);
+					run.template operator()<F>(co, x0 * batch, (x1 - x0) * batch, 0, 3);
+					for (auto ox = x1; ox < o.width; ++ox) border(ox);
+				};
+
+				auto co = co0;
+				for (; co + 2 <= co1; co += 2) row.template operator()<2>(co);
+				for (; co < co1; ++co) row.template operator()<1>(co);
+			}
+		}
+
+		/**
+		 * @brief Pools the channels [c0, c1). Every output pixel starts as the first pixel of its window and folds in
+		 * the others with op, a batch at a time.
+		 */
+		template<typename T, typename Op>
+		void pool(const T *in, Shape s, size_t k, size_t stride, Shape o, size_t batch, T *out, Op op, size_t c0,
+				  size_t c1) noexcept
+		{
+			for (auto c = c0; c < c1; ++c)
+				for (size_t oy = 0; oy < o.height; ++oy)
+					for (size_t ox = 0; ox < o.width; ++ox)
+					{
+						auto	   *dst = out + ((c * o.height + oy) * o.width + ox) * batch;
+						const auto *win = in + ((c * s.height + oy * stride) * s.width + ox * stride) * batch;
+
+						std::copy_n(win, batch, dst);
+						for (size_t ky = 0; ky < k; ++ky)
+							for (size_t kx = ky == 0; kx < k; ++kx)
+								simd::transform(dst, dst, win + (ky * s.width + kx) * batch, batch, op);
+					}
+		}
+
+		/**
+		 * @brief Runs a layer forward from in to out. Flatten layers don't touch the data.
+		 *
+		 * @param policy Execution policy the GEMMs and channels are split with
+		 * @param l Layer
+		 * @param in Input feature maps
+		 * @param out Output feature maps
+		 * @param batch Samples
+		 * @param cols Buffer of the unfolded patches of im2col convolutions
+		 */
+		template<typename P, typename W>
+		void spatial_forward(const P &policy, const SpatialLayer<W> &l, const double *in, double *out, size_t batch,
+							 std::vector<double> &cols)
+		{
+			const auto pixels = l.out.height * l.out.width * batch;
+
+			switch (l.type)
+			{
+			case LayerType::dense:
+			case LayerType::conv2d:
+			{
+				const auto rows = l.weights.dim().h, n = l.type == LayerType::dense ? batch : pixels;
+				for (size_t r = 0; r < rows; ++r) std::fill_n(out + r * n, n, static_cast<double>(l.biases.data()[r]));
+
+				mth::MatrixView<double> o(out, rows, n);
+
+				if (l.type == LayerType::dense)
+					mth::detail::strided_product(policy, l.weights, mth::MatrixView<const double>(in, l.in.size(), n),
+												 o);
+				else if (l.direct)
+					exe::for_blocks(policy, rows, pixels * l.in.channels * 9, [&](size_t c0, size_t c1) {
+						conv3x3(in, l.in, l.weights.data(), l.padding, l.out, batch, out, c0, c1);
+					});
+				else
+				{
+					cols.resize(l.weights.dim().w * pixels);
+					im2col(in, l.in, l.kernel, l.stride, l.padding, l.out, batch, cols.data());
+					mth::detail::strided_product(policy, l.weights,
+												 mth::MatrixView<const double>(cols.data(), l.weights.dim().w, n), o);
+				}
+
+				activate(l.activation, out, l.out.size(), batch);
+				break;
+			}
+			case LayerType::max_pool:
+				exe::for_blocks(policy, l.out.channels, pixels * l.kernel * l.kernel, [&](size_t c0, size_t c1) {
+					pool(in, l.in, l.kernel, l.stride, l.out, batch, out, simd::Max{}, c0, c1);
+				});
+				break;
+			case LayerType::avg_pool:
+				exe::for_blocks(policy, l.out.channels, pixels * l.kernel * l.kernel, [&](size_t c0, size_t c1) {
+					pool(in, l.in, l.kernel, l.stride, l.out, batch, out, simd::Add{}, c0, c1);
+
+					const auto n = (c1 - c0) * pixels;
+					simd::transform(out + c0 * pixels, out + c0 * pixels, 1. / static_cast<double>(l.kernel * l.kernel),
+									n, simd::Mul{});
+				});
+				break;
+			case LayerType::flatten:
+				break;
+			}
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Convolutional Neural Network
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Neural network of convolution, pooling, flatten and dense layers. Samples are the columns of the input
+	 * matrix in the layout of Shape. Like BasicNeuralNetwork all parameters live in one aligned buffer.
+	 *
+	 * @tparam Weight Type the weights and biases are stored as
+	 */
+	template<typename Weight = double>
+	class ConvNeuralNetwork
+	{
+	public:
+		using weight_type = Weight;
+
+		/**
+		 * @brief Alignment of the parameter buffer and of every matrix in it in bytes
+		 */
+		static constexpr size_t ALIGNMENT = 64;
+
+		/**
+		 * @brief Construct a empty network
+		 */
+		ConvNeuralNetwork() = default;
+
+		/**
+		 * @brief Construct a network without layers for a certain input
+		 * @param input Shape of a sample
+		 */
+		explicit ConvNeuralNetwork(Shape input) noexcept
+			: m_input(input)
+		{
+		}
+
+		ConvNeuralNetwork(const ConvNeuralNetwork &nn)
+			: m_input(nn.m_input)
+			, m_params(nn.m_params)
+			, m_layers(nn.m_layers)
+		{
+			_bind_();
+		}
+		ConvNeuralNetwork(ConvNeuralNetwork &&) noexcept = default;
+
+		auto operator=(const ConvNeuralNetwork &nn) -> ConvNeuralNetwork &
+		{
+			if (this != &nn)
+			{
+				m_input	 = nn.m_input;
+				m_params = nn.m_params;
+				m_layers = nn.m_layers;
+				_bind_();
+			}
+			return *this;
+		}
+		auto operator=(ConvNeuralNetwork &&) noexcept -> ConvNeuralNetwork & = default;
+
+		/**
+		 * @brief Add a 2D convolution. The parameters are zero until initialize is called.
+		 *
+		 * @param channels Filters, which are the output channels
+		 * @param kernel Side length of the square filters
+		 * @param activation Activation of the layer
+		 * @param stride Step between 2 patches
+		 * @param padding Zero border around the input
+		 * @param algorithm How the convolution is computed
+		 */
+		void add_conv2d(size_t channels, size_t kernel, Activation activation = Activation::relu, size_t stride = 1,
+						size_t padding = 0, ConvAlgorithm algorithm = ConvAlgorithm::automatic)
+		{
+			const auto in = output_shape();
+			assert(kernel > 0 && stride > 0 && in.height + 2 * padding >= kernel && in.width + 2 * padding >= kernel
+				   && "Kernel must fit into the padded input.");
+
+			const auto direct = kernel == 3 && stride == 1;
+			assert((algorithm != ConvAlgorithm::direct || direct) && "Direct convolution needs 3x3 with stride 1.");
+
+			const Shape out = { channels, (in.height + 2 * padding - kernel) / stride + 1,
+								(in.width + 2 * padding - kernel) / stride + 1 };
+
+			m_layers.push_back({ LayerType::conv2d, in, out, kernel, stride, padding, {}, {}, activation,
+								 direct && algorithm != ConvAlgorithm::im2col });
+			_allocate_();
+		}
+
+		/**
+		 * @brief Add a max pooling layer
+		 * @param window Side length of the square window
+		 * @param stride Step between 2 windows. 0 uses the window, so windows don't overlap.
+		 */
+		void add_max_pool(size_t window, size_t stride = 0) { _add_pool_(LayerType::max_pool, window, stride); }
+
+		/**
+		 * @brief Add a average pooling layer
+		 * @param window Side length of the square window
+		 * @param stride Step between 2 windows. 0 uses the window, so windows don't overlap.
+		 */
+		void add_avg_pool(size_t window, size_t stride = 0) { _add_pool_(LayerType::avg_pool, window, stride); }
+
+		/**
+		 * @brief Add a flatten layer, which turns the feature maps into a vector for dense layers. As every sample is
+		 * a column already it only changes the shape.
+		 */
+		void add_flatten()
+		{
+			const auto in = output_shape();
+			m_layers.push_back({ LayerType::flatten, in, { in.size(), 1, 1 }, 1, 1, 0, {}, {} });
+		}
+
+		/**
+		 * @brief Add a fully connected layer
+		 * @param outputs Neurons
+		 * @param activation Activation of the layer
+		 */
+		void add_dense(size_t outputs, Activation activation = Activation::sigmoid)
+		{
+			const auto in = output_shape();
+			assert(in.flat() && "Dense layers need a flat input, add a flatten layer first.");
+
+			m_layers.push_back({ LayerType::dense, in, { outputs, 1, 1 }, 1, 1, 0, {}, {}, activation });
+			_allocate_();
+		}
+
+		/**
+		 * @brief Initialize all parameters, layer by layer the weights then the biases
+		 * @param init Functor used to initialize the network. Sig.: double func();
+		 */
+		template<typename Init>
+		void initialize(Init &&init) requires std::invocable<Init>
+		{
+			for (auto &l : m_layers)
+			{
+				for (size_t i = 0; i < l.weights.size(); ++i) l.weights.data()[i] = static_cast<Weight>(init());
+				for (size_t i = 0; i < l.biases.size(); ++i) l.biases.data()[i] = static_cast<Weight>(init());
+			}
+		}
+
+		/**
+		 * @brief Returns the shape of a sample
+		 * @return input shape
+		 */
+		[[nodiscard]] auto input_shape() const noexcept -> Shape { return m_input; }
+
+		/**
+		 * @brief Returns the shape of the output of the last layer
+		 * @return output shape
+		 */
+		[[nodiscard]] auto output_shape() const noexcept -> Shape
+		{
+			return m_layers.empty() ? m_input : m_layers.back().out;
+		}
+
+		/**
+		 * @brief Returns all parameters. Layer by layer the weights then the biases, each starting on a ALIGNMENT
+		 * boundary.
+		 * @return parameter buffer
+		 */
+		[[nodiscard]] auto parameters() noexcept -> std::span<Weight> { return m_params; }
+		[[nodiscard]] auto parameters() const noexcept -> std::span<const Weight> { return m_params; }
+
+		/**
+		 * @brief Returns the number of layers within the network
+		 * @return layer number
+		 */
+		[[nodiscard]] auto layers_n() const noexcept -> size_t { return m_layers.size() + 1; }
+
+		/**
+		 * @brief Performs a feedforward query with given input
+		 * @param input Matrix input to use
+		 * @return result matrix
+		 */
+		[[nodiscard]] auto query(const mth::Matrix<double> &input) const { return query_batch(input); }
+
+		/**
+		 * @brief Performs a feedforward query on a batch of inputs. Hidden feature maps alternate between 2 buffers.
+		 *
+		 * @param policy Execution policy the GEMMs and channels are split with
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		template<exe::execution_policy P>
+		[[nodiscard]] auto query_batch(const P &policy, const mth::Matrix<double> &input) const
+		{
+			assert(!m_layers.empty() && input.dim().h == m_input.size() && "Input must match the input shape.");
+
+			const auto batch = input.dim().w;
+
+			size_t widest = 0;
+			for (const auto &l : m_layers) widest = std::max(widest, l.out.size());
+
+			std::vector<double> ping(widest * batch), pong(widest * batch), cols;
+
+			const auto *in = input.data();
+			for (const auto &l : m_layers)
+			{
+				if (l.type == LayerType::flatten)
+					continue;
+
+				auto *out = in == ping.data() ? pong.data() : ping.data();
+				detail::spatial_forward(policy, l, in, out, batch, cols);
+				in = out;
+			}
+
+			mth::Matrix<double> output(output_shape().size(), batch, 0.);
+			std::copy_n(in, output.size(), output.data());
+
+			return output;
+		}
+		/**
+		 * @brief Performs a sequential feedforward query on a batch of inputs
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		[[nodiscard]] auto query_batch(const mth::Matrix<double> &input) const { return query_batch(exe::seq, input); }
+
+		[[nodiscard]] auto begin() const noexcept { return m_layers.begin(); }
+		[[nodiscard]] auto begin() noexcept { return m_layers.begin(); }
+
+		[[nodiscard]] auto end() const noexcept { return m_layers.end(); }
+		[[nodiscard]] auto end() noexcept { return m_layers.end(); }
+
+	private:
+		Shape														   m_input;
+		std::vector<Weight, mem::AlignedAllocator<Weight, ALIGNMENT>> m_params;
+		std::vector<SpatialLayer<Weight>>							   m_layers;
+
+		void _add_pool_(LayerType type, size_t window, size_t stride)
+		{
+			const auto in = output_shape();
+			stride		  = stride == 0 ? window : stride;
+			assert(window > 0 && in.height >= window && in.width >= window && "Window must fit into the input.");
+
+			const Shape out = { in.channels, (in.height - window) / stride + 1, (in.width - window) / stride + 1 };
+			m_layers.push_back({ type, in, out, window, stride, 0, {}, {} });
+		}
+
+		/**
+		 * @brief Elements from the start of a matrix of n elements to the start of the next one
+		 */
+		static constexpr auto _padded_(size_t n) noexcept -> size_t
+		{
+			constexpr auto step = std::max<size_t>(1, ALIGNMENT / sizeof(Weight));
+			return (n + step - 1) / step * step;
+		}
+
+		/**
+		 * @brief Weight matrix dimension of a layer as rows and columns
+		 */
+		static auto _weights_dim_(const SpatialLayer<Weight> &l) noexcept -> std::pair<size_t, size_t>
+		{
+			switch (l.type)
+			{
+			case LayerType::dense:
+				return { l.out.size(), l.in.size() };
+			case LayerType::conv2d:
+				return { l.out.channels, l.in.channels * l.kernel * l.kernel };
+			default:
+				return { 0, 0 };
+			}
+		}
+
+		/**
+		 * @brief Sizes the buffer for the layers, zeroing new parameters, and points the layers into it
+		 */
+		void _allocate_()
+		{
+			size_t n = 0;
+			for (const auto &l : m_layers)
+			{
+				const auto [h, w] = _weights_dim_(l);
+				n += _padded_(h * w) + _padded_(h);
+			}
+
+			m_params.resize(n);
+			_bind_();
+		}
+
+		/**
+		 * @brief Points the views of the layers into the buffer
+		 */
+		void _bind_() noexcept
+		{
+			auto *p = m_params.data();
+			for (auto &l : m_layers)
+			{
+				const auto [h, w] = _weights_dim_(l);
+
+				l.weights = mth::MatrixView<Weight>(p, h, w), p += _padded_(h * w);
+				l.biases  = mth::MatrixView<Weight>(p, h, h == 0 ? 0 : 1), p += _padded_(h);
+			}
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Actions
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Performs a gradient descent step of a convolutional network on a batch. The gradients are averaged over
+	 * the columns.
+	 *
+	 * @param policy Execution policy the GEMMs and channels are split with
+	 * @param nn Neural Network to train on
+	 * @param input Inputs, one per column
+	 * @param output Expected outputs, one per column
+	 * @param opt Optimizer applying the gradients
+	 */
+	template<exe::execution_policy P, typename Weight, optimizer Opt>
+	void fit(const P &policy, ConvNeuralNetwork<Weight> &nn, const mth::Matrix<double> &input,
+			 const mth::Matrix<double> &output, Opt &opt)
+	{
+		const auto batch = input.dim().w;
+		assert(nn.begin() != nn.end() && input.dim().h == nn.input_shape().size()
+			   && output.dim().h == nn.output_shape().size() && output.dim().w == batch
+			   && "Input and output must match the network.");
+
+		const auto layers = static_cast<size_t>(nn.end() - nn.begin());
+		const auto params = nn.parameters();
+
+		// Feedforward, keeping every result. Flatten layers share the result of the layer before.
+		std::vector<std::vector<double>> results(layers);
+		std::vector<const double *>		 act(layers + 1, input.data());
+		std::vector<double>				 cols;
+
+		size_t widest = nn.input_shape().size();
+		for (size_t i = 0; const auto &l : nn)
+		{
+			widest = std::max(widest, l.out.size());
+
+			if (l.type == LayerType::flatten)
+				act[i + 1] = act[i];
+			else
+			{
+				results[i].resize(l.out.size() * batch);
+				detail::spatial_forward(policy, l, act[i], results[i].data(), batch, cols);
+				act[i + 1] = results[i].data();
+			}
+			++i;
+		}
+
+		// Loss of prediction to output
+		std::vector<double> err(widest * batch), err_prev(widest * batch), grad(params.size());
+		simd::transform(err.data(), output.data(), act[layers], output.size(), simd::Sub{});
+
+		// Back propagate the loss and sum up the gradients
+		for (auto l = layers; l-- > 0;)
+		{
+			const auto &layer  = *(nn.begin() + l);
+			const auto	pixels = layer.out.height * layer.out.width * batch;
+			const auto	in_n   = layer.in.size() * batch;
+
+			if (l > 0 && layer.type != LayerType::flatten)
+				std::fill_n(err_prev.begin(), in_n, 0.);
+
+			switch (layer.type)
+			{
+			case LayerType::dense:
+			case LayerType::conv2d:
+			{
+				const auto h = layer.weights.dim().h, w = layer.weights.dim().w;
+				const auto n = layer.type == LayerType::dense ? batch : pixels;
+
+				derive(layer.activation, act[l + 1], err.data(), layer.out.size(), batch);
+
+				mth::MatrixView<double> e(err.data(), h, n);
+
+				const auto *x = act[l];
+				if (layer.type == LayerType::conv2d)
+				{
+					cols.resize(w * n);
+					detail::im2col(act[l], layer.in, layer.kernel, layer.stride, layer.padding, layer.out, batch,
+								   cols.data());
+					x = cols.data();
+				}
+
+				mth::MatrixView<double> grad_w(grad.data() + (layer.weights.data() - params.data()), h, w);
+				mth::detail::strided_product(policy, e, mth::MatrixView<const double>(x, w, n).transpose(), grad_w);
+
+				auto *grad_b = grad.data() + (layer.biases.data() - params.data());
+				for (size_t r = 0; r < h; ++r) grad_b[r] += simd::sum(e.data() + r * n, n);
+
+				if (l == 0)
+					break;
+
+				if (layer.type == LayerType::dense)
+				{
+					mth::MatrixView<double> e_prev(err_prev.data(), w, n);
+					mth::detail::strided_product(policy, layer.weights.transpose(), e, e_prev);
+				}
+				else
+				{
+					std::fill_n(cols.begin(), w * n, 0.);
+					mth::MatrixView<double> d_cols(cols.data(), w, n);
+					mth::detail::strided_product(policy, layer.weights.transpose(), e, d_cols);
+					detail::col2im(cols.data(), layer.in, layer.kernel, layer.stride, layer.padding, layer.out, batch,
+								   err_prev.data());
+				}
+				break;
+			}
+			case LayerType::max_pool:
+			case LayerType::avg_pool:
+			{
+				if (l == 0)
+					break;
+
+				const auto k = layer.kernel, s = layer.stride;
+				const auto scale = 1. / static_cast<double>(k * k);
+
+				for (size_t c = 0; c < layer.out.channels; ++c)
+					for (size_t oy = 0; oy < layer.out.height; ++oy)
+						for (size_t ox = 0; ox < layer.out.width; ++ox)
+						{
+							const auto o   = ((c * layer.out.height + oy) * layer.out.width + ox) * batch;
+							const auto win = ((c * layer.in.height + oy * s) * layer.in.width + ox * s) * batch;
+
+							if (layer.type == LayerType::avg_pool)
+								for (size_t ky = 0; ky < k; ++ky)
+									for (size_t kx = 0; kx < k; ++kx)
+										simd::axpy(err_prev.data() + win + (ky * layer.in.width + kx) * batch, scale,
+												   err.data() + o, batch);
+							else
+								for (size_t n = 0; n < batch; ++n)
+								{
+									// The first maximum of the window takes the error
+									auto i = win + n;
+									for (size_t ky = 0; ky < k; ++ky)
+										for (size_t kx = 0; kx < k; ++kx)
+											if (const auto j = win + (ky * layer.in.width + kx) * batch + n;
+												act[l][j] > act[l][i])
+												i = j;
+
+									err_prev[i] += err[o + n];
+								}
+						}
+				break;
+			}
+			case LayerType::flatten:
+				std::copy_n(err.begin(), in_n, err_prev.begin());
+				break;
+			}
+
+			std::swap(err, err_prev);
+		}
+
+		opt.init(0, params.size());
+		opt.step();
+		opt.update(0, params.data(), grad.data(), 0, params.size(), 1. / static_cast<double>(batch));
+	}
+	/**
+	 * @brief Performs a sequential gradient descent step of a convolutional network on a batch
+	 *
+	 * @param nn Neural Network to train on
+	 * @param input Inputs, one per column
+	 * @param output Expected outputs, one per column
+	 * @param opt Optimizer applying the gradients
+	 */
+	template<typename Weight, optimizer Opt>
+	void fit(ConvNeuralNetwork<Weight> &nn, const mth::Matrix<double> &input, const mth::Matrix<double> &output,
+			 Opt &opt)
+	{
+		fit(exe::seq, nn, input, output, opt);
+	}
+	/**
+	 * @brief Performs a sequential gradient descent step of a convolutional network on a batch with plain SGD
+	 *
+	 * @param nn Neural Network to train on
+	 * @param input Inputs, one per column
+	 * @param output Expected outputs, one per column
+	 * @param learning_rate The learning speed
+	 */
+	template<typename Weight>
+	void fit(ConvNeuralNetwork<Weight> &nn, const mth::Matrix<double> &input, const mth::Matrix<double> &output,
+			 double learning_rate = 0.1)
+	{
+		SGD opt(learning_rate);
+		fit(exe::seq, nn, input, output, opt);
+	}
+
+} // namespace ctl::mcl
@@ -0,0 +1,699 @@
+#ifndef _CTL_DECOMPOSITION_
+#define _CTL_DECOMPOSITION_
+
+#include <vector>
+#include <cmath>
+#include <concepts>
+
+#include "Matrix.h"
+
+namespace ctl::mth
+{
+	namespace detail
+	{
+		/**
+		 * @brief Panel width of the blocked factorizations. Everything outside of the panels is updated with GEMM.
+		 */
+		static constexpr size_t DECOMPOSITION_BLOCK = 64;
+
+		/**
+		 * @brief Floating point type a decomposition of T is computed in
+		 */
+		template<typename T>
+		using decomposition_t = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+		/**
+		 * @brief Solves L * X = B in place. B has n rows of k elements. Diagonal blocks are solved row by row, the
+		 * rest is eliminated with GEMM.
+		 *
+		 * @tparam Unit Assume a unit diagonal
+		 * @param l Lower triangular matrix
+		 * @param rsl Row stride of l
+		 * @param csl Column stride of l
+		 */
+		template<bool Unit, typename T>
+		void trsm_lower(size_t n, size_t k, const T *l, size_t rsl, size_t csl, T *b, size_t rsb) noexcept
+		{
+			for (size_t i0 = 0; i0 < n; i0 += DECOMPOSITION_BLOCK)
+			{
+				const auto i1 = std::min(n, i0 + DECOMPOSITION_BLOCK);
+
+				if (i0 > 0)
+					kernel::gemm(i1 - i0, k, i0, l + i0 * rsl, rsl, csl, b, rsb, size_t(1), b + i0 * rsb, rsb, T(-1));
+
+				for (auto i = i0; i < i1; ++i)
+				{
+					for (auto j = i0; j < i; ++j) simd::axpy(b + i * rsb, -l[i * rsl + j * csl], b + j * rsb, k);
+
+					if constexpr (!Unit)
+						simd::transform(b + i * rsb, b + i * rsb, l[i * rsl + i * csl], k, simd::Div{});
+				}
+			}
+		}
+
+		/**
+		 * @brief Solves U * X = B in place. B has n rows of k elements. Blocks are processed from the bottom up.
+		 *
+		 * @param u Upper triangular matrix
+		 * @param rsu Row stride of u
+		 * @param csu Column stride of u
+		 */
+		template<typename T>
+		void trsm_upper(size_t n, size_t k, const T *u, size_t rsu, size_t csu, T *b, size_t rsb) noexcept
+		{
+			for (size_t i1 = n; i1 > 0;)
+			{
+				const auto i0 = i1 - std::min(i1, DECOMPOSITION_BLOCK);
+
+				if (i1 < n)
+					kernel::gemm(i1 - i0, k, n - i1, u + i0 * rsu + i1 * csu, rsu, csu, b + i1 * rsb, rsb, size_t(1),
+								 b + i0 * rsb, rsb, T(-1));
+
+				for (auto i = i1; i-- > i0;)
+				{
+					for (auto j = i + 1; j < i1; ++j) simd::axpy(b + i * rsb, -u[i * rsu + j * csu], b + j * rsb, k);
+					simd::transform(b + i * rsb, b + i * rsb, u[i * rsu + i * csu], k, simd::Div{});
+				}
+
+				i1 = i0;
+			}
+		}
+
+		/**
+		 * @brief Copy a expression into a contiguous matrix of type T
+		 */
+		template<typename T, matrix_expression E>
+		auto to_matrix(const E &e) -> Matrix<T>
+		{
+			if constexpr (std::same_as<E, Matrix<T>>)
+				return e;
+			else
+				return Matrix<T>(e.dim().h, e.dim().w, [&, i = size_t(0)]() mutable {
+					const auto v = e(i % e.dim().w, i / e.dim().w);
+					return ++i, static_cast<T>(v);
+				});
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// LU Decomposition
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief LU decomposition with partial pivoting P * A = L * U of a square matrix. Factorized in panels whose
+	 * trailing update runs on the blocked GEMM kernel.
+	 * @tparam Type Floating point type
+	 */
+	template<std::floating_point Type>
+	class LU
+	{
+	public:
+		/**
+		 * @brief Factorize a square matrix
+		 * @param a Matrix or expression
+		 */
+		template<matrix_expression E>
+		explicit LU(const E &a)
+			: m_lu(detail::to_matrix<Type>(a))
+			, m_piv(a.dim().h)
+		{
+			assert(a.dim().w == a.dim().h && "LU decomposition needs a square matrix.");
+			_factorize_();
+		}
+
+		/**
+		 * @brief Checks if the matrix was singular. Solving isn't possible then.
+		 * @return bool
+		 */
+		[[nodiscard]] auto is_singular() const noexcept -> bool { return m_singular; }
+
+		/**
+		 * @brief Get the combined factors. L is below the diagonal (with a implicit unit diagonal), U on and above.
+		 * @return Factors
+		 */
+		[[nodiscard]] auto factors() const noexcept -> const Matrix<Type> & { return m_lu; }
+		/**
+		 * @brief Get the row swapped with each row during the factorization
+		 * @return Pivots
+		 */
+		[[nodiscard]] auto pivots() const noexcept -> const std::vector<size_t> & { return m_piv; }
+
+		/**
+		 * @brief Solve A * X = B
+		 * @param b Right hand side with a column per system
+		 * @return X
+		 */
+		template<matrix_expression E>
+		auto solve(const E &b) const -> Matrix<Type>
+		{
+			assert(!m_singular && "Matrix is singular.");
+			assert(b.dim().h == m_lu.dim().h && "Right hand side must have as many rows as the matrix.");
+
+			auto x = detail::to_matrix<Type>(b);
+			_solve_inplace_(x);
+
+			return x;
+		}
+
+		/**
+		 * @brief Calculate the determinant
+		 * @return Determinant
+		 */
+		[[nodiscard]] auto determinant() const noexcept -> Type
+		{
+			auto det = m_sign;
+			for (size_t i = 0; i < m_lu.dim().h; ++i) det *= m_lu(i, i);
+
+			return det;
+		}
+
+		/**
+		 * @brief Calculate the inverse
+		 * @return Inverse
+		 */
+		[[nodiscard]] auto inverse() const -> Matrix<Type>
+		{
+			assert(!m_singular && "Matrix is singular.");
+
+			const auto n = m_lu.dim().h;
+
+			Matrix<Type> x(n, n, Type(0));
+			for (size_t i = 0; i < n; ++i) x(i, i) = Type(1);
+
+			_solve_inplace_(x);
+
+			return x;
+		}
+
+	private:
+		Matrix<Type>		m_lu;
+		std::vector<size_t> m_piv;
+		Type				m_sign	   = 1;
+		bool				m_singular = false;
+
+		void _factorize_() noexcept
+		{
+			const auto n = m_lu.dim().h;
+			auto	  *a = m_lu.data();
+
+			for (size_t k = 0; k < n; k += detail::DECOMPOSITION_BLOCK)
+			{
+				const auto kb = std::min(detail::DECOMPOSITION_BLOCK, n - k);
+
+				// Unblocked factorization of the panel. Whole rows are swapped.
+				for (auto j = k; j < k + kb; ++j)
+				{
+					auto p = j;
+					for (auto i = j + 1; i < n; ++i)
+						if (std::abs(a[i * n + j]) > std::abs(a[p * n + j]))
+							p = i;
+
+					m_piv[j] = p;
+					if (p != j)
+					{
+						std::swap_ranges(a + j * n, a + j * n + n, a + p * n);
+						m_sign = -m_sign;
+					}
+
+					if (a[j * n + j] == Type(0))
+					{
+						m_singular = true;
+						continue;
+					}
+
+					for (auto i = j + 1; i < n; ++i)
+					{
+						a[i * n + j] /= a[j * n + j];
+						simd::axpy(a + i * n + j + 1, -a[i * n + j], a + j * n + j + 1, k + kb - j - 1);
+					}
+				}
+
+				const auto rest = n - k - kb;
+				if (rest == 0)
+					break;
+
+				// U12 = L11^-1 * A12
+				detail::trsm_lower<true>(kb, rest, a + k * n + k, n, size_t(1), a + k * n + k + kb, n);
+
+				// A22 -= L21 * U12
+				kernel::gemm(rest, rest, kb, a + (k + kb) * n + k, n, size_t(1), a + k * n + k + kb, n, size_t(1),
+							 a + (k + kb) * n + k + kb, n, Type(-1));
+			}
+		}
+
+		void _solve_inplace_(Matrix<Type> &x) const noexcept
+		{
+			const auto n = m_lu.dim().h, k = x.dim().w;
+
+			for (size_t i = 0; i < n; ++i)
+				if (m_piv[i] != i)
+					std::swap_ranges(x.data() + i * k, x.data() + i * k + k, x.data() + m_piv[i] * k);
+
+			detail::trsm_lower<true>(n, k, m_lu.data(), n, size_t(1), x.data(), k);
+			detail::trsm_upper(n, k, m_lu.data(), n, size_t(1), x.data(), k);
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Cholesky Decomposition
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Cholesky decomposition A = L * L^T of a symmetric positive definite matrix. Only the lower triangle of A
+	 * is read. Factorized in panels whose trailing update runs on the blocked GEMM kernel.
+	 * @tparam Type Floating point type
+	 */
+	template<std::floating_point Type>
+	class Cholesky
+	{
+	public:
+		/**
+		 * @brief Factorize a symmetric positive definite matrix
+		 * @param a Matrix or expression
+		 */
+		template<matrix_expression E>
+		explicit Cholesky(const E &a)
+			: m_l(detail::to_matrix<Type>(a))
+		{
+			assert(a.dim().w == a.dim().h && "Cholesky decomposition needs a square matrix.");
+			_factorize_();
+		}
+
+		/**
+		 * @brief Checks if the matrix was positive definite. Solving isn't possible otherwise.
+		 * @return bool
+		 */
+		[[nodiscard]] auto is_positive_definite() const noexcept -> bool { return m_spd; }
+
+		/**
+		 * @brief Get the lower triangular factor
+		 * @return L
+		 */
+		[[nodiscard]] auto factor() const noexcept -> const Matrix<Type> & { return m_l; }
+
+		/**
+		 * @brief Solve A * X = B
+		 * @param b Right hand side with a column per system
+		 * @return X
+		 */
+		template<matrix_expression E>
+		auto solve(const E &b) const -> Matrix<Type>
+		{
+			assert(m_spd && "Matrix is not positive definite.");
+			assert(b.dim().h == m_l.dim().h && "Right hand side must have as many rows as the matrix.");
+
+			auto x = detail::to_matrix<Type>(b);
+			_solve_inplace_(x);
+
+			return x;
+		}
+
+		/**
+		 * @brief Calculate the determinant
+		 * @return Determinant
+		 */
+		[[nodiscard]] auto determinant() const noexcept -> Type
+		{
+			Type det = 1;
+			for (size_t i = 0; i < m_l.dim().h; ++i) det *= m_l(i, i) * m_l(i, i);
+
+			return det;
+		}
+
+		/**
+		 * @brief Calculate the inverse
+		 * @return Inverse
+		 */
+		[[nodiscard]] auto inverse() const -> Matrix<Type>
+		{
+			assert(m_spd && "Matrix is not positive definite.");
+
+			const auto n = m_l.dim().h;
+
+			Matrix<Type> x(n, n, Type(0));
+			for (size_t i = 0; i < n; ++i) x(i, i) = Type(1);
+
+			_solve_inplace_(x);
+
+			return x;
+		}
+
+	private:
+		Matrix<Type> m_l;
+		bool		 m_spd = true;
+
+		void _factorize_() noexcept
+		{
+			const auto n = m_l.dim().h;
+			auto	  *a = m_l.data();
+
+			for (size_t k = 0; k < n && m_spd; k += detail::DECOMPOSITION_BLOCK)
+			{
+				const auto kb = std::min(detail::DECOMPOSITION_BLOCK, n - k);
+
+				// Unblocked factorization of the panel: diagonal block and the rows below
+				for (auto j = k; j < k + kb; ++j)
+				{
+					auto d = a[j * n + j];
+					for (auto p = k; p < j; ++p) d -= a[j * n + p] * a[j * n + p];
+
+					if (!(d > Type(0)))
+					{
+						m_spd = false;
+						break;
+					}
+
+					a[j * n + j] = std::sqrt(d);
+
+					for (auto i = j + 1; i < n; ++i)
+					{
+						auto s = a[i * n + j];
+						for (auto p = k; p < j; ++p) s -= a[i * n + p] * a[j * n + p];
+
+						a[i * n + j] = s / a[j * n + j];
+					}
+				}
+
+				const auto rest = n - k - kb;
+				if (rest == 0 || !m_spd)
+					break;
+
+				// A22 -= L21 * L21^T
+				kernel::gemm(rest, rest, kb, a + (k + kb) * n + k, n, size_t(1), a + (k + kb) * n + k, size_t(1), n,
+							 a + (k + kb) * n + k + kb, n, Type(-1));
+			}
+
+			for (size_t i = 0; i < n; ++i) std::fill(a + i * n + i + 1, a + i * n + n, Type(0));
+		}
+
+		void _solve_inplace_(Matrix<Type> &x) const noexcept
+		{
+			const auto n = m_l.dim().h, k = x.dim().w;
+
+			detail::trsm_lower<false>(n, k, m_l.data(), n, size_t(1), x.data(), k);
+			detail::trsm_upper(n, k, m_l.data(), size_t(1), n, x.data(), k);
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// QR Decomposition
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Householder QR decomposition A = Q * R of a matrix with at least as many rows as columns. Reflectors of a
+	 * panel are combined into the compact WY form Q = I - V * T * V^T so they are applied with the blocked GEMM kernel.
+	 * @tparam Type Floating point type
+	 */
+	template<std::floating_point Type>
+	class QR
+	{
+	public:
+		/**
+		 * @brief Factorize a matrix
+		 * @param a Matrix or expression with rows >= columns
+		 */
+		template<matrix_expression E>
+		explicit QR(const E &a)
+			: m_qr(detail::to_matrix<Type>(a))
+			, m_tau(a.dim().w)
+		{
+			assert(a.dim().h >= a.dim().w && "QR decomposition needs at least as many rows as columns.");
+			_factorize_();
+		}
+
+		/**
+		 * @brief Checks if the columns of the matrix are linearly independent. Solving isn't possible otherwise.
+		 * @return bool
+		 */
+		[[nodiscard]] auto is_full_rank() const noexcept -> bool
+		{
+			for (size_t i = 0; i < m_qr.dim().w; ++i)
+				if (m_qr(i, i) == Type(0))
+					return false;
+
+			return true;
+		}
+
+		/**
+		 * @brief Get the upper triangular factor
+		 * @return R with as many rows as columns
+		 */
+		[[nodiscard]] auto r() const -> Matrix<Type>
+		{
+			const auto n = m_qr.dim().w;
+
+			Matrix<Type> r(n, n, Type(0));
+			for (size_t i = 0; i < n; ++i)
+				for (auto j = i; j < n; ++j) r(j, i) = m_qr(j, i);
+
+			return r;
+		}
+
+		/**
+		 * @brief Get the orthonormal factor
+		 * @return Q with as many columns as the matrix
+		 */
+		[[nodiscard]] auto q() const -> Matrix<Type>
+		{
+			const auto m = m_qr.dim().h, n = m_qr.dim().w;
+
+			Matrix<Type> q(m, n, Type(0));
+			for (size_t i = 0; i < n; ++i) q(i, i) = Type(1);
+
+			_apply_(q, false);
+
+			return q;
+		}
+
+		/**
+		 * @brief Solve A * X = B in the least squares sense
+		 * @param b Right hand side with a column per system
+		 * @return X
+		 */
+		template<matrix_expression E>
+		auto solve(const E &b) const -> Matrix<Type>
+		{
+			assert(is_full_rank() && "Matrix is rank deficient.");
+			assert(b.dim().h == m_qr.dim().h && "Right hand side must have as many rows as the matrix.");
+
+			const auto n = m_qr.dim().w, k = b.dim().w;
+
+			auto qtb = detail::to_matrix<Type>(b);
+			_apply_(qtb, true);
+
+			Matrix<Type> x(n, k, Type(0));
+			std::copy_n(qtb.data(), n * k, x.data());
+
+			detail::trsm_upper(n, k, m_qr.data(), n, size_t(1), x.data(), k);
+
+			return x;
+		}
+
+		/**
+		 * @brief Calculate the determinant of a square matrix
+		 * @return Determinant
+		 */
+		[[nodiscard]] auto determinant() const noexcept -> Type
+		{
+			assert(m_qr.dim().h == m_qr.dim().w && "Determinant needs a square matrix.");
+
+			Type det = 1;
+			for (size_t i = 0; i < m_qr.dim().w; ++i) det *= m_tau[i] == Type(0) ? m_qr(i, i) : -m_qr(i, i);
+
+			return det;
+		}
+
+	private:
+		Matrix<Type>			  m_qr; // R above the diagonal, reflectors below
+		std::vector<Type>		  m_tau;
+		std::vector<Matrix<Type>> m_t; // Triangular factor of each panel
+
+		void _factorize_()
+		{
+			const auto m = m_qr.dim().h, n = m_qr.dim().w;
+			auto	  *a = m_qr.data();
+
+			for (size_t k = 0; k < n; k += detail::DECOMPOSITION_BLOCK)
+			{
+				const auto kb = std::min(detail::DECOMPOSITION_BLOCK, n - k);
+
+				// Unblocked Householder on the panel
+				for (auto j = k; j < k + kb; ++j)
+				{
+					Type norm = 0;
+					for (auto i = j; i < m; ++i) norm += a[i * n + j] * a[i * n + j];
+					norm = std::sqrt(norm);
+
+					const auto alpha = a[j * n + j];
+					if (norm == Type(0) || (norm == std::abs(alpha) && j + 1 == m))
+					{
+						m_tau[j] = 0;
+						continue;
+					}
+
+					const auto beta = alpha > 0 ? -norm : norm;
+					m_tau[j]		= (beta - alpha) / beta;
+
+					const auto s = Type(1) / (alpha - beta);
+					for (auto i = j + 1; i < m; ++i) a[i * n + j] *= s;
+					a[j * n + j] = beta;
+
+					// Apply to the rest of the panel
+					for (auto c = j + 1; c < k + kb; ++c)
+					{
+						auto w = a[j * n + c];
+						for (auto i = j + 1; i < m; ++i) w += a[i * n + j] * a[i * n + c];
+
+						w *= m_tau[j];
+						a[j * n + c] -= w;
+						for (auto i = j + 1; i < m; ++i) a[i * n + c] -= w * a[i * n + j];
+					}
+				}
+
+				m_t.emplace_back(_triangular_factor_(k, kb));
+
+				if (k + kb < n)
+					_apply_block_(k, kb, m_t.back(), a + k * n + k + kb, n, n - k - kb, true);
+			}
+		}
+
+		/**
+		 * @brief Builds T of the panel so that H_k ... H_{k+kb-1} = I - V * T * V^T
+		 */
+		auto _triangular_factor_(size_t k, size_t kb) const -> Matrix<Type>
+		{
+			const auto v = _reflectors_(k, kb);
+			const auto m = v.dim().h;
+
+			Matrix<Type> t(kb, kb, Type(0));
+
+			for (size_t i = 0; i < kb; ++i)
+			{
+				t(i, i) = m_tau[k + i];
+
+				// t[0:i, i] = -tau_i * T[0:i, 0:i] * V[:, 0:i]^T * v_i
+				std::vector<Type> z(i, Type(0));
+				for (size_t r = 0; r < m; ++r)
+					for (size_t c = 0; c < i; ++c) z[c] += v(c, r) * v(i, r);
+
+				for (size_t r = 0; r < i; ++r)
+				{
+					Type s = 0;
+					for (auto c = r; c < i; ++c) s += t(c, r) * z[c];
+
+					t(i, r) = -m_tau[k + i] * s;
+				}
+			}
+
+			return t;
+		}
+
+		/**
+		 * @brief Get the reflectors of a panel as a explicit matrix with unit diagonal
+		 */
+		auto _reflectors_(size_t k, size_t kb) const -> Matrix<Type>
+		{
+			const auto m = m_qr.dim().h;
+
+			Matrix<Type> v(m - k, kb, Type(0));
+			for (size_t r = 0; r < m - k; ++r)
+				for (size_t c = 0; c < kb && c <= r; ++c) v(c, r) = c == r ? Type(1) : m_qr(k + c, k + r);
+
+			return v;
+		}
+
+		/**
+		 * @brief Applies (I - V * T * V^T) or its transpose onto the rows k.. of B
+		 *
+		 * @param b First row of B at row k
+		 * @param rsb Row stride of B
+		 * @param cols Columns of B
+		 * @param transpose Apply the transpose
+		 */
+		void _apply_block_(size_t k, size_t kb, const Matrix<Type> &t, Type *b, size_t rsb, size_t cols,
+						   bool transpose) const
+		{
+			const auto v = _reflectors_(k, kb);
+			const auto m = v.dim().h;
+
+			// W = V^T * B
+			Matrix<Type> w(kb, cols, Type(0));
+			kernel::gemm(kb, cols, m, v.data(), size_t(1), kb, b, rsb, size_t(1), w.data(), cols);
+
+			// W = T * W or T^T * W
+			Matrix<Type> tw(kb, cols, Type(0));
+			if (transpose)
+				kernel::gemm(kb, cols, kb, t.data(), size_t(1), kb, w.data(), cols, size_t(1), tw.data(), cols);
+			else
+				kernel::gemm(kb, cols, kb, t.data(), kb, size_t(1), w.data(), cols, size_t(1), tw.data(), cols);
+
+			// B -= V * W
+			kernel::gemm(m, cols, kb, v.data(), kb, size_t(1), tw.data(), cols, size_t(1), b, rsb, Type(-1));
+		}
+
+		/**
+		 * @brief Applies Q or Q^T onto B
+		 */
+		void _apply_(Matrix<Type> &b, bool transpose) const
+		{
+			const auto cols = b.dim().w;
+
+			if (transpose)
+				for (size_t p = 0, k = 0; p < m_t.size(); ++p, k += detail::DECOMPOSITION_BLOCK)
+					_apply_block_(k, m_t[p].dim().h, m_t[p], b.data() + k * cols, cols, cols, true);
+			else
+				for (auto p = m_t.size(); p-- > 0;)
+				{
+					const auto k = p * detail::DECOMPOSITION_BLOCK;
+					_apply_block_(k, m_t[p].dim().h, m_t[p], b.data() + k * cols, cols, cols, false);
+				}
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Solvers
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Solve A * X = B. Square systems use LU, others are solved in the least squares sense using QR.
+	 *
+	 * @param a Matrix
+	 * @param b Right hand side with a column per system
+	 * @return X
+	 */
+	template<matrix_expression E1, matrix_expression E2>
+	auto solve(const E1 &a, const E2 &b)
+	{
+		using T = detail::decomposition_t<std::common_type_t<typename E1::value_type, typename E2::value_type>>;
+
+		if (a.dim().w == a.dim().h)
+			return LU<T>(a).solve(b);
+		else
+			return QR<T>(a).solve(b);
+	}
+
+	/**
+	 * @brief Invert a square matrix using LU. The matrix must not be singular.
+	 * @param a Matrix
+	 * @return Inverse
+	 */
+	template<matrix_expression E>
+	auto inverse(const E &a)
+	{
+		return LU<detail::decomposition_t<typename E::value_type>>(a).inverse();
+	}
+
+	/**
+	 * @brief Calculate the determinant of a square matrix using LU
+	 * @param a Matrix
+	 * @return Determinant
+	 */
+	template<matrix_expression E>
+	auto determinant(const E &a)
+	{
+		return LU<detail::decomposition_t<typename E::value_type>>(a).determinant();
+	}
+
+} // namespace ctl::mth
+
+#endif
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <CustomLibrary/RandomGenerator.h>
+#include <CustomLibrary/ThreadPool.h>
 #include <CustomLibrary/Traits.h>
 
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
 namespace ctl::mcl
 {
 	/**
@@ -14,9 +23,192 @@ namespace ctl::mcl
 		a.fitness();
 	};
 
+	// -----------------------------------------------------------------------------
+	// Selection
+	// -----------------------------------------------------------------------------
+
 	/**
-	 * @brief A Genetic Algorithm implementation that selects sample parents from the input iterators using a rolette
-	 * style selection process. Moves the new generation to the destination iterator.
+	 * @brief How parents are picked from a population
+	 */
+	enum class Selection
+	{
+		roulette,	// Chance proportional to fitness + 1
+		rank,		// Chance proportional to the rank by fitness, the worst has rank 1
+		tournament, // Fittest of a few uniformly drawn individuals
+		universal	// Stochastic universal sampling, evenly spaced pointers over the roulette wheel
+	};
+
+	/**
+	 * @brief Selection strategy of a generation
+	 */
+	struct Strategy
+	{
+		Selection selection	 = Selection::roulette;
+		size_t	  tournament = 2; // Individuals drawn per tournament
+		size_t	  elites	 = 0; // Fittest individuals carried over unchanged
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Picks parents from a population according to a strategy. The fitness is read once per generation,
+		 * a pick is then at most a binary search. The roulette wheel gives every individual a slice of fitness + 1, so
+		 * unfit ones keep a chance and a single parent doesn't take over.
+		 */
+		class Selector
+		{
+		public:
+			/**
+			 * @brief Prepare the selection of a generation
+			 * @param begin Population begin
+			 * @param end Population end
+			 * @param strategy Selection strategy
+			 * @param children Number of children that will be bred
+			 * @param rng Generator of the universal sampling pointers
+			 */
+			template<typename Iter, typename G>
+			void build(Iter begin, Iter end, const Strategy &strategy, size_t children, G &rng)
+			{
+				const auto n = static_cast<size_t>(std::distance(begin, end));
+				assert(n > 0 && "Selector: population is empty.");
+				assert(strategy.tournament > 0 && "Selector: tournament is empty.");
+
+				m_strategy = strategy;
+				m_fitness.resize(n);
+				for (auto &f : m_fitness) f = (begin++)->fitness();
+
+				m_order.resize(n);
+				std::iota(m_order.begin(), m_order.end(), size_t(0));
+
+				const auto elites = std::min(strategy.elites, n);
+				std::partial_sort(m_order.begin(), m_order.begin() + elites, m_order.end(),
+								  [this](size_t a, size_t b) { return m_fitness[a] > m_fitness[b]; });
+				m_elites.assign(m_order.begin(), m_order.begin() + elites);
+
+				switch (strategy.selection)
+				{
+				case Selection::roulette:
+					_accumulate_([this](size_t i) { return m_fitness[i] + 1.; });
+					break;
+
+				case Selection::rank:
+					std::sort(m_order.begin(), m_order.end(),
+							  [this](size_t a, size_t b) { return m_fitness[a] < m_fitness[b]; });
+					_accumulate_([](size_t i) { return static_cast<double>(i + 1); });
+					break;
+
+				case Selection::tournament:
+					break;
+
+				case Selection::universal:
+					_accumulate_([this](size_t i) { return m_fitness[i] + 1.; });
+					_sample_(2 * children, rng);
+					break;
+				}
+			}
+
+			/**
+			 * @brief Picks a parent
+			 * @param slot Parent number in the generation, 2 per child
+			 * @param rng Generator
+			 * @return Index into the population
+			 */
+			template<typename G>
+			[[nodiscard]] auto pick(size_t slot, G &rng) const -> size_t
+			{
+				switch (m_strategy.selection)
+				{
+				case Selection::roulette:
+					return _spin_(std::uniform_real_distribution<>(0., m_cumulative.back())(rng));
+
+				case Selection::rank:
+					return m_order[_spin_(std::uniform_real_distribution<>(0., m_cumulative.back())(rng))];
+
+				case Selection::tournament:
+				{
+					std::uniform_int_distribution<size_t> draw(0, m_fitness.size() - 1);
+
+					auto best = draw(rng);
+					for (size_t i = 1; i < m_strategy.tournament; ++i)
+						if (const auto c = draw(rng); m_fitness[c] > m_fitness[best])
+							best = c;
+
+					return best;
+				}
+
+				case Selection::universal:
+					return m_parents[slot];
+				}
+
+				return 0;
+			}
+
+			/**
+			 * @brief Returns the fittest individuals, fittest first
+			 * @return Indices into the population
+			 */
+			[[nodiscard]] auto elites() const noexcept -> std::span<const size_t> { return m_elites; }
+
+		private:
+			Strategy			m_strategy;
+			std::vector<double> m_fitness, m_cumulative;
+			std::vector<size_t> m_order, m_elites, m_parents;
+
+			template<typename F>
+			void _accumulate_(F &&slice)
+			{
+				m_cumulative.resize(m_fitness.size());
+
+				auto total = 0.;
+				for (size_t i = 0; i < m_cumulative.size(); ++i) m_cumulative[i] = total += slice(i);
+			}
+
+			auto _spin_(double peak) const noexcept -> size_t
+			{
+				const auto i = std::upper_bound(m_cumulative.begin(), m_cumulative.end(), peak) - m_cumulative.begin();
+				return std::min(static_cast<size_t>(i), m_cumulative.size() - 1);
+			}
+
+			/**
+			 * @brief Stochastic universal sampling: n pointers spaced total / n apart from one random offset. The
+			 * picks are shuffled afterwards, since they come out ordered by position on the wheel.
+			 */
+			template<typename G>
+			void _sample_(size_t n, G &rng)
+			{
+				m_parents.resize(n);
+				if (n == 0)
+					return;
+
+				const auto step = m_cumulative.back() / static_cast<double>(n);
+				auto	   p	= std::uniform_real_distribution<>(0., step)(rng);
+
+				for (size_t j = 0, i = 0; j < n; ++j, p += step)
+				{
+					while (i + 1 < m_cumulative.size() && m_cumulative[i] <= p) ++i;
+					m_parents[j] = i;
+				}
+
+				std::shuffle(m_parents.begin(), m_parents.end(), rng);
+			}
+		};
+
+		/**
+		 * @brief SplitMix64 finalizer, spreads consecutive stream numbers over the whole seed space
+		 */
+		constexpr auto mix_seed(std::uint64_t x) noexcept -> std::uint64_t
+		{
+			x += 0x9e3779b97f4a7c15;
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+			return x ^ (x >> 31);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief A Genetic Algorithm implementation that selects sample parents from the input iterators using the
+	 * selection strategy, rolette style by default. Copies the elites and moves the new generation to the destination
+	 * iterator.
 	 *
 	 * @tparam Mix Function which has the type the iterator is pointing to.
 	 * @param begin Population begin
@@ -24,38 +216,172 @@ namespace ctl::mcl
 	 * @param dest_begin New generation begin (Must have enough space such as the difference between begin and end)
 	 * @param rand Randomization generator
 	 * @param breed The breed function taking in 2 parameters
+	 * @param strategy Selection strategy, elites require a copyable type and throw otherwise
 	 */
 	template<typename Iter1, typename Iter2, typename Gen, typename Mix>
-	void select(Iter1 begin, Iter1 end, Iter2 dest_begin, rnd::Random<Gen> &rand,
-				Mix breed) requires selectable<typename std::iterator_traits<Iter1>::value_type>
+	void select(Iter1 begin, Iter1 end, Iter2 dest_begin, rnd::Random<Gen> &rand, Mix breed,
+				const Strategy &strategy = {}) requires selectable<typename std::iterator_traits<Iter1>::value_type>
 		&&std::invocable<Mix, typename std::iterator_traits<Iter1>::value_type,
 						 typename std::iterator_traits<Iter1>::value_type>
 	{
 		using Type = typename std::iterator_traits<Iter1>::value_type;
 
-		// Initilize score
-		auto total_score = 0.;
-		for (auto iter = begin; iter != end; ++iter)
-			total_score += iter->fitness() + 1.; // avoid the same parent being selected all the time
+		const auto n	  = static_cast<size_t>(std::distance(begin, end));
+		const auto elites = std::min(strategy.elites, n);
 
-		for (size_t i = 0, n = std::distance(begin, end); i < n; ++i)
-		{
-			Iter1 parents[2];
+		if constexpr (!std::copyable<Type>)
+			if (elites > 0)
+				throw std::runtime_error("Elites require a copyable type.");
 
-			for (auto &parent : parents)
-			{
-				// Rolette style picking
-				auto i_pop = begin;
-				for (double peak = rand.rand_number(0., total_score); peak >= 0.; ++i_pop)
-					peak -= i_pop->fitness() + 1.;
+		detail::Selector selector;
+		selector.build(begin, end, strategy, n - elites, rand.generator());
 
-				--i_pop; // Adjust to the element that entered minus
+		if constexpr (std::copyable<Type>)
+			for (auto e : selector.elites()) *(dest_begin++) = *std::next(begin, e);
 
-				parent = i_pop;
-			}
+		for (size_t i = 0; i < n - elites; ++i)
+		{
+			const auto a = selector.pick(2 * i, rand.generator());
+			const auto b = selector.pick(2 * i + 1, rand.generator());
 
-			*(dest_begin++) = std::move(breed(*parents[0], *parents[1]));
+			*(dest_begin++) = std::move(breed(*std::next(begin, a), *std::next(begin, b)));
 		}
 	}
 
-} // namespace ctl::mcl
\ No newline at end of file
+	// -----------------------------------------------------------------------------
+	// Generational Engine
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Generational Genetic Algorithm over a double buffered population. Every generation prepares the
+	 * selection once, carries over the elites and breeds the rest of the next population in place of the one before
+	 * the current, in parallel according to the policy. The population is split into chunks of CHUNK which each draw
+	 * from their own random stream, seeded from the engine seed, the generation and the chunk. Results only depend on
+	 * the seed, not on the policy.
+	 *
+	 * @tparam T Individual, which must be copyable to fill the second buffer
+	 * @tparam G Random generator of the streams
+	 */
+	template<selectable T, rnd::random_generator G = rnd::Mersenne>
+	class GeneticEngine
+	{
+	public:
+		/**
+		 * @brief Children bred from one random stream
+		 */
+		static constexpr size_t CHUNK = 256;
+
+		/**
+		 * @brief Construct an engine
+		 * @param population Initial population with scored fitness
+		 * @param seed Seed of the random streams
+		 * @param strategy Selection strategy
+		 */
+		explicit GeneticEngine(std::vector<T> population, std::uint64_t seed = 0,
+							   const Strategy &strategy = {}) requires std::copyable<T>
+			: m_current(std::move(population))
+			, m_next(m_current)
+			, m_strategy(strategy)
+			, m_seed(seed)
+		{
+		}
+
+		/**
+		 * @brief Breeds the next generation and makes it the current population. breed is called concurrently with
+		 * a policy other than exe::seq and has one of the forms:
+		 * - void breed(const T &a, const T &b, T &child, G &rng); overwrites the child of 2 generations ago, so its
+		 *	 storage can be reused
+		 * - T breed(const T &a, const T &b, G &rng);
+		 *
+		 * @param policy Execution policy the chunks are split with
+		 * @param breed Breed function
+		 */
+		template<exe::execution_policy P, typename Mix>
+		void evolve(const P &policy, Mix &&breed)
+		{
+			const auto n = m_current.size(), chunks = (n + CHUNK - 1) / CHUNK;
+			const auto elites = std::min(m_strategy.elites, n);
+
+			auto prepare = _stream_(chunks, chunks);
+			m_selector.build(m_current.begin(), m_current.end(), m_strategy, n - elites, prepare);
+
+			exe::for_blocks(policy, chunks, CHUNK * BREED_WORK, [&](size_t c0, size_t c1) {
+				for (auto c = c0; c < c1; ++c)
+				{
+					auto rng = _stream_(c, chunks);
+
+					for (auto i = c * CHUNK; i < std::min(n, (c + 1) * CHUNK); ++i)
+					{
+						if (i < elites)
+						{
+							m_next[i] = m_current[m_selector.elites()[i]];
+							continue;
+						}
+
+						const auto &a = m_current[m_selector.pick(2 * (i - elites), rng)];
+						const auto &b = m_current[m_selector.pick(2 * (i - elites) + 1, rng)];
+
+						if constexpr (std::invocable<Mix &, const T &, const T &, T &, G &>)
+							breed(a, b, m_next[i], rng);
+						else
+							m_next[i] = breed(a, b, rng);
+					}
+				}
+			});
+
+			std::swap(m_current, m_next);
+			++m_generation;
+		}
+
+		/**
+		 * @brief Breeds the next generation sequentially
+		 * @param breed Breed function
+		 */
+		template<typename Mix>
+		void evolve(Mix &&breed)
+		{
+			evolve(exe::seq, std::forward<Mix>(breed));
+		}
+
+		/**
+		 * @brief Returns the current population, e.g. to score its fitness
+		 * @return population
+		 */
+		[[nodiscard]] auto population() noexcept -> std::span<T> { return m_current; }
+		[[nodiscard]] auto population() const noexcept -> std::span<const T> { return m_current; }
+
+		/**
+		 * @brief Returns the number of generations bred
+		 * @return generation
+		 */
+		[[nodiscard]] auto generation() const noexcept -> std::uint64_t { return m_generation; }
+
+		/**
+		 * @brief Sets the selection strategy of the following generations
+		 * @param strategy Selection strategy
+		 */
+		void strategy(const Strategy &strategy) noexcept { m_strategy = strategy; }
+		[[nodiscard]] auto strategy() const noexcept -> const Strategy & { return m_strategy; }
+
+	private:
+		/**
+		 * @brief Estimated work of breeding a child, compared against the threshold of the policy
+		 */
+		static constexpr size_t BREED_WORK = 256;
+
+		std::vector<T>	 m_current, m_next;
+		detail::Selector m_selector;
+		Strategy		 m_strategy;
+		std::uint64_t	 m_seed, m_generation = 0;
+
+		/**
+		 * @brief Random stream of a chunk in the current generation, stream number chunks prepares the selection
+		 */
+		auto _stream_(size_t chunk, size_t chunks) const -> G
+		{
+			return G(static_cast<typename G::result_type>(
+				detail::mix_seed(m_seed ^ detail::mix_seed(m_generation * (chunks + 1) + chunk))));
+		}
+	};
+
+} // namespace ctl::mcl
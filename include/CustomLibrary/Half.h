@@ -0,0 +1,260 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#if defined(__F16C__)
+#	include <immintrin.h>
+#endif
+
+namespace ctl::mth
+{
+	// -----------------------------------------------------------------------------
+	// Conversions
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief IEEE binary16 bits of a float, rounded to nearest even. Overflow gives infinity, NaNs stay quiet NaNs.
+		 */
+		constexpr auto float_to_half(float f) noexcept -> std::uint16_t
+		{
+#if defined(__F16C__)
+			if (!std::is_constant_evaluated())
+				return static_cast<std::uint16_t>(_cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT));
+#endif
+			const auto x	= std::bit_cast<std::uint32_t>(f);
+			const auto sign = static_cast<std::uint16_t>((x >> 16) & 0x8000);
+			const auto ax	= x & 0x7fffffff;
+
+			if (ax >= 0x47800000) // Too large for a half, infinity or NaN
+				return sign | (ax > 0x7f800000 ? 0x7e00 : 0x7c00);
+
+			if (ax < 0x38800000) // Subnormal half: let the float unit round by aligning the ulp to 2^-24
+				return sign | static_cast<std::uint16_t>(std::bit_cast<std::uint32_t>(std::bit_cast<float>(ax) + 0.5f)
+														  - 0x3f000000);
+
+			// Rebias the exponent and round the mantissa to nearest even
+			return sign | static_cast<std::uint16_t>((ax + 0xc8000fff + ((ax >> 13) & 1)) >> 13);
+		}
+
+		/**
+		 * @brief Float value of IEEE binary16 bits. Exact.
+		 */
+		constexpr auto half_to_float(std::uint16_t h) noexcept -> float
+		{
+#if defined(__F16C__)
+			if (!std::is_constant_evaluated())
+				return _cvtsh_ss(h);
+#endif
+			const auto sign = static_cast<std::uint32_t>(h & 0x8000) << 16;
+			const auto e	= static_cast<std::uint32_t>(h >> 10) & 0x1f;
+			const auto m	= static_cast<std::uint32_t>(h) & 0x3ff;
+
+			if (e == 0x1f)
+				return std::bit_cast<float>(sign | 0x7f800000 | (m << 13));
+			if (e == 0)
+			{
+				const auto v = static_cast<float>(m) * 0x1p-24f;
+				return sign ? -v : v;
+			}
+
+			return std::bit_cast<float>(sign | ((e + 112) << 23) | (m << 13));
+		}
+
+		/**
+		 * @brief bfloat16 bits of a float, rounded to nearest even. NaNs stay quiet NaNs.
+		 */
+		constexpr auto float_to_bfloat(float f) noexcept -> std::uint16_t
+		{
+			const auto x = std::bit_cast<std::uint32_t>(f);
+
+			if ((x & 0x7fffffff) > 0x7f800000)
+				return static_cast<std::uint16_t>((x >> 16) | 0x40);
+
+			return static_cast<std::uint16_t>((x + 0x7fff + ((x >> 16) & 1)) >> 16);
+		}
+
+		/**
+		 * @brief Float value of bfloat16 bits. Exact.
+		 */
+		constexpr auto bfloat_to_float(std::uint16_t b) noexcept -> float
+		{
+			return std::bit_cast<float>(static_cast<std::uint32_t>(b) << 16);
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Reduced Precision Types
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief IEEE half precision storage type. Converts implicitly from and to float, so arithmetic on it is done in
+	 * float precision.
+	 */
+	struct f16
+	{
+		std::uint16_t bits = 0;
+
+		constexpr f16() noexcept = default;
+		constexpr f16(float f) noexcept
+			: bits(detail::float_to_half(f))
+		{
+		}
+
+		constexpr operator float() const noexcept { return detail::half_to_float(bits); }
+
+		/**
+		 * @brief Create from raw bits
+		 * @param b IEEE binary16 bits
+		 * @return Half
+		 */
+		static constexpr auto from_bits(std::uint16_t b) noexcept -> f16
+		{
+			f16 h;
+			h.bits = b;
+			return h;
+		}
+	};
+
+	/**
+	 * @brief Brain floating point storage type. Float with the lower 16 mantissa bits cut off: same range, less
+	 * precision. Converts implicitly from and to float, so arithmetic on it is done in float precision.
+	 */
+	struct bf16
+	{
+		std::uint16_t bits = 0;
+
+		constexpr bf16() noexcept = default;
+		constexpr bf16(float f) noexcept
+			: bits(detail::float_to_bfloat(f))
+		{
+		}
+
+		constexpr operator float() const noexcept { return detail::bfloat_to_float(bits); }
+
+		/**
+		 * @brief Create from raw bits
+		 * @param b bfloat16 bits
+		 * @return Brain float
+		 */
+		static constexpr auto from_bits(std::uint16_t b) noexcept -> bf16
+		{
+			bf16 h;
+			h.bits = b;
+			return h;
+		}
+	};
+
+	/**
+	 * @brief 16 bit floating point storage types
+	 */
+	template<typename T>
+	concept reduced_precision = std::same_as<std::remove_cv_t<T>, f16> || std::same_as<std::remove_cv_t<T>, bf16>;
+
+	/**
+	 * @brief Types a matrix can hold
+	 */
+	template<typename T>
+	concept numeric = std::is_arithmetic_v<std::remove_reference_t<T>> || reduced_precision<T>;
+
+	/**
+	 * @brief Type computations on T are accumulated in. Float for reduced precision types.
+	 */
+	template<typename T>
+	using accumulate_t = std::conditional_t<reduced_precision<T>, float, T>;
+
+} // namespace ctl::mth
+
+// -----------------------------------------------------------------------------
+// Standard Library Specializations
+// -----------------------------------------------------------------------------
+
+template<typename T>
+requires std::is_arithmetic_v<T>
+struct std::common_type<ctl::mth::f16, T>
+{
+	using type = std::common_type_t<float, T>;
+};
+template<typename T>
+requires std::is_arithmetic_v<T>
+struct std::common_type<T, ctl::mth::f16>
+{
+	using type = std::common_type_t<float, T>;
+};
+template<typename T>
+requires std::is_arithmetic_v<T>
+struct std::common_type<ctl::mth::bf16, T>
+{
+	using type = std::common_type_t<float, T>;
+};
+template<typename T>
+requires std::is_arithmetic_v<T>
+struct std::common_type<T, ctl::mth::bf16>
+{
+	using type = std::common_type_t<float, T>;
+};
+template<>
+struct std::common_type<ctl::mth::f16, ctl::mth::bf16>
+{
+	using type = float;
+};
+template<>
+struct std::common_type<ctl::mth::bf16, ctl::mth::f16>
+{
+	using type = float;
+};
+
+template<>
+class std::numeric_limits<ctl::mth::f16>
+{
+	using T = ctl::mth::f16;
+
+public:
+	static constexpr bool is_specialized = true;
+	static constexpr bool is_signed		 = true;
+	static constexpr bool is_integer	 = false;
+	static constexpr bool is_exact		 = false;
+	static constexpr bool has_infinity	 = true;
+	static constexpr bool has_quiet_NaN	 = true;
+	static constexpr int  digits		 = 11;
+	static constexpr int  max_exponent	 = 16;
+	static constexpr int  min_exponent	 = -13;
+
+	static constexpr auto min() noexcept -> T { return T::from_bits(0x0400); }
+	static constexpr auto max() noexcept -> T { return T::from_bits(0x7bff); }
+	static constexpr auto lowest() noexcept -> T { return T::from_bits(0xfbff); }
+	static constexpr auto epsilon() noexcept -> T { return T::from_bits(0x1400); }
+	static constexpr auto infinity() noexcept -> T { return T::from_bits(0x7c00); }
+	static constexpr auto quiet_NaN() noexcept -> T { return T::from_bits(0x7e00); }
+	static constexpr auto denorm_min() noexcept -> T { return T::from_bits(0x0001); }
+};
+
+template<>
+class std::numeric_limits<ctl::mth::bf16>
+{
+	using T = ctl::mth::bf16;
+
+public:
+	static constexpr bool is_specialized = true;
+	static constexpr bool is_signed		 = true;
+	static constexpr bool is_integer	 = false;
+	static constexpr bool is_exact		 = false;
+	static constexpr bool has_infinity	 = true;
+	static constexpr bool has_quiet_NaN	 = true;
+	static constexpr int  digits		 = 8;
+	static constexpr int  max_exponent	 = 128;
+	static constexpr int  min_exponent	 = -125;
+
+	static constexpr auto min() noexcept -> T { return T::from_bits(0x0080); }
+	static constexpr auto max() noexcept -> T { return T::from_bits(0x7f7f); }
+	static constexpr auto lowest() noexcept -> T { return T::from_bits(0xff7f); }
+	static constexpr auto epsilon() noexcept -> T { return T::from_bits(0x3c00); }
+	static constexpr auto infinity() noexcept -> T { return T::from_bits(0x7f80); }
+	static constexpr auto quiet_NaN() noexcept -> T { return T::from_bits(0x7fc0); }
+	static constexpr auto denorm_min() noexcept -> T { return T::from_bits(0x0001); }
+};
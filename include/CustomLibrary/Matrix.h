@@ -3,24 +3,171 @@
 
 #include <vector>
 #include <functional>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <memory_resource>
 
 #include "Traits.h"
 #include "Dim.h"
+#include "MatrixKernel.h"
+#include "Simd.h"
+#include "ThreadPool.h"
+
+#define _ELEMENT_WISE_CHECK_(dim1, dim2) \
+	assert(dim1 == dim2 && "Elementwise applications need both matricies to be the same in dimension.");
 
 namespace ctl::mth
 {
+	// -----------------------------------------------------------------------------
+	// Concept
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Anything that can be read element by element like a matrix. Matrices and lazy expressions of them.
+	 */
+	template<typename T>
+	concept matrix_expression = requires(const T e, size_t i)
+	{
+		typename T::value_type;
+		typename T::allocator_type;
+
+		{
+			e.dim()
+		}
+		->std::convertible_to<Dim<size_t>>;
+
+		e(i, i);
+	};
+
+	/**
+	 * @brief Matrices whose elements lie in memory at a fixed row and column stride
+	 */
+	template<typename T>
+	concept strided_matrix = matrix_expression<T> && requires(const T e)
+	{
+		e.data();
+		e.row_stride();
+		e.col_stride();
+	};
+
+	template<typename Type>
+	class MatrixView;
+
+	namespace detail
+	{
+		template<typename T, typename E>
+		constexpr auto assign_vectorized(T *dst, const E &e, size_t first, size_t n) noexcept -> bool;
+
+		/**
+		 * @brief Checks if evaluating a expression into the row major data [dst, dst + dim.area()) reads elements that
+		 * were already overwritten. Operands laid out exactly like the destination (e.g. m = m + 1) read each element
+		 * before it is written and do not alias, unless the expression has other dimensions (e.g. a broadcast) and the
+		 * destination is resized. Constant evaluation can't order pointers so it always aliases.
+		 *
+		 * @param e Expression
+		 * @param dst Destination data
+		 * @param dim Dimensions of the destination data
+		 * @param in_place If the expression is evaluated elementwise into the same position so far
+		 */
+		template<typename T, typename E>
+		constexpr auto aliases(const E &e, const T *dst, const Dim<size_t> &dim, bool in_place = true) noexcept -> bool
+		{
+			if constexpr (arithmetic<E>)
+				return false;
+			else
+			{
+				in_place = in_place && e.dim() == dim;
+
+				if constexpr (requires { e.operand(); })
+					return aliases(e.operand(), dst, dim, in_place);
+				else if constexpr (requires { e.lhs(), e.rhs(); })
+					return aliases(e.lhs(), dst, dim, in_place) || aliases(e.rhs(), dst, dim, in_place);
+				else if constexpr (strided_matrix<E> && std::same_as<std::remove_const_t<typename E::value_type>, T>)
+				{
+					if (std::is_constant_evaluated())
+						return true;
+					if (e.dim().area() == 0 || dim.area() == 0)
+						return false;
+
+					const T *first = e.data();
+					if (in_place && first == dst && e.row_stride() == dim.w && e.col_stride() == 1)
+						return false;
+
+					const T *last = first + (e.dim().h - 1) * e.row_stride() + (e.dim().w - 1) * e.col_stride() + 1;
+					return std::less<const T *>()(first, dst + dim.area()) && std::less<const T *>()(dst, last);
+				}
+				else
+					return false;
+			}
+		}
+
+		/**
+		 * @brief Get the allocator instance of a expression rebound to A. Expressions without one (views, static
+		 * matrices) or with a unrelated allocator give a default constructed allocator.
+		 */
+		template<typename A, typename E>
+		constexpr auto allocator_of(const E &e) -> A
+		{
+			if constexpr (requires { A(e.get_allocator()); })
+				return A(e.get_allocator());
+			else
+				return A();
+		}
+
+		/**
+		 * @brief Accumulates the product of 2 strided matrices into c using the GEMM kernel
+		 */
+		template<strided_matrix A, strided_matrix B, typename C>
+		constexpr void strided_product(const A &a, const B &b, C &c) noexcept
+		{
+			assert(a.dim().w == b.dim().h && "Width must be same a height for dot product.");
+
+			kernel::gemm(a.dim().h, b.dim().w, a.dim().w, a.data(), a.row_stride(), a.col_stride(), b.data(),
+						 b.row_stride(), b.col_stride(), c.data(), c.dim().w);
+		}
+
+		/**
+		 * @brief Accumulates the product of 2 strided matrices into c. The rows of a and c are split into blocks which
+		 * are multiplied according to the execution policy.
+		 */
+		template<exe::execution_policy P, strided_matrix A, strided_matrix B, typename C>
+		void strided_product(const P &policy, const A &a, const B &b, C &c)
+		{
+			assert(a.dim().w == b.dim().h && "Width must be same a height for dot product.");
+
+			const auto m = a.dim().h, n = b.dim().w, k = a.dim().w;
+
+			exe::for_blocks(policy, m, n * k, [&](size_t r0, size_t r1) {
+				kernel::gemm(r1 - r0, n, k, a.data() + r0 * a.row_stride(), a.row_stride(), a.col_stride(), b.data(),
+							 b.row_stride(), b.col_stride(), c.data() + r0 * c.dim().w, c.dim().w);
+			});
+		}
+	} // namespace detail
+
 	// -----------------------------------------------------------------------------
 	// Matrix Implementation
 	// -----------------------------------------------------------------------------
 
-	template<arithmetic Type, typename Allocator = std::allocator<Type>>
+	template<numeric Type, typename Allocator = std::allocator<Type>>
 	class Matrix
 	{
 	public:
+		using value_type	 = Type;
+		using allocator_type = Allocator;
+
 		/**
 		 * @brief Construct a empty Matrix
 		 */
 		constexpr Matrix() = default;
+		/**
+		 * @brief Construct a empty Matrix using a allocator
+		 * @param alloc Allocator
+		 */
+		constexpr explicit Matrix(const Allocator &alloc)
+			: m_data(alloc)
+		{
+		}
 		/**
 		 * @brief Copy a matrix
 		 */
@@ -52,6 +199,19 @@ namespace ctl::mth
 			, m_data(r * c, val)
 		{
 		}
+		/**
+		 * @brief Create and initialize matrix from dimension using a allocator
+		 *
+		 * @param r Rows
+		 * @param c Columns
+		 * @param val Value to init
+		 * @param alloc Allocator
+		 */
+		constexpr Matrix(size_t r, size_t c, Type val, const Allocator &alloc)
+			: m_dim{ c, r }
+			, m_data(r * c, val, alloc)
+		{
+		}
 		/**
 		 * @brief Create a single matrix with only rows and 1 column
 		 * @param init Data to fill it with
@@ -89,6 +249,29 @@ namespace ctl::mth
 			while (m_data.size() < m_data.capacity()) m_data.emplace_back(generator());
 		}
 
+		/**
+		 * @brief Evaluate a matrix expression in a single pass into a new matrix
+		 * @param e Expression to evaluate
+		 */
+		template<matrix_expression E>
+		constexpr Matrix(const E &e)
+			: Matrix(e, detail::allocator_of<Allocator>(e))
+		{
+		}
+		/**
+		 * @brief Evaluate a matrix expression in a single pass into a new matrix using a allocator
+		 *
+		 * @param e Expression to evaluate
+		 * @param alloc Allocator
+		 */
+		template<matrix_expression E>
+		constexpr Matrix(const E &e, const Allocator &alloc)
+			: m_data(e.dim().area(), alloc)
+			, m_dim(e.dim())
+		{
+			_assign_(e);
+		}
+
 		//~Matrix()
 		//{
 		//	std::clog << "Destructor\n";
@@ -112,6 +295,25 @@ namespace ctl::mth
 		{
 			return apply([t](Type) constexpr { return t; });
 		}
+		/**
+		 * @brief Evaluate a matrix expression in a single pass into this matrix. Expressions reading this matrix at
+		 * other positions (e.g. m = m.view().transpose()) are evaluated into a temporary first.
+		 *
+		 * @param e Expression to evaluate
+		 * @return auto&
+		 */
+		template<matrix_expression E>
+		constexpr auto operator=(const E &e) -> Matrix &
+		{
+			if (detail::aliases(e, m_data.data(), m_dim))
+				return _swap_(Matrix(e, m_data.get_allocator()));
+
+			m_dim = e.dim();
+			m_data.resize(m_dim.area());
+			_assign_(e);
+
+			return *this;
+		}
 
 		/**
 		 * @brief Get a constant value from the matrix
@@ -139,6 +341,11 @@ namespace ctl::mth
 		 * @return data in form of ptr to const data
 		 */
 		constexpr auto data() const noexcept -> const Type * { return m_data.data(); }
+		/**
+		 * @brief Get the matrix data as a vals*
+		 * @return data in form of ptr to data
+		 */
+		constexpr auto data() noexcept -> Type * { return m_data.data(); }
 
 		/**
 		 * @brief Get the direct matrix location without column or row. Used primarily for iteration.
@@ -168,20 +375,67 @@ namespace ctl::mth
 		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> & { return m_dim; }
 
 		/**
-		 * @brief Perform a dot product with a other matrix
+		 * @brief Get the distance between 2 rows in memory
+		 * @return stride
+		 */
+		[[nodiscard]] constexpr auto row_stride() const noexcept -> size_t { return m_dim.w; }
+		/**
+		 * @brief Get the distance between 2 columns in memory
+		 * @return stride
+		 */
+		[[nodiscard]] constexpr auto col_stride() const noexcept -> size_t { return 1; }
+
+		/**
+		 * @brief Get the allocator of the matrix. Results of operations on the matrix use a copy of it.
+		 * @return Allocator
+		 */
+		[[nodiscard]] constexpr auto get_allocator() const noexcept -> Allocator { return m_data.get_allocator(); }
+
+		/**
+		 * @brief Perform a dot product with a other matrix or view. Large products use the cache blocked GEMM kernel,
+		 * small and constexpr ones the naive loop. Reduced precision operands are accumulated and returned as float.
+		 * @param mat2 Other matrix
+		 * @return Result
+		 */
+		template<strided_matrix M>
+		constexpr auto dot_product(const M &mat2) const noexcept
+		{
+			using T = std::common_type_t<accumulate_t<typename M::value_type>, accumulate_t<Type>>;
+
+			using A = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+			Matrix<T, A> mat(m_dim.h, mat2.dim().w, T(0), A(get_allocator()));
+			detail::strided_product(*this, mat2, mat);
+
+			return mat;
+		}
+		/**
+		 * @brief Perform a dot product with a matrix expression. The expression is materialized first.
+		 * @param e Other expression
+		 * @return Result
+		 */
+		template<matrix_expression E>
+		constexpr auto dot_product(const E &e) const noexcept requires(!strided_matrix<E>)
+		{
+			return dot_product(Matrix<typename E::value_type, typename E::allocator_type>(e));
+		}
+		/**
+		 * @brief Perform a dot product with a other matrix or view. The rows of the result are split into blocks which
+		 * are computed according to the execution policy.
+		 *
+		 * @param policy Execution policy
 		 * @param mat2 Other matrix
 		 * @return Result
 		 */
-		template<typename T, typename Alloc>
-		constexpr auto dot_product(const Matrix<T, Alloc> &mat2) const noexcept
+		template<exe::execution_policy P, strided_matrix M>
+		auto dot_product(const P &policy, const M &mat2) const
 		{
-			assert(m_dim.w == mat2.dim().h && "Width must be same a height for dot product.");
+			using T = std::common_type_t<accumulate_t<typename M::value_type>, accumulate_t<Type>>;
 
-			Matrix<std::common_type_t<T, Type>, Allocator> mat(m_dim.h, mat2.dim().w, 0);
+			using A = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
 
-			for (size_t y1 = 0; y1 < m_dim.h; ++y1)
-				for (size_t x2 = 0; x2 < mat2.dim().w; ++x2)
-					for (size_t x1 = 0; x1 < m_dim.w; ++x1) mat(x2, y1) += (*this)(x1, y1) * mat2(x2, x1);
+			Matrix<T, A> mat(m_dim.h, mat2.dim().w, T(0), A(get_allocator()));
+			detail::strided_product(policy, *this, mat2, mat);
 
 			return mat;
 		}
@@ -192,13 +446,45 @@ namespace ctl::mth
 		 */
 		constexpr auto transpose() const noexcept
 		{
-			Matrix mat(m_dim.w, m_dim.h);
+			Matrix mat(m_dim.w, m_dim.h, Type(), get_allocator());
+			kernel::transpose(m_dim.h, m_dim.w, data(), m_dim.w, mat.data(), m_dim.h);
+
+			return mat;
+		}
+		/**
+		 * @brief Transpose the matrix to a new matrix. The rows of the result are split according to the execution
+		 * policy.
+		 *
+		 * @param policy Execution policy
+		 * @return Transposed matrix
+		 */
+		template<exe::execution_policy P>
+		auto transpose(const P &policy) const
+		{
+			Matrix mat(m_dim.w, m_dim.h, Type(), get_allocator());
 
-			for (size_t x = 0; x < m_dim.w; ++x)
-				for (size_t y = 0; y < m_dim.h; ++y) mat.emplace_back((*this)(x, y));
+			exe::for_blocks(policy, m_dim.w, m_dim.h, [&](size_t r0, size_t r1) {
+				kernel::transpose(m_dim.h, r1 - r0, data() + r0, m_dim.w, mat.data() + r0 * m_dim.h, m_dim.h);
+			});
 
 			return mat;
 		}
+		/**
+		 * @brief Transpose the matrix in place. Square matrices are transposed cache obliviously, rectangular ones by
+		 * following the permutation cycles which only needs a bit per element of extra memory.
+		 * @return auto&
+		 */
+		constexpr auto transpose_inplace() -> Matrix &
+		{
+			if (m_dim.w == m_dim.h)
+				kernel::transpose_square(m_dim.w, m_data.data(), m_dim.w);
+			else
+				kernel::transpose_cycles(m_dim.h, m_dim.w, m_data.data());
+
+			std::swap(m_dim.w, m_dim.h);
+
+			return *this;
+		}
 
 		/**
 		 * @brief Apply a function with a seperate iterator onto the matrix
@@ -206,7 +492,7 @@ namespace ctl::mth
 		 * @param i2 Other container iterator
 		 */
 		template<typename _F, typename _Iter>
-		constexpr auto apply(_F func, _Iter i2) noexcept -> auto &
+		constexpr auto apply(_F func, _Iter i2) noexcept -> auto &requires(!exe::execution_policy<_F>)
 		{
 			std::transform(m_data.begin(), m_data.end(), i2, m_data.begin(), func);
 			return *this;
@@ -221,6 +507,52 @@ namespace ctl::mth
 			std::transform(m_data.begin(), m_data.end(), m_data.begin(), std::move(func));
 			return *this;
 		}
+		/**
+		 * @brief Apply a function onto the matrix. The rows are split according to the execution policy.
+		 *
+		 * @param policy Execution policy
+		 * @param func Unary function. Must be safe to call concurrently.
+		 */
+		template<exe::execution_policy P, typename F>
+		auto apply(const P &policy, F func) -> auto &
+		{
+			exe::for_blocks(policy, m_dim.h, m_dim.w, [&](size_t r0, size_t r1) {
+				std::transform(m_data.begin() + r0 * m_dim.w, m_data.begin() + r1 * m_dim.w,
+							   m_data.begin() + r0 * m_dim.w, func);
+			});
+
+			return *this;
+		}
+
+		/**
+		 * @brief Evaluate a matrix expression into this matrix. The rows are split according to the execution policy.
+		 * Elementwise expressions may reference this matrix. (e.g. m.assign(exe::par(), m + 1)) Others reading it at
+		 * different positions are evaluated into a temporary first.
+		 *
+		 * @param policy Execution policy
+		 * @param e Expression to evaluate
+		 * @return auto&
+		 */
+		template<exe::execution_policy P, matrix_expression E>
+		auto assign(const P &policy, const E &e) -> Matrix &
+		{
+			if (detail::aliases(e, m_data.data(), m_dim))
+			{
+				Matrix res(e.dim().h, e.dim().w, Type(), m_data.get_allocator());
+				res.assign(policy, e);
+				return _swap_(std::move(res));
+			}
+
+			if (m_dim != e.dim())
+			{
+				m_dim = e.dim();
+				m_data.resize(m_dim.area());
+			}
+
+			exe::for_blocks(policy, m_dim.h, m_dim.w, [&](size_t r0, size_t r1) { _assign_(e, r0, r1); });
+
+			return *this;
+		}
 
 		/**
 		 * @brief Emplace_back a reserved container (must have capacity left)
@@ -239,6 +571,70 @@ namespace ctl::mth
 		 */
 		[[nodiscard]] constexpr auto size() const noexcept -> size_t { return m_dim.area(); }
 
+		/**
+		 * @brief Get a view of the whole matrix
+		 * @return View
+		 */
+		constexpr auto view() noexcept { return MatrixView<Type>(data(), m_dim.h, m_dim.w); }
+		/**
+		 * @brief Get a read only view of the whole matrix
+		 * @return View
+		 */
+		constexpr auto view() const noexcept { return MatrixView<const Type>(data(), m_dim.h, m_dim.w); }
+
+		/**
+		 * @brief Get a view of a rectangular block of the matrix
+		 *
+		 * @param r First row
+		 * @param c First column
+		 * @param rows Rows of the block
+		 * @param cols Columns of the block
+		 * @return View
+		 */
+		constexpr auto block(size_t r, size_t c, size_t rows, size_t cols) noexcept
+		{
+			return view().block(r, c, rows, cols);
+		}
+		/**
+		 * @brief Get a read only view of a rectangular block of the matrix
+		 *
+		 * @param r First row
+		 * @param c First column
+		 * @param rows Rows of the block
+		 * @param cols Columns of the block
+		 * @return View
+		 */
+		constexpr auto block(size_t r, size_t c, size_t rows, size_t cols) const noexcept
+		{
+			return view().block(r, c, rows, cols);
+		}
+
+		/**
+		 * @brief Get a view of a row
+		 * @param r Row
+		 * @return View
+		 */
+		constexpr auto row(size_t r) noexcept { return view().row(r); }
+		/**
+		 * @brief Get a read only view of a row
+		 * @param r Row
+		 * @return View
+		 */
+		constexpr auto row(size_t r) const noexcept { return view().row(r); }
+
+		/**
+		 * @brief Get a view of a column
+		 * @param c Column
+		 * @return View
+		 */
+		constexpr auto col(size_t c) noexcept { return view().col(c); }
+		/**
+		 * @brief Get a read only view of a column
+		 * @param c Column
+		 * @return View
+		 */
+		constexpr auto col(size_t c) const noexcept { return view().col(c); }
+
 		/**
 		 * @brief Iterator const begin
 		 * @return begin
@@ -264,227 +660,1599 @@ namespace ctl::mth
 	private:
 		std::vector<Type, Allocator> m_data;
 		Dim<size_t>					 m_dim;
-	};
 
-	// -----------------------------------------------------------------------------
-	// Arithmitic Overloads
-	// -----------------------------------------------------------------------------
+		/**
+		 * @brief Take over the data of a matrix using the same allocator
+		 */
+		constexpr auto _swap_(Matrix &&m) noexcept -> Matrix &
+		{
+			m_data.swap(m.m_data);
+			m_dim = m.m_dim;
 
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator-(Matrix<T, Alloc> m) noexcept
-	{
-		return m.apply([](T t) constexpr { return -t; });
-	}
+			return *this;
+		}
 
-	// --------------------------------- lv -----------------------------------------
+		template<typename E>
+		constexpr void _assign_(const E &e) noexcept
+		{
+			_assign_(e, 0, m_dim.h);
+		}
 
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator+=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
-	{
-		return mat.apply([x](T y) constexpr { return y + x; });
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator-=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
-	{
-		return mat.apply([x](T y) constexpr { return y - x; });
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator*=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
-	{
-		return mat.apply([x](T y) constexpr { return y * x; });
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator/=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
-	{
-		return mat.apply([x](T y) constexpr { return y / x; });
-	}
+		template<typename E>
+		constexpr void _assign_(const E &e, size_t r0, size_t r1) noexcept
+		{
+			if (!std::is_constant_evaluated()
+				&& detail::assign_vectorized(m_data.data(), e, r0 * m_dim.w, (r1 - r0) * m_dim.w))
+				return;
 
-#define _ELEMENT_WISE_CHECK_(dim1, dim2) \
-	assert(dim1 == dim2 && "Elementwise applications need both matricies to be the same in dimension.");
+			for (size_t r = r0; r < r1; ++r)
+				for (size_t c = 0; c < m_dim.w; ++c) m_data[c + m_dim.w * r] = static_cast<Type>(e(c, r));
+		}
+	};
 
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator+=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
-	{
-		_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
-		return mat1.apply(std::plus{}, mat2.begin());
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator-=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
-	{
-		_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
-		return mat1.apply(std::minus{}, mat2.begin());
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator*=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
-	{
-		_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
-		return mat1.apply(std::multiplies{}, mat2.begin());
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator/=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
+	namespace pmr
 	{
-		_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
-		return mat1.apply(std::divides{}, mat2.begin());
-	}
-
-	// --------------------------------- rv (&&) -----------------------------------------
+		/**
+		 * @brief Matrix using a polymorphic allocator. (e.g. on a mem::Arena)
+		 */
+		template<numeric Type>
+		using Matrix = mth::Matrix<Type, std::pmr::polymorphic_allocator<Type>>;
+	} // namespace pmr
 
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator+(Matrix<T, Alloc> &&mat, T x) noexcept -> auto &&
-	{
-		return mat += x;
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator-(Matrix<T, Alloc> &&mat, T x) noexcept -> auto &&
-	{
-		return mat -= x;
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator*(Matrix<T, Alloc> &&mat, T x) noexcept -> auto &&
-	{
-		return mat *= x;
-	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator/(Matrix<T, Alloc> &&mat, T x) noexcept -> auto &&
-	{
-		return mat /= x;
-	}
+	// -----------------------------------------------------------------------------
+	// Matrix View
+	// -----------------------------------------------------------------------------
 
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator+(Matrix<T1, Alloc1> &&mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &&
-	{
-		return mat1 += mat2;
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator-(Matrix<T1, Alloc1> &&mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &&
-	{
-		return mat1 -= mat2;
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator*(Matrix<T1, Alloc1> &&mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &&
-	{
-		return mat1 *= mat2;
-	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator/(Matrix<T1, Alloc1> &&mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &&
+	/**
+	 * @brief Non-owning strided window onto matrix data. Used for blocks, rows, columns, transposes and external
+	 * buffers without copying. Type may be const for read only views. Copy assigning a named view rebinds it, while
+	 * assigning to a temporary view (e.g. m.block(...) = other) or assign copies the elements.
+	 *
+	 * @tparam Type Element type
+	 */
+	template<typename Type>
+	class MatrixView
 	{
-		return mat1 /= mat2;
-	}
+	public:
+		using value_type	 = std::remove_const_t<Type>;
+		using allocator_type = std::allocator<value_type>;
 
-	// forwarding right
+		constexpr MatrixView()					 = default;
+		constexpr MatrixView(const MatrixView &) = default;
 
-	template<typename Type, typename Allocator>
-	constexpr auto operator+(const Matrix<Type, Allocator> &m1, Matrix<Type, Allocator> &&m2) -> auto &&
-	{
-		return m2 += m1;
-	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator-(const Matrix<Type, Allocator> &m1, Matrix<Type, Allocator> &&m2) -> auto &&
-	{
-		return -m2 + m1;
-	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator*(const Matrix<Type, Allocator> &m1, Matrix<Type, Allocator> &&m2) -> auto &&
-	{
-		return m2 *= m1;
-	}
+		constexpr auto operator=(const MatrixView &) & -> MatrixView & = default;
 
-	// forwarding both
+		/**
+		 * @brief View over contiguous row major data
+		 *
+		 * @param data Data
+		 * @param r Rows
+		 * @param c Columns
+		 */
+		constexpr MatrixView(Type *data, size_t r, size_t c) noexcept
+			: MatrixView(data, r, c, c)
+		{
+		}
+		/**
+		 * @brief View over row major data with rows being stride elements apart
+		 *
+		 * @param data Data
+		 * @param r Rows of the view
+		 * @param c Columns of the view
+		 * @param stride Distance between 2 rows of the underlying data
+		 * @param offset Offset of the first element from data
+		 * @param transposed Views the data as transposed. The underlying data then has c rows of r columns.
+		 */
+		constexpr MatrixView(Type *data, size_t r, size_t c, size_t stride, size_t offset = 0,
+							 bool transposed = false) noexcept
+			: m_data(data + offset)
+			, m_dim{ c, r }
+			, m_rs(transposed ? 1 : stride)
+			, m_cs(transposed ? stride : 1)
+		{
+		}
+		/**
+		 * @brief View a read only view from a mutable one
+		 */
+		template<typename T>
+		constexpr MatrixView(const MatrixView<T> &v) noexcept
+			requires(std::is_const_v<Type> &&std::same_as<const T, Type>)
+			: m_data(v.data())
+			, m_dim(v.dim())
+			, m_rs(v.row_stride())
+			, m_cs(v.col_stride())
+		{
+		}
+
+		/**
+		 * @brief Copy the elements of a expression into the viewed data
+		 * @param e Expression of same dimensions
+		 * @return this
+		 */
+		template<matrix_expression E>
+		constexpr auto operator=(const E &e) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return assign(e);
+		}
+		/**
+		 * @brief Set all viewed elements to a value
+		 * @param t Value
+		 * @return this
+		 */
+		constexpr auto operator=(value_type t) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return apply([t](value_type) constexpr { return t; });
+		}
+
+		/**
+		 * @brief Copy the elements of a expression (also another view) into the viewed data
+		 * @param e Expression of same dimensions
+		 * @return this
+		 */
+		template<matrix_expression E>
+		constexpr auto assign(const E &e) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return _compound_(e, [](value_type, auto b) constexpr { return b; });
+		}
+
+		/**
+		 * @brief Get a value of the view
+		 * @param c column
+		 * @param r row
+		 */
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> Type &
+		{
+			assert(c < m_dim.w && r < m_dim.h);
+			return m_data[r * m_rs + c * m_cs];
+		}
+
+		/**
+		 * @brief Get the first viewed element
+		 * @return ptr to data
+		 */
+		constexpr auto data() const noexcept -> Type * { return m_data; }
+		/**
+		 * @brief Get the dimensions of the view
+		 * @return Dim
+		 */
+		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> & { return m_dim; }
+		/**
+		 * @brief Gets the total size of the view
+		 * @return size
+		 */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_t { return m_dim.area(); }
+		/**
+		 * @brief Get the distance between 2 rows in memory
+		 * @return stride
+		 */
+		[[nodiscard]] constexpr auto row_stride() const noexcept -> size_t { return m_rs; }
+		/**
+		 * @brief Get the distance between 2 columns in memory
+		 * @return stride
+		 */
+		[[nodiscard]] constexpr auto col_stride() const noexcept -> size_t { return m_cs; }
+		/**
+		 * @brief Checks if the view is a transpose of its data
+		 * @return bool
+		 */
+		[[nodiscard]] constexpr auto is_transposed() const noexcept -> bool { return m_cs != 1; }
+
+		/**
+		 * @brief Get a view of a rectangular block
+		 *
+		 * @param r First row
+		 * @param c First column
+		 * @param rows Rows of the block
+		 * @param cols Columns of the block
+		 * @return View
+		 */
+		constexpr auto block(size_t r, size_t c, size_t rows, size_t cols) const noexcept -> MatrixView
+		{
+			assert(r + rows <= m_dim.h && c + cols <= m_dim.w && "Block exceeds the view.");
+
+			auto v	= *this;
+			v.m_data = m_data + r * m_rs + c * m_cs;
+			v.m_dim	= { cols, rows };
+
+			return v;
+		}
+		/**
+		 * @brief Get a view of a row
+		 * @param r Row
+		 * @return View
+		 */
+		constexpr auto row(size_t r) const noexcept { return block(r, 0, 1, m_dim.w); }
+		/**
+		 * @brief Get a view of a column
+		 * @param c Column
+		 * @return View
+		 */
+		constexpr auto col(size_t c) const noexcept { return block(0, c, m_dim.h, 1); }
+
+		/**
+		 * @brief Get the transposed view of the same data. Nothing is copied.
+		 * @return View
+		 */
+		constexpr auto transpose() const noexcept -> MatrixView
+		{
+			auto v	= *this;
+			v.m_dim = { m_dim.h, m_dim.w };
+			std::swap(v.m_rs, v.m_cs);
+
+			return v;
+		}
+
+		/**
+		 * @brief Perform a dot product with a other matrix or view using the GEMM kernel on the strided data
+		 * @param mat2 Other matrix
+		 * @return Result
+		 */
+		template<strided_matrix M>
+		constexpr auto dot_product(const M &mat2) const noexcept
+		{
+			using T = std::common_type_t<accumulate_t<typename M::value_type>, accumulate_t<value_type>>;
+
+			Matrix<T> mat(m_dim.h, mat2.dim().w, T(0));
+			detail::strided_product(*this, mat2, mat);
+
+			return mat;
+		}
+		/**
+		 * @brief Perform a dot product with a matrix expression. The expression is materialized first.
+		 * @param e Other expression
+		 * @return Result
+		 */
+		template<matrix_expression E>
+		constexpr auto dot_product(const E &e) const noexcept requires(!strided_matrix<E>)
+		{
+			return dot_product(Matrix<typename E::value_type, typename E::allocator_type>(e));
+		}
+
+		/**
+		 * @brief Copy the viewed elements into a new matrix
+		 * @return Matrix
+		 */
+		constexpr auto eval() const { return Matrix<value_type>(*this); }
+
+		/**
+		 * @brief Apply a function onto the viewed elements
+		 * @param func Unary function
+		 */
+		template<typename F>
+		constexpr auto apply(F func) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			for (size_t r = 0; r < m_dim.h; ++r)
+				for (size_t c = 0; c < m_dim.w; ++c) (*this)(c, r) = func((*this)(c, r));
+
+			return *this;
+		}
+
+		template<typename T>
+		constexpr auto operator+=(const T &x) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return _compound_(x, simd::Add{});
+		}
+		template<typename T>
+		constexpr auto operator-=(const T &x) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return _compound_(x, simd::Sub{});
+		}
+		template<typename T>
+		constexpr auto operator*=(const T &x) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return _compound_(x, simd::Mul{});
+		}
+		template<typename T>
+		constexpr auto operator/=(const T &x) const noexcept -> const MatrixView & requires(!std::is_const_v<Type>)
+		{
+			return _compound_(x, simd::Div{});
+		}
+
+	private:
+		Type *		m_data = nullptr;
+		Dim<size_t> m_dim  = { 0, 0 };
+		size_t		m_rs = 0, m_cs = 1;
+
+		template<typename T, typename Op>
+		constexpr auto _compound_(const T &x, Op op) const noexcept -> const MatrixView &
+		{
+			if constexpr (arithmetic<T>)
+			{
+				if (m_cs == 1 && !std::is_constant_evaluated())
+					for (size_t r = 0; r < m_dim.h; ++r)
+						simd::transform(m_data + r * m_rs, m_data + r * m_rs, static_cast<value_type>(x), m_dim.w, op);
+				else
+					for (size_t r = 0; r < m_dim.h; ++r)
+						for (size_t c = 0; c < m_dim.w; ++c)
+							(*this)(c, r) = static_cast<value_type>(op((*this)(c, r), static_cast<value_type>(x)));
+			}
+			else
+			{
+				_ELEMENT_WISE_CHECK_(m_dim, x.dim());
+
+				for (size_t r = 0; r < m_dim.h; ++r)
+					for (size_t c = 0; c < m_dim.w; ++c)
+						(*this)(c, r) = static_cast<value_type>(op((*this)(c, r), x(c, r)));
+			}
+
+			return *this;
+		}
+	};
+
+	// -----------------------------------------------------------------------------
+	// Arithmitic Overloads
+	// -----------------------------------------------------------------------------
+
+	// --------------------------------- lv -----------------------------------------
+
+	template<arithmetic T, typename Alloc>
+	constexpr auto operator+=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
+	{
+		simd::transform(mat.data(), mat.data(), x, mat.size(), simd::Add{});
+		return mat;
+	}
+	template<arithmetic T, typename Alloc>
+	constexpr auto operator-=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
+	{
+		simd::transform(mat.data(), mat.data(), x, mat.size(), simd::Sub{});
+		return mat;
+	}
+	template<arithmetic T, typename Alloc>
+	constexpr auto operator*=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
+	{
+		simd::transform(mat.data(), mat.data(), x, mat.size(), simd::Mul{});
+		return mat;
+	}
+	template<arithmetic T, typename Alloc>
+	constexpr auto operator/=(Matrix<T, Alloc> &mat, T x) noexcept -> auto &
+	{
+		simd::transform(mat.data(), mat.data(), x, mat.size(), simd::Div{});
+		return mat;
+	}
+
+	namespace detail
+	{
+		/**
+		 * @brief Applies a elementwise operation of 2 matrices onto the first. Uses the SIMD kernel if both have the
+		 * same type.
+		 */
+		template<typename Op, typename T1, typename Alloc1, typename T2, typename Alloc2>
+		constexpr auto elementwise(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2, Op op) noexcept -> auto &
+		{
+			_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
+
+			if constexpr (std::is_same_v<T1, T2>)
+			{
+				simd::transform(mat1.data(), mat1.data(), mat2.data(), mat1.size(), op);
+				return mat1;
+			}
+			else
+				return mat1.apply([op](T1 a, T2 b) constexpr { return static_cast<T1>(op(a, b)); }, mat2.begin());
+		}
+	} // namespace detail
+
+	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
+	constexpr auto operator+=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
+	{
+		return detail::elementwise(mat1, mat2, simd::Add{});
+	}
+	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
+	constexpr auto operator-=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
+	{
+		return detail::elementwise(mat1, mat2, simd::Sub{});
+	}
+	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
+	constexpr auto operator*=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
+	{
+		return detail::elementwise(mat1, mat2, simd::Mul{});
+	}
+	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
+	constexpr auto operator/=(Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept -> auto &
+	{
+		return detail::elementwise(mat1, mat2, simd::Div{});
+	}
+
+	/**
+	 * @brief Fused scaled addition mat1 += alpha * mat2 without a temporary
+	 *
+	 * @param mat1 Matrix to add onto
+	 * @param alpha Scale of the other matrix
+	 * @param mat2 Other matrix
+	 * @return mat1
+	 */
+	template<arithmetic T, typename Alloc1, typename Alloc2>
+	constexpr auto axpy(Matrix<T, Alloc1> &mat1, T alpha, const Matrix<T, Alloc2> &mat2) noexcept -> auto &
+	{
+		_ELEMENT_WISE_CHECK_(mat1.dim(), mat2.dim());
+		simd::axpy(mat1.data(), alpha, mat2.data(), mat1.size());
+		return mat1;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Expression Templates
+	// -----------------------------------------------------------------------------
+
+	template<typename Op, typename E>
+	class UnaryExpr;
+
+	namespace detail
+	{
+		/**
+		 * @brief Lvalue operands are held by reference, rvalue operands and scalars by value so that no expression
+		 * ever dangles.
+		 */
+		template<typename T>
+		using expr_store_t = std::conditional_t<arithmetic<T> || !std::is_lvalue_reference_v<T>, std::remove_cvref_t<T>,
+												const std::remove_reference_t<T> &>;
+
+		template<typename T>
+		constexpr auto expr_at(const T &e, size_t c, size_t r) noexcept
+		{
+			if constexpr (arithmetic<T>)
+				return e;
+			else
+				return e(c, r);
+		}
+
+		template<typename T>
+		struct is_matrix : std::false_type
+		{
+		};
+
+		template<typename T, typename A>
+		struct is_matrix<Matrix<T, A>> : std::true_type
+		{
+		};
+
+		/**
+		 * @brief Checks if T is a owning Matrix of value type V
+		 */
+		template<typename T, typename V>
+		concept matrix_of = is_matrix<std::remove_cvref_t<T>>::value
+			&& std::same_as<typename std::remove_cvref_t<T>::value_type, V>;
+
+		/**
+		 * @brief Value type of a binary expression. Scalars combine with the element type of the matrix side like in
+		 * scalar arithmetic, so a int matrix times 0.5 is a double expression.
+		 */
+		template<typename L, typename R>
+		struct binary_value
+		{
+			using type = std::common_type_t<typename L::value_type, typename R::value_type>;
+		};
+
+		template<arithmetic L, typename R>
+		struct binary_value<L, R>
+		{
+			using type = std::common_type_t<L, typename R::value_type>;
+		};
+
+		template<typename L, arithmetic R>
+		struct binary_value<L, R>
+		{
+			using type = std::common_type_t<typename L::value_type, R>;
+		};
+
+		/**
+		 * @brief Scalars the SIMD kernels may convert to the element type T up front. Floating point scalars would
+		 * lose their fraction on integral elements.
+		 */
+		template<typename S, typename T>
+		concept scalar_of = arithmetic<S> && (std::floating_point<T> || std::integral<S>);
+
+		struct Negate
+		{
+			template<typename T>
+			constexpr auto operator()(T a) const noexcept
+			{
+				return -a;
+			}
+		};
+	} // namespace detail
+
+	/**
+	 * @brief Common interface of all lazy matrix expressions
+	 * @tparam Expr Expression type
+	 */
+	template<typename Expr>
+	class MatrixExpression : public crtp<Expr, MatrixExpression>
+	{
+	public:
+		/**
+		 * @brief Lazily apply a unary function onto each element of the expression
+		 * @param func Unary function
+		 * @return Expression
+		 */
+		template<typename F>
+		constexpr auto apply(F func) const &noexcept
+		{
+			return UnaryExpr<F, const Expr &>(*this->underlying(), std::move(func));
+		}
+		/**
+		 * @brief Lazily apply a unary function onto each element of the expression
+		 * @param func Unary function
+		 * @return Expression
+		 */
+		template<typename F>
+		constexpr auto apply(F func) &&noexcept
+		{
+			return UnaryExpr<F, Expr>(std::move(*this->underlying()), std::move(func));
+		}
+
+		/**
+		 * @brief Materialize the expression into a matrix
+		 * @return Matrix
+		 */
+		constexpr auto eval() const
+		{
+			return Matrix<typename Expr::value_type, typename Expr::allocator_type>(*this->underlying());
+		}
+
+		/**
+		 * @brief Materialize the expression and perform a dot product with it
+		 * @param mat2 Other matrix or expression
+		 * @return Result
+		 */
+		template<typename M>
+		constexpr auto dot_product(const M &mat2) const
+		{
+			return eval().dot_product(mat2);
+		}
+
+		/**
+		 * @brief Materialize the expression and transpose it
+		 * @return Transposed matrix
+		 */
+		constexpr auto transpose() const { return eval().transpose(); }
+
+		/**
+		 * @brief Gets the total size of the expression
+		 * @return size
+		 */
+		[[nodiscard]] constexpr auto size() const noexcept -> size_t { return this->underlying()->dim().area(); }
+	};
+
+	/**
+	 * @brief Lazy elementwise unary operation
+	 *
+	 * @tparam Op Unary function
+	 * @tparam E Operand (reference if held by reference)
+	 */
+	template<typename Op, typename E>
+	class UnaryExpr : public MatrixExpression<UnaryExpr<Op, E>>
+	{
+		using inner_t = std::remove_cvref_t<E>;
+
+	public:
+		using value_type = std::decay_t<std::invoke_result_t<const Op &, typename inner_t::value_type>>;
+		using allocator_type =
+			typename std::allocator_traits<typename inner_t::allocator_type>::template rebind_alloc<value_type>;
+
+		constexpr UnaryExpr(E &&e, Op op)
+			: m_e(std::forward<E>(e))
+			, m_op(std::move(op))
+		{
+		}
+
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> value_type { return m_op(m_e(c, r)); }
+		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> & { return m_e.dim(); }
+
+		constexpr auto operand() const noexcept -> const inner_t & { return m_e; }
+		constexpr auto op() const noexcept -> const Op & { return m_op; }
+
+		constexpr auto get_allocator() const -> allocator_type { return detail::allocator_of<allocator_type>(m_e); }
+
+	private:
+		detail::expr_store_t<E>	  m_e;
+		[[no_unique_address]] Op m_op;
+	};
+
+	/**
+	 * @brief Lazy elementwise binary operation of 2 expressions or a expression and a scalar
+	 *
+	 * @tparam Op Binary operation
+	 * @tparam L Left operand (reference if held by reference)
+	 * @tparam R Right operand (reference if held by reference)
+	 */
+	template<typename Op, typename L, typename R>
+	class BinaryExpr : public MatrixExpression<BinaryExpr<Op, L, R>>
+	{
+		using left_t  = std::remove_cvref_t<L>;
+		using right_t = std::remove_cvref_t<R>;
+
+		using matrix_t = std::conditional_t<arithmetic<left_t>, right_t, left_t>;
+
+	public:
+		using value_type = typename detail::binary_value<left_t, right_t>::type;
+		using allocator_type =
+			typename std::allocator_traits<typename matrix_t::allocator_type>::template rebind_alloc<value_type>;
+
+		constexpr BinaryExpr(L &&l, R &&r, Op op = {})
+			: m_l(std::forward<L>(l))
+			, m_r(std::forward<R>(r))
+			, m_op(std::move(op))
+		{
+			if constexpr (!arithmetic<left_t> && !arithmetic<right_t>)
+				_ELEMENT_WISE_CHECK_(m_l.dim(), m_r.dim());
+		}
+
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> value_type
+		{
+			return static_cast<value_type>(m_op(static_cast<value_type>(detail::expr_at(m_l, c, r)),
+												static_cast<value_type>(detail::expr_at(m_r, c, r))));
+		}
+		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> &
+		{
+			if constexpr (arithmetic<left_t>)
+				return m_r.dim();
+			else
+				return m_l.dim();
+		}
+
+		constexpr auto lhs() const noexcept -> const left_t & { return m_l; }
+		constexpr auto rhs() const noexcept -> const right_t & { return m_r; }
+		constexpr auto op() const noexcept -> const Op & { return m_op; }
+
+		constexpr auto get_allocator() const -> allocator_type
+		{
+			if constexpr (arithmetic<left_t>)
+				return detail::allocator_of<allocator_type>(m_r);
+			else
+				return detail::allocator_of<allocator_type>(m_l);
+		}
+
+	private:
+		detail::expr_store_t<L>	  m_l;
+		detail::expr_store_t<R>	  m_r;
+		[[no_unique_address]] Op m_op;
+	};
+
+	/**
+	 * @brief Lazy repetition of a row or column vector (or a single element) over a larger shape. Used to combine a
+	 * bias or scale vector with every row or column of a batch without materializing it.
+	 *
+	 * @tparam E Operand (reference if held by reference)
+	 */
+	template<typename E>
+	class Broadcast : public MatrixExpression<Broadcast<E>>
+	{
+		using inner_t = std::remove_cvref_t<E>;
+
+	public:
+		using value_type	 = typename inner_t::value_type;
+		using allocator_type = typename inner_t::allocator_type;
+
+		constexpr Broadcast(E &&e, const Dim<size_t> &dim)
+			: m_e(std::forward<E>(e))
+			, m_dim(dim)
+		{
+			assert((m_e.dim().w == dim.w || m_e.dim().w == 1) && (m_e.dim().h == dim.h || m_e.dim().h == 1)
+				   && "Only dimensions of size 1 can be broadcasted.");
+		}
+
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> value_type
+		{
+			return m_e(m_e.dim().w == 1 ? 0 : c, m_e.dim().h == 1 ? 0 : r);
+		}
+		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> & { return m_dim; }
+
+		constexpr auto operand() const noexcept -> const inner_t & { return m_e; }
+
+		constexpr auto get_allocator() const -> allocator_type { return detail::allocator_of<allocator_type>(m_e); }
+
+	private:
+		detail::expr_store_t<E> m_e;
+		Dim<size_t>				m_dim;
+	};
 
-	template<typename Type, typename Allocator>
-	constexpr auto operator+(Matrix<Type, Allocator> &&m1, Matrix<Type, Allocator> &&m2) -> auto &&
+	/**
+	 * @brief Repeat a row vector, column vector or single element expression over a shape
+	 *
+	 * @param e Expression with a width and height either matching dim or being 1
+	 * @param dim Shape to broadcast to
+	 * @return Expression
+	 */
+	template<typename E>
+	constexpr auto broadcast(E &&e, const Dim<size_t> &dim) noexcept requires matrix_expression<std::remove_cvref_t<E>>
 	{
-		return m1 += m2;
+		return Broadcast<E>(std::forward<E>(e), dim);
 	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator-(Matrix<Type, Allocator> &&m1, Matrix<Type, Allocator> &&m2) -> auto &&
+
+	namespace detail
+	{
+		template<typename T>
+		struct is_binary_expr : std::false_type
+		{
+		};
+
+		template<typename Op, typename L, typename R>
+		struct is_binary_expr<BinaryExpr<Op, L, R>> : std::true_type
+		{
+		};
+
+		template<typename T>
+		struct is_negate_expr : std::false_type
+		{
+		};
+
+		template<typename E>
+		struct is_negate_expr<UnaryExpr<Negate, E>> : std::true_type
+		{
+		};
+
+		template<typename T>
+		struct is_broadcast : std::false_type
+		{
+		};
+
+		template<typename E>
+		struct is_broadcast<Broadcast<E>> : std::true_type
+		{
+		};
+
+		/**
+		 * @brief Checks if T broadcasts a owning Matrix of value type V
+		 */
+		template<typename T, typename V>
+		concept broadcast_of = is_broadcast<std::remove_cvref_t<T>>::value
+			&& matrix_of<decltype(std::declval<const std::remove_cvref_t<T> &>().operand()), V>;
+
+		/**
+		 * @brief dst[i] = op(a[i], b[i]) over the flat elements [first, first + n) of a matrix with rows of w
+		 * elements, where b is broadcasted. Each row piece runs on the SIMD kernels.
+		 *
+		 * @tparam Reversed Compute op(b[i], a[i]) instead
+		 */
+		template<bool Reversed, typename T, typename M, typename Op>
+		constexpr void transform_broadcast(T *dst, const T *a, const M &b, size_t w, size_t first, size_t n,
+										  Op op) noexcept
+		{
+			const auto &bd = b.dim();
+
+			for (auto i = first; i < first + n;)
+			{
+				const auto r = i / w, c = i % w, len = std::min(w - c, first + n - i);
+				const auto *brow = b.data() + (bd.h == 1 ? 0 : r * bd.w);
+
+				if (bd.w == 1)
+				{
+					if constexpr (Reversed)
+						simd::transform(dst + i - first, brow[0], a + i, len, op);
+					else
+						simd::transform(dst + i - first, a + i, brow[0], len, op);
+				}
+				else
+				{
+					if constexpr (Reversed)
+						simd::transform(dst + i - first, brow + c, a + i, len, op);
+					else
+						simd::transform(dst + i - first, a + i, brow + c, len, op);
+				}
+
+				i += len;
+			}
+		}
+
+		/**
+		 * @brief Evaluates the flat expression shapes (matrix op matrix, matrix op scalar, scalar op matrix, -matrix,
+		 * converting copies) with the SIMD kernels
+		 *
+		 * @param dst Destination data
+		 * @param e Expression
+		 * @param first First flat element to evaluate
+		 * @param n Amount of elements to evaluate
+		 * @return If the expression was handled
+		 */
+		template<typename T, typename E>
+		constexpr auto assign_vectorized(T *dst, const E &e, size_t first, size_t n) noexcept -> bool
+		{
+			dst += first;
+
+			if constexpr (is_binary_expr<E>::value)
+			{
+				using L = std::remove_cvref_t<decltype(e.lhs())>;
+				using R = std::remove_cvref_t<decltype(e.rhs())>;
+
+				if constexpr (matrix_of<L, T> && matrix_of<R, T>)
+					simd::transform(dst, e.lhs().data() + first, e.rhs().data() + first, n, e.op());
+				else if constexpr (matrix_of<L, T> && scalar_of<R, T>)
+					simd::transform(dst, e.lhs().data() + first, static_cast<T>(e.rhs()), n, e.op());
+				else if constexpr (scalar_of<L, T> && matrix_of<R, T>)
+					simd::transform(dst, static_cast<T>(e.lhs()), e.rhs().data() + first, n, e.op());
+				else if constexpr (matrix_of<L, T> && broadcast_of<R, T>)
+					transform_broadcast<false>(dst, e.lhs().data(), e.rhs().operand(), e.dim().w, first, n, e.op());
+				else if constexpr (broadcast_of<L, T> && matrix_of<R, T>)
+					transform_broadcast<true>(dst, e.rhs().data(), e.lhs().operand(), e.dim().w, first, n, e.op());
+				else
+					return false;
+
+				return true;
+			}
+			else if constexpr (is_negate_expr<E>::value)
+			{
+				if constexpr (matrix_of<decltype(e.operand()), T>)
+				{
+					simd::transform(dst, T(0), e.operand().data() + first, n, simd::Sub{});
+					return true;
+				}
+				else
+					return false;
+			}
+			else if constexpr (is_matrix<E>::value)
+			{
+				simd::convert(dst, e.data() + first, n);
+				return true;
+			}
+			else
+				return false;
+		}
+
+		/**
+		 * @brief Operands that form a expression. At least one has to be a matrix expression, the other may be a
+		 * scalar.
+		 */
+		template<typename L, typename R>
+		concept expression_operands =
+			(matrix_expression<std::remove_cvref_t<L>> && matrix_expression<std::remove_cvref_t<R>>)
+			|| (matrix_expression<std::remove_cvref_t<L>> && arithmetic<R>)
+			|| (arithmetic<L> && matrix_expression<std::remove_cvref_t<R>>);
+	} // namespace detail
+
+	/**
+	 * @brief Materialize a expression into a matrix
+	 * @param e Expression
+	 * @return Matrix
+	 */
+	template<matrix_expression E>
+	constexpr auto eval(const E &e)
 	{
-		return m1 -= m2;
+		return Matrix<typename E::value_type, typename E::allocator_type>(e);
 	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator*(Matrix<Type, Allocator> &&m1, Matrix<Type, Allocator> &&m2) -> auto &&
+	/**
+	 * @brief Materialize a expression into a matrix according to the execution policy
+	 *
+	 * @param policy Execution policy
+	 * @param e Expression
+	 * @return Matrix
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto eval(const P &policy, const E &e)
 	{
-		return m1 *= m2;
+		Matrix<typename E::value_type, typename E::allocator_type> mat(
+			detail::allocator_of<typename E::allocator_type>(e));
+		mat.assign(policy, e);
+
+		return mat;
 	}
 
-	// --------------------------------- rv (const) -----------------------------------------
+	// --------------------------------- lv (expression) -----------------------------------------
 
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator+(const Matrix<T, Alloc> &mat, T x) noexcept
+	namespace detail
+	{
+		template<typename T>
+		struct is_scaled_matrix : std::false_type
+		{
+		};
+
+		template<typename S, typename M>
+		struct is_scaled_matrix<BinaryExpr<simd::Mul, S, M>>
+			: std::bool_constant<arithmetic<S> && is_matrix<std::remove_cvref_t<M>>::value>
+		{
+		};
+
+		template<typename Op, typename T, typename Alloc, matrix_expression E>
+		constexpr auto compound(Matrix<T, Alloc> &mat, const E &e, Op op) noexcept -> auto &
+		{
+			_ELEMENT_WISE_CHECK_(mat.dim(), e.dim());
+
+			if constexpr (broadcast_of<E, T>)
+			{
+				transform_broadcast<false>(mat.data(), mat.data(), e.operand(), mat.dim().w, 0, mat.size(), op);
+				return mat;
+			}
+
+			for (size_t r = 0; r < mat.dim().h; ++r)
+				for (size_t c = 0; c < mat.dim().w; ++c) mat(c, r) = static_cast<T>(op(mat(c, r), e(c, r)));
+
+			return mat;
+		}
+	} // namespace detail
+
+	template<typename T, typename Alloc, matrix_expression E>
+	constexpr auto operator+=(Matrix<T, Alloc> &mat, const E &e) noexcept -> auto &
 	{
-		return Matrix<T, Alloc>(mat) + x;
+		if constexpr (detail::is_scaled_matrix<E>::value)
+			if constexpr (std::same_as<typename std::remove_cvref_t<decltype(e.rhs())>::value_type, T>
+						  && detail::scalar_of<std::remove_cvref_t<decltype(e.lhs())>, T>)
+				return axpy(mat, static_cast<T>(e.lhs()), e.rhs());
+
+		return detail::compound(mat, e, simd::Add{});
 	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator-(const Matrix<T, Alloc> &mat, T x) noexcept
+	template<typename T, typename Alloc, matrix_expression E>
+	constexpr auto operator-=(Matrix<T, Alloc> &mat, const E &e) noexcept -> auto &
 	{
-		return Matrix<T, Alloc>(mat) - x;
+		if constexpr (detail::is_scaled_matrix<E>::value)
+			if constexpr (std::same_as<typename std::remove_cvref_t<decltype(e.rhs())>::value_type, T>
+						  && detail::scalar_of<std::remove_cvref_t<decltype(e.lhs())>, T>)
+				return axpy(mat, static_cast<T>(-e.lhs()), e.rhs());
+
+		return detail::compound(mat, e, simd::Sub{});
 	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator*(const Matrix<T, Alloc> &mat, T x) noexcept
+	template<typename T, typename Alloc, matrix_expression E>
+	constexpr auto operator*=(Matrix<T, Alloc> &mat, const E &e) noexcept -> auto &
 	{
-		return Matrix<T, Alloc>(mat) * x;
+		return detail::compound(mat, e, simd::Mul{});
 	}
-	template<arithmetic T, typename Alloc>
-	constexpr auto operator/(const Matrix<T, Alloc> &mat, T x) noexcept
+	template<typename T, typename Alloc, matrix_expression E>
+	constexpr auto operator/=(Matrix<T, Alloc> &mat, const E &e) noexcept -> auto &
 	{
-		return Matrix<T, Alloc>(mat) / x;
+		return detail::compound(mat, e, simd::Div{});
 	}
 
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator+(const Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept
+	// --------------------------------- lazy -----------------------------------------
+
+	template<typename E>
+	constexpr auto operator-(E &&e) noexcept requires matrix_expression<std::remove_cvref_t<E>>
 	{
-		return Matrix<T1, Alloc1>(mat1) + mat2;
+		return UnaryExpr<detail::Negate, E>(std::forward<E>(e), {});
 	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator-(const Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept
+
+	template<typename L, typename R>
+	constexpr auto operator+(L &&l, R &&r) noexcept requires detail::expression_operands<L, R>
 	{
-		return Matrix<T1, Alloc1>(mat1) - mat2;
+		return BinaryExpr<simd::Add, L, R>(std::forward<L>(l), std::forward<R>(r));
 	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator*(const Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept
+	template<typename L, typename R>
+	constexpr auto operator-(L &&l, R &&r) noexcept requires detail::expression_operands<L, R>
 	{
-		return Matrix<T1, Alloc1>(mat1) * mat2;
+		return BinaryExpr<simd::Sub, L, R>(std::forward<L>(l), std::forward<R>(r));
 	}
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator/(const Matrix<T1, Alloc1> &mat1, const Matrix<T2, Alloc2> &mat2) noexcept
+	template<typename L, typename R>
+	constexpr auto operator*(L &&l, R &&r) noexcept requires detail::expression_operands<L, R>
+	{
+		return BinaryExpr<simd::Mul, L, R>(std::forward<L>(l), std::forward<R>(r));
+	}
+	template<typename L, typename R>
+	constexpr auto operator/(L &&l, R &&r) noexcept requires detail::expression_operands<L, R>
+	{
+		return BinaryExpr<simd::Div, L, R>(std::forward<L>(l), std::forward<R>(r));
+	}
+
+	// -----------------------------------------------------------------------------
+	// Reductions
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Direction of a reduction. Axis::row reduces every row to a value giving a column vector, Axis::col every
+	 * column giving a row vector.
+	 */
+	enum class Axis
+	{
+		row,
+		col
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Contiguous data is reduced in chunks of this many elements. The chunks are the unit of parallelism and
+		 * their results are combined with Kahan summation.
+		 */
+		static constexpr size_t REDUCE_CHUNK = 1 << 14;
+
+		template<typename T>
+		using mean_t = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
+		/**
+		 * @brief Checks if the elements of e lie contiguous in row major order
+		 */
+		template<matrix_expression E>
+		constexpr auto is_contiguous(const E &e) noexcept -> bool
+		{
+			if constexpr (strided_matrix<E>)
+				return e.col_stride() == 1 && (e.row_stride() == e.dim().w || e.dim().h <= 1);
+			else
+				return false;
+		}
+
+		/**
+		 * @brief Get the elements [c0, c1) of row r. They are copied into buf if they don't lie contiguous.
+		 */
+		template<matrix_expression E>
+		constexpr auto row_span(const E &e, size_t r, size_t c0, size_t c1, std::vector<typename E::value_type> &buf)
+			-> const typename E::value_type *
+		{
+			if constexpr (strided_matrix<E>)
+				if (e.col_stride() == 1)
+					return e.data() + r * e.row_stride() + c0;
+
+			buf.resize(c1 - c0);
+			for (auto c = c0; c < c1; ++c) buf[c - c0] = e(c, r);
+
+			return buf.data();
+		}
+
+		/**
+		 * @brief Compensated summation of partial results
+		 */
+		template<typename T>
+		struct KahanSum
+		{
+			T c = 0;
+
+			constexpr auto operator()(T acc, T x) noexcept -> T
+			{
+				if constexpr (std::is_floating_point_v<T>)
+				{
+					const auto y = x - c, t = acc + y;
+					c = (t - acc) - y;
+					return t;
+				}
+				else
+					return acc + x;
+			}
+		};
+
+		/**
+		 * @brief Reduces a expression segment by segment. Contiguous expressions are split into chunks, others into
+		 * rows. Segments are reduced according to the policy and their results combined in order, so the result
+		 * doesn't depend on the policy.
+		 *
+		 * @param policy Execution policy
+		 * @param e Expression
+		 * @param init Initial value
+		 * @param f Segment reduction. Sig.: R f(const T *elements, size_t n, size_t first_flat_index);
+		 * @param combine Combination of the results. Sig.: R combine(R acc, R segment);
+		 * @return Result
+		 */
+		template<exe::execution_policy P, matrix_expression E, typename R, typename F, typename C>
+		auto reduce(const P &policy, const E &e, R init, F f, C combine) -> R
+		{
+			using T = typename E::value_type;
+
+			const auto w = e.dim().w, n = e.dim().area();
+			const auto flat = is_contiguous(e);
+			const auto len = flat ? REDUCE_CHUNK : w, segments = n == 0 ? 0 : (n + len - 1) / len;
+
+			const auto visit = [&](size_t s, std::vector<T> &buf) -> R {
+				if constexpr (strided_matrix<E>)
+					if (flat)
+						return f(e.data() + s * len, std::min(len, n - s * len), s * len);
+
+				return f(row_span(e, s, 0, w, buf), w, s * w);
+			};
+
+			std::vector<T> buf;
+			if (segments <= 1)
+				return segments == 0 ? init : combine(init, visit(0, buf));
+
+			std::vector<R> partial(segments);
+			exe::for_blocks(policy, segments, len, [&](size_t s0, size_t s1) {
+				std::vector<T> buf;
+				for (auto s = s0; s < s1; ++s) partial[s] = visit(s, buf);
+			});
+
+			for (const auto &p : partial) init = combine(init, p);
+
+			return init;
+		}
+
+		/**
+		 * @brief Reduces every row of a expression to a value
+		 *
+		 * @param policy Execution policy
+		 * @param e Expression
+		 * @param f Row reduction. Sig.: R f(const T *row, size_t n);
+		 * @return Column vector
+		 */
+		template<exe::execution_policy P, matrix_expression E, typename F>
+		auto reduce_rows(const P &policy, const E &e, F f)
+		{
+			using T = typename E::value_type;
+			using R = std::invoke_result_t<F &, const T *, size_t>;
+			using A = typename std::allocator_traits<typename E::allocator_type>::template rebind_alloc<R>;
+
+			Matrix<R, A> res(e.dim().h, 1, R(), allocator_of<A>(e));
+
+			exe::for_blocks(policy, e.dim().h, e.dim().w, [&](size_t r0, size_t r1) {
+				std::vector<T> buf;
+				for (auto r = r0; r < r1; ++r) res[r] = f(row_span(e, r, 0, e.dim().w, buf), e.dim().w);
+			});
+
+			return res;
+		}
+
+		/**
+		 * @brief Folds the rows [r0, r1) into acc with op. Floating point accumulations are split pairwise by rows.
+		 */
+		template<matrix_expression E, typename T, typename Op, typename C>
+		void fold_rows(const E &e, size_t r0, size_t r1, size_t c0, size_t c1, T *acc, T init, Op op, C combine,
+					   std::vector<T> &buf)
+		{
+			if (!std::is_floating_point_v<T> || r1 - r0 <= simd::detail::PAIRWISE_BLOCK / 16)
+			{
+				for (auto r = r0; r < r1; ++r) simd::transform(acc, acc, row_span(e, r, c0, c1, buf), c1 - c0, op);
+				return;
+			}
+
+			const auto mid = r0 + (r1 - r0) / 2;
+
+			std::vector<T> half(c1 - c0, init);
+			fold_rows(e, r0, mid, c0, c1, acc, init, op, combine, buf);
+			fold_rows(e, mid, r1, c0, c1, half.data(), init, op, combine, buf);
+
+			simd::transform(acc, acc, half.data(), c1 - c0, combine);
+		}
+
+		/**
+		 * @brief Folds every column of a expression with op. Columns are split up according to the policy.
+		 *
+		 * @param policy Execution policy
+		 * @param e Expression
+		 * @param init Initial value of the accumulators
+		 * @param op Accumulation. Sig.: T op(T acc, T x);
+		 * @param combine Combination of 2 accumulators. Sig.: T combine(T, T);
+		 * @return Row vector
+		 */
+		template<exe::execution_policy P, matrix_expression E, typename T, typename Op, typename C>
+		auto reduce_cols(const P &policy, const E &e, T init, Op op, C combine)
+		{
+			using A = typename std::allocator_traits<typename E::allocator_type>::template rebind_alloc<T>;
+
+			Matrix<T, A> res(1, e.dim().w, init, allocator_of<A>(e));
+
+			exe::for_blocks(policy, e.dim().w, e.dim().h, [&](size_t c0, size_t c1) {
+				std::vector<T> buf;
+				fold_rows(e, 0, e.dim().h, c0, c1, res.data() + c0, init, op, combine, buf);
+			});
+
+			return res;
+		}
+
+		/**
+		 * @brief Finds the first extreme element of each row or column
+		 *
+		 * @tparam Op simd::Max or simd::Min
+		 */
+		template<typename Op, exe::execution_policy P, matrix_expression E>
+		auto arg_extreme(const P &policy, const E &e, Axis axis)
+		{
+			using T = typename E::value_type;
+			using A = typename std::allocator_traits<typename E::allocator_type>::template rebind_alloc<size_t>;
+
+			if (axis == Axis::row)
+				return reduce_rows(policy, e, [](const T *p, size_t n) {
+					return n == 0 ? size_t(0) : size_t(std::find(p, p + n, simd::reduce(p, n, p[0], Op{}, Op{})) - p);
+				});
+
+			Matrix<size_t, A> res(1, e.dim().w, size_t(0), allocator_of<A>(e));
+
+			exe::for_blocks(policy, e.dim().w, e.dim().h, [&](size_t c0, size_t c1) {
+				std::vector<T> buf, best(row_span(e, 0, c0, c1, buf), row_span(e, 0, c0, c1, buf) + (c1 - c0));
+
+				for (size_t r = 1; r < e.dim().h; ++r)
+				{
+					const auto *p = row_span(e, r, c0, c1, buf);
+					for (auto c = c0; c < c1; ++c)
+						if (Op{}(best[c - c0], p[c - c0]) != best[c - c0])
+							best[c - c0] = p[c - c0], res[c] = r;
+				}
+			});
+
+			return res;
+		}
+
+		/**
+		 * @brief Finds the first extreme element of the whole expression
+		 *
+		 * @tparam Op simd::Max or simd::Min
+		 */
+		template<typename Op, exe::execution_policy P, matrix_expression E>
+		auto arg_extreme(const P &policy, const E &e) -> size_t
+		{
+			using T = typename E::value_type;
+
+			assert(e.dim().area() != 0 && "Matrix must not be empty.");
+
+			return reduce(
+					   policy, e, std::pair<T, size_t>(e(0, 0), 0),
+					   [](const T *p, size_t n, size_t first) {
+						   const auto x = simd::reduce(p, n, p[0], Op{}, Op{});
+						   return std::pair<T, size_t>(x, first + (std::find(p, p + n, x) - p));
+					   },
+					   [](const auto &acc, const auto &x) { return Op{}(acc.first, x.first) != acc.first ? x : acc; })
+				.second;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Sum all elements. Floating point sums are computed pairwise inside of chunks, which are added up with
+	 * Kahan summation.
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @return Sum
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto sum(const P &policy, const E &e)
+	{
+		using T = typename E::value_type;
+		return detail::reduce(
+			policy, e, T(0), [](const T *p, size_t n, size_t) { return simd::sum(p, n); }, detail::KahanSum<T>());
+	}
+	/**
+	 * @brief Sum every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the sum of each row, Axis::col for the sum of each column
+	 * @return Column or row vector
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto sum(const P &policy, const E &e, Axis axis)
+	{
+		using T = typename E::value_type;
+
+		if (axis == Axis::row)
+			return detail::reduce_rows(policy, e, [](const T *p, size_t n) { return simd::sum(p, n); });
+		else
+			return detail::reduce_cols(policy, e, T(0), simd::Add{}, simd::Add{});
+	}
+
+	/**
+	 * @brief Average of all elements
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @return Mean. Double for integral matrices.
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto mean(const P &policy, const E &e)
+	{
+		using M = detail::mean_t<typename E::value_type>;
+		return static_cast<M>(sum(policy, e)) / static_cast<M>(e.dim().area());
+	}
+	/**
+	 * @brief Average of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the mean of each row, Axis::col for the mean of each column
+	 * @return Column or row vector. Double for integral matrices.
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto mean(const P &policy, const E &e, Axis axis)
+	{
+		using M = detail::mean_t<typename E::value_type>;
+		using A = typename std::allocator_traits<typename E::allocator_type>::template rebind_alloc<M>;
+
+		const auto s = sum(policy, e, axis);
+		const auto n = static_cast<M>(axis == Axis::row ? e.dim().w : e.dim().h);
+
+		Matrix<M, A> res(s.dim().h, s.dim().w, M(), detail::allocator_of<A>(e));
+		for (size_t i = 0; i < res.size(); ++i) res[i] = s[i] / n;
+
+		return res;
+	}
+
+	/**
+	 * @brief Smallest element
+	 *
+	 * @param policy Execution policy
+	 * @param e Non empty matrix or expression
+	 * @return Minimum
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto min(const P &policy, const E &e)
+	{
+		using T = typename E::value_type;
+
+		assert(e.dim().area() != 0 && "Matrix must not be empty.");
+		return detail::reduce(
+			policy, e, e(0, 0), [](const T *p, size_t n, size_t) { return simd::min(p, n); }, simd::Min{});
+	}
+	/**
+	 * @brief Smallest element of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the minimum of each row, Axis::col for the minimum of each column
+	 * @return Column or row vector
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto min(const P &policy, const E &e, Axis axis)
+	{
+		using T = typename E::value_type;
+
+		if (axis == Axis::row)
+			return detail::reduce_rows(policy, e, [](const T *p, size_t n) { return simd::min(p, n); });
+		else
+			return detail::reduce_cols(policy, e, std::numeric_limits<T>::max(), simd::Min{}, simd::Min{});
+	}
+
+	/**
+	 * @brief Largest element
+	 *
+	 * @param policy Execution policy
+	 * @param e Non empty matrix or expression
+	 * @return Maximum
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto max(const P &policy, const E &e)
+	{
+		using T = typename E::value_type;
+
+		assert(e.dim().area() != 0 && "Matrix must not be empty.");
+		return detail::reduce(
+			policy, e, e(0, 0), [](const T *p, size_t n, size_t) { return simd::max(p, n); }, simd::Max{});
+	}
+	/**
+	 * @brief Largest element of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the maximum of each row, Axis::col for the maximum of each column
+	 * @return Column or row vector
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto max(const P &policy, const E &e, Axis axis)
+	{
+		using T = typename E::value_type;
+
+		if (axis == Axis::row)
+			return detail::reduce_rows(policy, e, [](const T *p, size_t n) { return simd::max(p, n); });
+		else
+			return detail::reduce_cols(policy, e, std::numeric_limits<T>::lowest(), simd::Max{}, simd::Max{});
+	}
+
+	/**
+	 * @brief Position of the first smallest element
+	 *
+	 * @param policy Execution policy
+	 * @param e Non empty matrix or expression
+	 * @return Row major index
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto argmin(const P &policy, const E &e) -> size_t
+	{
+		return detail::arg_extreme<simd::Min>(policy, e);
+	}
+	/**
+	 * @brief Position of the first smallest element of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the column of each row's minimum, Axis::col for the row of each column's minimum
+	 * @return Column or row vector of indices
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto argmin(const P &policy, const E &e, Axis axis)
+	{
+		return detail::arg_extreme<simd::Min>(policy, e, axis);
+	}
+
+	/**
+	 * @brief Position of the first largest element
+	 *
+	 * @param policy Execution policy
+	 * @param e Non empty matrix or expression
+	 * @return Row major index
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto argmax(const P &policy, const E &e) -> size_t
+	{
+		return detail::arg_extreme<simd::Max>(policy, e);
+	}
+	/**
+	 * @brief Position of the first largest element of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the column of each row's maximum, Axis::col for the row of each column's maximum
+	 * @return Column or row vector of indices
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto argmax(const P &policy, const E &e, Axis axis)
+	{
+		return detail::arg_extreme<simd::Max>(policy, e, axis);
+	}
+
+	/**
+	 * @brief Sum of the absolute values of all elements
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @return L1 norm
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto norm_l1(const P &policy, const E &e)
+	{
+		using T = typename E::value_type;
+		return detail::reduce(
+			policy, e, T(0), [](const T *p, size_t n, size_t) { return simd::sum_abs(p, n); }, detail::KahanSum<T>());
+	}
+	/**
+	 * @brief Sum of the absolute values of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the norm of each row, Axis::col for the norm of each column
+	 * @return Column or row vector
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto norm_l1(const P &policy, const E &e, Axis axis)
+	{
+		using T = typename E::value_type;
+
+		if (axis == Axis::row)
+			return detail::reduce_rows(policy, e, [](const T *p, size_t n) { return simd::sum_abs(p, n); });
+		else
+			return detail::reduce_cols(policy, e, T(0), simd::AddAbs{}, simd::Add{});
+	}
+
+	/**
+	 * @brief Euclidean (Frobenius) norm of all elements
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @return L2 norm. Double for integral matrices.
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto norm_l2(const P &policy, const E &e)
+	{
+		using T = typename E::value_type;
+		return std::sqrt(static_cast<detail::mean_t<T>>(detail::reduce(
+			policy, e, T(0), [](const T *p, size_t n, size_t) { return simd::sum_squares(p, n); },
+			detail::KahanSum<T>())));
+	}
+	/**
+	 * @brief Euclidean norm of every row or column
+	 *
+	 * @param policy Execution policy
+	 * @param e Matrix or expression
+	 * @param axis Axis::row for the norm of each row, Axis::col for the norm of each column
+	 * @return Column or row vector. Double for integral matrices.
+	 */
+	template<exe::execution_policy P, matrix_expression E>
+	auto norm_l2(const P &policy, const E &e, Axis axis)
 	{
-		return Matrix<T1, Alloc1>(mat1) / mat2;
+		using T = typename E::value_type;
+		using M = detail::mean_t<T>;
+		using A = typename std::allocator_traits<typename E::allocator_type>::template rebind_alloc<M>;
+
+		const auto s = axis == Axis::row
+			? detail::reduce_rows(policy, e, [](const T *p, size_t n) { return simd::sum_squares(p, n); })
+			: detail::reduce_cols(policy, e, T(0), simd::AddSquare{}, simd::Add{});
+
+		Matrix<M, A> res(s.dim().h, s.dim().w, M(), detail::allocator_of<A>(e));
+		for (size_t i = 0; i < res.size(); ++i) res[i] = std::sqrt(static_cast<M>(s[i]));
+
+		return res;
 	}
 
-	// forwarding
+	/**
+	 * @brief Sum of the elementwise product of 2 matrices or expressions of the same dimensions
+	 *
+	 * @param policy Execution policy
+	 * @param a Left operand
+	 * @param b Right operand
+	 * @return Dot product
+	 */
+	template<exe::execution_policy P, matrix_expression E1, matrix_expression E2>
+	auto dot(const P &policy, const E1 &a, const E2 &b)
+	{
+		using T = typename E1::value_type;
+
+		_ELEMENT_WISE_CHECK_(a.dim(), b.dim());
+
+		if constexpr (strided_matrix<E2> && std::same_as<T, typename E2::value_type>)
+			if (detail::is_contiguous(b))
+				return detail::reduce(
+					policy, a, T(0),
+					[&](const T *p, size_t n, size_t first) { return simd::dot(p, b.data() + first, n); },
+					detail::KahanSum<T>());
+
+		return sum(policy, a * b);
+	}
 
-	template<typename Type, typename Allocator>
-	constexpr auto operator+(Type x, const Matrix<Type, Allocator> &m) noexcept
+	template<matrix_expression E>
+	auto sum(const E &e)
+	{
+		return sum(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto sum(const E &e, Axis axis)
+	{
+		return sum(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto mean(const E &e)
+	{
+		return mean(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto mean(const E &e, Axis axis)
+	{
+		return mean(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto min(const E &e)
+	{
+		return min(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto min(const E &e, Axis axis)
+	{
+		return min(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto max(const E &e)
 	{
-		return m + x;
+		return max(exe::seq, e);
 	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator-(Type x, const Matrix<Type, Allocator> &m) noexcept
+	template<matrix_expression E>
+	auto max(const E &e, Axis axis)
 	{
-		return -m + x;
+		return max(exe::seq, e, axis);
 	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator*(Type x, const Matrix<Type, Allocator> &m) noexcept
+	template<matrix_expression E>
+	auto argmin(const E &e) -> size_t
 	{
-		return m * x;
+		return argmin(exe::seq, e);
 	}
-	template<typename Type, typename Allocator>
-	constexpr auto operator/(Type x, Matrix<Type, Allocator> m) noexcept
+	template<matrix_expression E>
+	auto argmin(const E &e, Axis axis)
 	{
-		return m.apply([x](Type y) constexpr { return x / y; });
+		return argmin(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto argmax(const E &e) -> size_t
+	{
+		return argmax(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto argmax(const E &e, Axis axis)
+	{
+		return argmax(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto norm_l1(const E &e)
+	{
+		return norm_l1(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto norm_l1(const E &e, Axis axis)
+	{
+		return norm_l1(exe::seq, e, axis);
+	}
+	template<matrix_expression E>
+	auto norm_l2(const E &e)
+	{
+		return norm_l2(exe::seq, e);
+	}
+	template<matrix_expression E>
+	auto norm_l2(const E &e, Axis axis)
+	{
+		return norm_l2(exe::seq, e, axis);
+	}
+	template<matrix_expression E1, matrix_expression E2>
+	auto dot(const E1 &a, const E2 &b)
+	{
+		return dot(exe::seq, a, b);
 	}
 
 	// -----------------------------------------------------------------------------
 	// Boolean Overloads
 	// -----------------------------------------------------------------------------
 
-	template<typename T1, typename Alloc1, typename T2, typename Alloc2>
-	constexpr auto operator==(const Matrix<T1, Alloc1> &m1, const Matrix<T2, Alloc2> &m2) -> bool
+	template<matrix_expression E1, matrix_expression E2>
+	constexpr auto operator==(const E1 &m1, const E2 &m2) -> bool
 	{
 		_ELEMENT_WISE_CHECK_(m1.dim(), m2.dim());
-		for (auto [i1, i2] = { m1.begin(), m2.begin() }; i1 != m1.end(); ++i1, ++i2)
-			if (*i1 != *i2)
-				return false;
+		for (size_t r = 0; r < m1.dim().h; ++r)
+			for (size_t c = 0; c < m1.dim().w; ++c)
+				if (m1(c, r) != m2(c, r))
+					return false;
 		return true;
 	}
 
@@ -0,0 +1,514 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#if defined(_WIN32)
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#include "Matrix.h"
+
+namespace ctl::mth
+{
+	// -----------------------------------------------------------------------------
+	// Binary Format
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Element type stored in a binary matrix file
+	 */
+	enum class DType : std::uint8_t
+	{
+		i8,
+		u8,
+		i16,
+		u16,
+		i32,
+		u32,
+		i64,
+		u64,
+		f32,
+		f64
+	};
+
+	/**
+	 * @brief DType of a element type
+	 * @tparam T Arithmetic type
+	 */
+	template<arithmetic T>
+	constexpr DType dtype_of = [] {
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			static_assert(sizeof(T) == 4 || sizeof(T) == 8, "Only 32 and 64 bit floating points can be stored.");
+			return sizeof(T) == 4 ? DType::f32 : DType::f64;
+		}
+		else
+		{
+			constexpr auto s = std::is_signed_v<T>;
+			switch (sizeof(T))
+			{
+			case 1: return s ? DType::i8 : DType::u8;
+			case 2: return s ? DType::i16 : DType::u16;
+			case 4: return s ? DType::i32 : DType::u32;
+			default: return s ? DType::i64 : DType::u64;
+			}
+		}
+	}();
+
+	/**
+	 * @brief Header in front of every matrix in a binary file. Fields are stored in the byte order given by endian.
+	 * The elements follow in row major order at data_offset from the start of the header, which is aligned to
+	 * alignment from the start of the stream so the data can be mapped and used in place.
+	 */
+	struct FileHeader
+	{
+		static constexpr std::array<char, 4> MAGIC	 = { 'C', 'T', 'L', 'M' };
+		static constexpr std::uint16_t		 VERSION = 1;
+
+		static constexpr std::uint8_t LITTLE = 0;
+		static constexpr std::uint8_t BIG	 = 1;
+
+		std::array<char, 4> magic		= MAGIC;
+		std::uint16_t		version		= VERSION;
+		DType				dtype		= DType::f64;
+		std::uint8_t		endian		= std::endian::native == std::endian::big ? BIG : LITTLE;
+		std::uint32_t		alignment	= 64;
+		std::uint32_t		header_size = sizeof(FileHeader);
+		std::uint64_t		rows		= 0;
+		std::uint64_t		cols		= 0;
+		std::uint64_t		data_offset = sizeof(FileHeader);
+		std::uint64_t		data_size	= 0;
+		std::array<char, 16> reserved	= {};
+
+		/**
+		 * @brief Checks if the file was written with the byte order of this machine
+		 * @return bool
+		 */
+		[[nodiscard]] auto is_native() const noexcept -> bool
+		{
+			return endian == (std::endian::native == std::endian::big ? BIG : LITTLE);
+		}
+	};
+
+	static_assert(sizeof(FileHeader) == 64 && std::is_trivially_copyable_v<FileHeader>);
+
+	namespace detail
+	{
+		template<typename T>
+		constexpr auto byteswap(T v) noexcept -> T
+		{
+			auto b = std::bit_cast<std::array<std::byte, sizeof(T)>>(v);
+			for (size_t i = 0; i < sizeof(T) / 2; ++i) std::swap(b[i], b[sizeof(T) - 1 - i]);
+
+			return std::bit_cast<T>(b);
+		}
+
+		inline void byteswap(FileHeader &h) noexcept
+		{
+			h.version	  = byteswap(h.version);
+			h.alignment	  = byteswap(h.alignment);
+			h.header_size = byteswap(h.header_size);
+			h.rows		  = byteswap(h.rows);
+			h.cols		  = byteswap(h.cols);
+			h.data_offset = byteswap(h.data_offset);
+			h.data_size	  = byteswap(h.data_size);
+		}
+
+		inline constexpr auto dtype_size(DType t) noexcept -> size_t
+		{
+			switch (t)
+			{
+			case DType::i8:
+			case DType::u8: return 1;
+			case DType::i16:
+			case DType::u16: return 2;
+			case DType::i32:
+			case DType::u32:
+			case DType::f32: return 4;
+			default: return 8;
+			}
+		}
+
+		/**
+		 * @brief Multiply 2 sizes read from a file
+		 * @return a * b
+		 * @throws std::runtime_error if the product overflows
+		 */
+		inline auto checked_mul(std::uint64_t a, std::uint64_t b) -> std::uint64_t
+		{
+			if (b != 0 && a > std::numeric_limits<std::uint64_t>::max() / b)
+				throw std::runtime_error("Size in binary file overflows.");
+			return a * b;
+		}
+
+		/**
+		 * @brief Add 2 sizes or offsets read from a file
+		 * @return a + b
+		 * @throws std::runtime_error if the sum overflows
+		 */
+		inline auto checked_add(std::uint64_t a, std::uint64_t b) -> std::uint64_t
+		{
+			if (a > std::numeric_limits<std::uint64_t>::max() - b)
+				throw std::runtime_error("Size in binary file overflows.");
+			return a + b;
+		}
+
+		/**
+		 * @brief Get the bytes left in a stream. Limits allocations sized by a untrusted header.
+		 * @return Bytes till the end or the largest size if the stream can't seek
+		 */
+		inline auto remaining(std::istream &in) -> std::uint64_t
+		{
+			const auto pos = in.tellg();
+			if (pos < 0 || !in.seekg(0, std::ios::end))
+			{
+				in.clear();
+				return std::numeric_limits<std::uint64_t>::max();
+			}
+
+			const auto end = in.tellg();
+			in.seekg(pos);
+
+			return end > pos ? static_cast<std::uint64_t>(end - pos) : 0;
+		}
+
+		/**
+		 * @brief Calls f with a value of the element type of a DType
+		 */
+		template<typename F>
+		auto visit_dtype(DType t, F &&f)
+		{
+			switch (t)
+			{
+			case DType::i8: return f(std::int8_t());
+			case DType::u8: return f(std::uint8_t());
+			case DType::i16: return f(std::int16_t());
+			case DType::u16: return f(std::uint16_t());
+			case DType::i32: return f(std::int32_t());
+			case DType::u32: return f(std::uint32_t());
+			case DType::i64: return f(std::int64_t());
+			case DType::u64: return f(std::uint64_t());
+			case DType::f32: return f(float());
+			default: return f(double());
+			}
+		}
+
+		/**
+		 * @brief Checks and converts a header to the byte order of this machine
+		 */
+		inline void validate(FileHeader &h)
+		{
+			if (h.magic != FileHeader::MAGIC)
+				throw std::runtime_error("Not a binary matrix file.");
+
+			if (!h.is_native())
+				byteswap(h);
+
+			if (h.version > FileHeader::VERSION)
+				throw std::runtime_error("Binary matrix file version is newer than supported.");
+			if (h.dtype > DType::f64)
+				throw std::runtime_error("Unknown element type in binary matrix file.");
+			if (h.header_size < sizeof(FileHeader) || h.data_offset < h.header_size
+				|| h.data_size != checked_mul(checked_mul(h.rows, h.cols), dtype_size(h.dtype)))
+				throw std::runtime_error("Corrupt binary matrix file header.");
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Write a matrix or expression in the binary format. Contiguous matrices are written in one bulk write.
+	 * Multiple matrices can be written one after another into the same stream.
+	 *
+	 * @param o Binary output stream
+	 * @param e Matrix or expression
+	 * @param alignment Alignment of the data from the start of the stream. Power of 2.
+	 * @return o
+	 */
+	template<matrix_expression E>
+	auto write(std::ostream &o, const E &e, size_t alignment = 64) -> std::ostream &
+	{
+		using T = typename E::value_type;
+
+		assert(std::has_single_bit(alignment) && "Alignment must be a power of 2.");
+
+		const auto tell = static_cast<std::streamoff>(o.tellp());
+		const auto pos	= static_cast<size_t>(std::max<std::streamoff>(tell, 0));
+
+		FileHeader h;
+		h.dtype		  = dtype_of<T>;
+		h.alignment	  = static_cast<std::uint32_t>(alignment);
+		h.rows		  = e.dim().h;
+		h.cols		  = e.dim().w;
+		h.data_offset = (pos + sizeof(FileHeader) + alignment - 1) / alignment * alignment - pos;
+		h.data_size	  = e.dim().area() * sizeof(T);
+
+		o.write(reinterpret_cast<const char *>(&h), sizeof(h));
+
+		static constexpr std::array<char, 4096> zeros = {};
+		for (auto pad = h.data_offset - sizeof(FileHeader); pad > 0;)
+		{
+			const auto n = std::min<size_t>(pad, zeros.size());
+			o.write(zeros.data(), n), pad -= n;
+		}
+
+		if (detail::is_contiguous(e))
+		{
+			if constexpr (strided_matrix<E>)
+				o.write(reinterpret_cast<const char *>(e.data()), h.data_size);
+		}
+		else
+		{
+			std::vector<T> buf;
+			for (size_t r = 0; r < e.dim().h; ++r)
+			{
+				const auto *row = detail::row_span(e, r, 0, e.dim().w, buf);
+				o.write(reinterpret_cast<const char *>(row), e.dim().w * sizeof(T));
+			}
+		}
+
+		return o;
+	}
+
+	/**
+	 * @brief Read the next matrix of a binary stream. Data of the same type and byte order is read in one bulk read,
+	 * other types are converted.
+	 *
+	 * @param in Binary input stream
+	 * @param alloc Allocator of the matrix
+	 * @return Matrix
+	 */
+	template<arithmetic T, typename Allocator = std::allocator<T>>
+	auto read(std::istream &in, const Allocator &alloc = Allocator()) -> Matrix<T, Allocator>
+	{
+		FileHeader h;
+		if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)))
+			throw std::runtime_error("Couldn't read binary matrix header.");
+
+		detail::validate(h);
+		if (detail::checked_add(h.data_offset - sizeof(FileHeader), h.data_size) > detail::remaining(in))
+			throw std::runtime_error("Binary matrix data is truncated.");
+		in.ignore(h.data_offset - sizeof(FileHeader));
+
+		Matrix<T, Allocator> mat(h.rows, h.cols, T(), alloc);
+
+		if (h.dtype == dtype_of<T> && h.is_native())
+			in.read(reinterpret_cast<char *>(mat.data()), h.data_size);
+		else
+		{
+			std::vector<char> buf(h.data_size);
+			in.read(buf.data(), h.data_size);
+
+			detail::visit_dtype(h.dtype, [&]<typename S>(S) {
+				for (size_t i = 0; i < mat.size(); ++i)
+				{
+					S v;
+					std::memcpy(&v, buf.data() + i * sizeof(S), sizeof(S));
+					mat[i] = static_cast<T>(h.is_native() ? v : detail::byteswap(v));
+				}
+			});
+		}
+
+		if (!in)
+			throw std::runtime_error("Binary matrix data is truncated.");
+
+		return mat;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Memory Mapping
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Read only memory mapping of a whole file
+	 */
+	class MappedFile
+	{
+	public:
+		/**
+		 * @brief Map a file
+		 * @param path File to map
+		 */
+		explicit MappedFile(const std::filesystem::path &path)
+		{
+#if defined(_WIN32)
+			const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+										  FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				throw std::runtime_error("Couldn't open file for mapping.");
+
+			LARGE_INTEGER size;
+			GetFileSizeEx(file, &size);
+			m_size = static_cast<size_t>(size.QuadPart);
+
+			if (m_size != 0)
+			{
+				const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping != nullptr)
+				{
+					m_data = static_cast<const std::byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+					CloseHandle(mapping);
+				}
+			}
+			CloseHandle(file);
+#else
+			const auto fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0)
+				throw std::runtime_error("Couldn't open file for mapping.");
+
+			struct stat st;
+			::fstat(fd, &st);
+			m_size = static_cast<size_t>(st.st_size);
+
+			if (m_size != 0)
+				if (auto *p = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0); p != MAP_FAILED)
+					m_data = static_cast<const std::byte *>(p);
+			::close(fd);
+#endif
+			if (m_data == nullptr && m_size != 0)
+				throw std::runtime_error("Couldn't map file.");
+		}
+
+		MappedFile(const MappedFile &) = delete;
+		auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+		~MappedFile()
+		{
+			if (m_data == nullptr)
+				return;
+#if defined(_WIN32)
+			UnmapViewOfFile(m_data);
+#else
+			::munmap(const_cast<std::byte *>(m_data), m_size);
+#endif
+		}
+
+		/**
+		 * @brief Get the mapped bytes
+		 * @return ptr to data
+		 */
+		[[nodiscard]] auto data() const noexcept -> const std::byte * { return m_data; }
+		/**
+		 * @brief Get the size of the file
+		 * @return size
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_size; }
+
+	private:
+		const std::byte *m_data = nullptr;
+		size_t			 m_size = 0;
+	};
+
+	/**
+	 * @brief Read only matrix whose elements lie in a mapped binary file. Nothing is parsed or copied, pages are loaded
+	 * by the OS on first access. The mapping lives as long as any matrix of it.
+	 *
+	 * @tparam Type Element type. Must match the stored type.
+	 */
+	template<arithmetic Type>
+	class MappedMatrix
+	{
+	public:
+		using value_type	 = Type;
+		using allocator_type = std::allocator<Type>;
+
+		/**
+		 * @brief Use a matrix of a mapped file
+		 *
+		 * @param file Mapping
+		 * @param offset Offset of the matrix header in the file
+		 */
+		MappedMatrix(std::shared_ptr<const MappedFile> file, size_t offset)
+			: m_file(std::move(file))
+		{
+			FileHeader h;
+			if (offset + sizeof(h) > m_file->size())
+				throw std::runtime_error("Binary matrix header is out of the file.");
+			std::memcpy(&h, m_file->data() + offset, sizeof(h));
+
+			detail::validate(h);
+			if (h.dtype != dtype_of<Type> || !h.is_native())
+				throw std::runtime_error("Mapped matrix type or byte order doesn't match the file.");
+			if (detail::checked_add(detail::checked_add(offset, h.data_offset), h.data_size) > m_file->size())
+				throw std::runtime_error("Binary matrix data is truncated.");
+
+			const auto *p = m_file->data() + offset + h.data_offset;
+			if (reinterpret_cast<std::uintptr_t>(p) % alignof(Type) != 0)
+				throw std::runtime_error("Mapped matrix data is misaligned.");
+
+			m_view = MatrixView<const Type>(reinterpret_cast<const Type *>(p), h.rows, h.cols);
+			m_end  = offset + h.data_offset + h.data_size;
+		}
+
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> Type { return m_view(c, r); }
+
+		[[nodiscard]] constexpr auto dim() const noexcept -> const Dim<size_t> & { return m_view.dim(); }
+		[[nodiscard]] constexpr auto size() const noexcept -> size_t { return m_view.size(); }
+		[[nodiscard]] constexpr auto data() const noexcept -> const Type * { return m_view.data(); }
+		[[nodiscard]] constexpr auto row_stride() const noexcept -> size_t { return m_view.row_stride(); }
+		[[nodiscard]] constexpr auto col_stride() const noexcept -> size_t { return m_view.col_stride(); }
+
+		/**
+		 * @brief Get a view of the mapped elements. It is only valid as long as a MappedMatrix of the file exists.
+		 * @return View
+		 */
+		[[nodiscard]] constexpr auto view() const noexcept -> MatrixView<const Type> { return m_view; }
+
+		/**
+		 * @brief Get the offset of the byte after the data of this matrix in the file
+		 * @return offset
+		 */
+		[[nodiscard]] auto end_offset() const noexcept -> size_t { return m_end; }
+
+	private:
+		std::shared_ptr<const MappedFile> m_file;
+		MatrixView<const Type>			  m_view;
+		size_t							  m_end = 0;
+	};
+
+	/**
+	 * @brief Map the first matrix of a binary file
+	 *
+	 * @param path File written with write
+	 * @return Mapped matrix
+	 */
+	template<arithmetic T>
+	auto map_matrix(const std::filesystem::path &path) -> MappedMatrix<T>
+	{
+		return MappedMatrix<T>(std::make_shared<const MappedFile>(path), 0);
+	}
+
+	/**
+	 * @brief Map all matrices of a binary file. They share one mapping.
+	 *
+	 * @param path File written with consecutive writes
+	 * @return Mapped matrices in file order
+	 */
+	template<arithmetic T>
+	auto map_matrices(const std::filesystem::path &path) -> std::vector<MappedMatrix<T>>
+	{
+		const auto file = std::make_shared<const MappedFile>(path);
+
+		std::vector<MappedMatrix<T>> res;
+		for (size_t off = 0; off < file->size(); off = res.back().end_offset()) res.emplace_back(file, off);
+
+		return res;
+	}
+
+} // namespace ctl::mth
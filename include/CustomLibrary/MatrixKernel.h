@@ -0,0 +1,539 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "Simd.h"
+
+namespace ctl::mth::kernel
+{
+	// -----------------------------------------------------------------------------
+	// GEMM Blocking Parameters
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Blocking sizes of the packed GEMM path
+	 * MR x NR is the register tile of the microkernel, KC x NR panels of B live in L1, MC x KC blocks of A in L2 and
+	 * KC x NC panels of B in L3.
+	 * @tparam T Accumulation type
+	 */
+	template<typename T>
+	struct GemmBlocking
+	{
+		static constexpr size_t MR = 4;
+		static constexpr size_t NR = sizeof(T) >= 8 ? 8 : 16;
+		static constexpr size_t KC = 256;
+		static constexpr size_t MC = 128;
+		static constexpr size_t NC = 4096;
+	};
+
+	/**
+	 * @brief Amount of multiply-adds from which on the blocked GEMM path pays off over the naive loop
+	 */
+	static constexpr size_t GEMM_BLOCKED_THRESHOLD = 48 * 48 * 48;
+
+	/**
+	 * @brief Checks if a product of the given shape should use the blocked GEMM path
+	 *
+	 * @param m Rows of A and C
+	 * @param n Columns of B and C
+	 * @param k Columns of A and rows of B
+	 * @return bool
+	 */
+	constexpr auto use_blocked_gemm(size_t m, size_t n, size_t k) noexcept -> bool
+	{
+		return m * n * k >= GEMM_BLOCKED_THRESHOLD && m >= 4 && n >= 4;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Naive GEMM
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Textbook triple loop computing C += alpha * A * B. Used for tiny and constexpr products. C must not
+	 * overlap A or B.
+	 *
+	 * @param m Rows of A and C
+	 * @param n Columns of B and C
+	 * @param k Columns of A and rows of B
+	 * @param a A data
+	 * @param rsa A row stride
+	 * @param csa A column stride
+	 * @param b B data
+	 * @param rsb B row stride
+	 * @param csb B column stride
+	 * @param c C data (contiguous rows)
+	 * @param rsc C row stride
+	 * @param alpha Scale of the product
+	 */
+	template<typename TA, typename TB, typename TC>
+	constexpr void gemm_naive(size_t m, size_t n, size_t k, const TA *a, size_t rsa, size_t csa, const TB *b,
+							  size_t rsb, size_t csb, TC *__restrict c, size_t rsc, TC alpha = TC(1)) noexcept
+	{
+		for (size_t y1 = 0; y1 < m; ++y1)
+			for (size_t x2 = 0; x2 < n; ++x2)
+			{
+				TC sum = 0;
+				for (size_t x1 = 0; x1 < k; ++x1) sum += a[y1 * rsa + x1 * csa] * b[x1 * rsb + x2 * csb];
+
+				c[y1 * rsc + x2] += alpha * sum;
+			}
+	}
+
+	/**
+	 * @brief Matrix vector product c += alpha * A * b with contiguous rows of A. Each element is a SIMD dot product,
+	 * b is gathered first if it is strided.
+	 *
+	 * @param m Rows of A and c
+	 * @param k Columns of A and rows of b
+	 * @param a A data
+	 * @param rsa A row stride
+	 * @param b b data
+	 * @param rsb b stride
+	 * @param c c data
+	 * @param rsc c stride
+	 * @param alpha Scale of the product
+	 */
+	template<typename T>
+	void gemv(size_t m, size_t k, const T *a, size_t rsa, const T *b, size_t rsb, T *c, size_t rsc,
+			  T alpha = T(1)) noexcept
+	{
+		std::vector<T> gathered;
+		if (rsb != 1)
+		{
+			gathered.resize(k);
+			for (size_t p = 0; p < k; ++p) gathered[p] = b[p * rsb];
+			b = gathered.data();
+		}
+
+		for (size_t i = 0; i < m; ++i) c[i * rsc] += alpha * simd::dot(a + i * rsa, b, k);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Blocked GEMM
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Packs a mc x kc block of A scaled by alpha into MR row micro-panels stored column by column. Tails are
+		 * zero padded.
+		 */
+		template<size_t MR, typename TA, typename TC>
+		void pack_a(size_t mc, size_t kc, const TA *a, size_t rsa, size_t csa, TC *dst, TC alpha) noexcept
+		{
+			for (size_t ir = 0; ir < mc; ir += MR)
+			{
+				const auto mr = std::min(MR, mc - ir);
+
+				for (size_t p = 0; p < kc; ++p)
+				{
+					size_t i = 0;
+					for (; i < mr; ++i) *(dst++) = alpha * static_cast<TC>(a[(ir + i) * rsa + p * csa]);
+					for (; i < MR; ++i) *(dst++) = TC(0);
+				}
+			}
+		}
+
+		/**
+		 * @brief Packs a kc x nc panel of B into NR column micro-panels stored row by row. Tails are zero padded.
+		 */
+		template<size_t NR, typename TB, typename TC>
+		void pack_b(size_t kc, size_t nc, const TB *b, size_t rsb, size_t csb, TC *dst) noexcept
+		{
+			for (size_t jr = 0; jr < nc; jr += NR)
+			{
+				const auto nr = std::min(NR, nc - jr);
+
+				for (size_t p = 0; p < kc; ++p)
+				{
+					size_t j = 0;
+					for (; j < nr; ++j) *(dst++) = static_cast<TC>(b[p * rsb + (jr + j) * csb]);
+					for (; j < NR; ++j) *(dst++) = TC(0);
+				}
+			}
+		}
+
+		/**
+		 * @brief Register tiled microkernel computing a MR x NR tile of C from packed micro-panels
+		 *
+		 * @param kc Depth of the panels
+		 * @param ap Packed A micro-panel
+		 * @param bp Packed B micro-panel
+		 * @param c Upper left of the C tile
+		 * @param rsc C row stride
+		 * @param mr Valid rows of the tile
+		 * @param nr Valid columns of the tile
+		 */
+		template<size_t MR, size_t NR, typename TC>
+		void micro_kernel(size_t kc, const TC *__restrict ap, const TC *__restrict bp, TC *c, size_t rsc, size_t mr,
+						  size_t nr) noexcept
+		{
+			TC acc[MR][NR] = {};
+
+			for (size_t p = 0; p < kc; ++p, ap += MR, bp += NR)
+				for (size_t i = 0; i < MR; ++i)
+					for (size_t j = 0; j < NR; ++j) acc[i][j] += ap[i] * bp[j];
+
+			if (mr == MR && nr == NR)
+				for (size_t i = 0; i < MR; ++i)
+					for (size_t j = 0; j < NR; ++j) c[i * rsc + j] += acc[i][j];
+			else
+				for (size_t i = 0; i < mr; ++i)
+					for (size_t j = 0; j < nr; ++j) c[i * rsc + j] += acc[i][j];
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Cache blocked GEMM computing C += alpha * A * B using packed panels and a register tiled microkernel. A
+	 * and B may be of any stride and are converted into TC while packing. C must not overlap A or B.
+	 *
+	 * @param m Rows of A and C
+	 * @param n Columns of B and C
+	 * @param k Columns of A and rows of B
+	 * @param a A data
+	 * @param rsa A row stride
+	 * @param csa A column stride
+	 * @param b B data
+	 * @param rsb B row stride
+	 * @param csb B column stride
+	 * @param c C data (contiguous rows)
+	 * @param rsc C row stride
+	 * @param alpha Scale of the product
+	 */
+	template<typename TA, typename TB, typename TC>
+	void gemm_blocked(size_t m, size_t n, size_t k, const TA *a, size_t rsa, size_t csa, const TB *b, size_t rsb,
+					  size_t csb, TC *c, size_t rsc, TC alpha = TC(1))
+	{
+		using B = GemmBlocking<TC>;
+
+		const auto kc_max = std::min(B::KC, k);
+		const auto mc_max = std::min(B::MC, (m + B::MR - 1) / B::MR * B::MR);
+		const auto nc_max = std::min(B::NC, (n + B::NR - 1) / B::NR * B::NR);
+
+		std::vector<TC> a_pack(mc_max * kc_max);
+		std::vector<TC> b_pack(nc_max * kc_max);
+
+		for (size_t jc = 0; jc < n; jc += B::NC)
+		{
+			const auto nc = std::min(B::NC, n - jc);
+
+			for (size_t pc = 0; pc < k; pc += B::KC)
+			{
+				const auto kc = std::min(B::KC, k - pc);
+				detail::pack_b<B::NR>(kc, nc, b + pc * rsb + jc * csb, rsb, csb, b_pack.data());
+
+				for (size_t ic = 0; ic < m; ic += B::MC)
+				{
+					const auto mc = std::min(B::MC, m - ic);
+					detail::pack_a<B::MR>(mc, kc, a + ic * rsa + pc * csa, rsa, csa, a_pack.data(), alpha);
+
+					for (size_t jr = 0; jr < nc; jr += B::NR)
+						for (size_t ir = 0; ir < mc; ir += B::MR)
+							detail::micro_kernel<B::MR, B::NR>(kc, a_pack.data() + ir * kc, b_pack.data() + jr * kc,
+															   c + (ic + ir) * rsc + jc + jr, rsc,
+															   std::min(B::MR, mc - ir), std::min(B::NR, nc - jr));
+				}
+			}
+		}
+	}
+
+	namespace detail
+	{
+		/**
+		 * @brief Widens a rows x cols block of reduced precision elements into a contiguous row major buffer
+		 */
+		template<typename T, typename W>
+		void widen(size_t rows, size_t cols, const T *src, size_t rs, size_t cs, W *dst) noexcept
+		{
+			for (size_t r = 0; r < rows; ++r, dst += cols)
+				if (cs == 1)
+					simd::convert(dst, src + r * rs, cols);
+				else
+					for (size_t c = 0; c < cols; ++c) dst[c] = static_cast<W>(src[r * rs + c * cs]);
+		}
+
+		/**
+		 * @brief Naive product on reduced precision operands. B is widened to float once and A one row at a time, so
+		 * the inner loop runs on floats instead of converting every element k times. Matrix vector products use the
+		 * SIMD dot product.
+		 */
+		template<typename TA, typename TB, typename TC>
+		void gemm_widened(size_t m, size_t n, size_t k, const TA *a, size_t rsa, size_t csa, const TB *b, size_t rsb,
+						  size_t csb, TC *c, size_t rsc, TC alpha)
+		{
+			if constexpr (mth::reduced_precision<TB>)
+			{
+				std::vector<float> wb(k * n);
+				widen(k, n, b, rsb, csb, wb.data());
+				gemm_widened(m, n, k, a, rsa, csa, wb.data(), n, size_t(1), c, rsc, alpha);
+			}
+			else if constexpr (mth::reduced_precision<TA>)
+			{
+				std::vector<float> wa(k);
+
+				if (n == 1) // Matrix vector product: SIMD dot products on floats
+				{
+					std::vector<float> wb(k);
+					for (size_t p = 0; p < k; ++p) wb[p] = static_cast<float>(b[p * rsb]);
+
+					for (size_t i = 0; i < m; ++i)
+					{
+						widen(1, k, a + i * rsa, rsa, csa, wa.data());
+						c[i * rsc] += alpha * static_cast<TC>(simd::dot(wa.data(), wb.data(), k));
+					}
+					return;
+				}
+
+				for (size_t i = 0; i < m; ++i)
+				{
+					widen(1, k, a + i * rsa, rsa, csa, wa.data());
+					gemm_naive(1, n, k, wa.data(), k, size_t(1), b, rsb, csb, c + i * rsc, rsc, alpha);
+				}
+			}
+			else
+				gemm_naive(m, n, k, a, rsa, csa, b, rsb, csb, c, rsc, alpha);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Computes C += alpha * A * B choosing the naive loop for tiny or constexpr products, gemv for matrix vector
+	 * products and the blocked kernel otherwise. Parameters are the same as gemm_blocked.
+	 */
+	template<typename TA, typename TB, typename TC>
+	constexpr void gemm(size_t m, size_t n, size_t k, const TA *a, size_t rsa, size_t csa, const TB *b, size_t rsb,
+						size_t csb, TC *c, size_t rsc, TC alpha = TC(1))
+	{
+		if constexpr (mth::reduced_precision<TA> || mth::reduced_precision<TB>)
+			if (!std::is_constant_evaluated() && !use_blocked_gemm(m, n, k))
+				return detail::gemm_widened(m, n, k, a, rsa, csa, b, rsb, csb, c, rsc, alpha);
+
+		if constexpr (std::same_as<TA, TB> && std::same_as<TA, TC> && simd::vectorizable<simd::Mul, TA>)
+			if (!std::is_constant_evaluated() && n == 1 && csa == 1)
+				return gemv(m, k, a, rsa, b, rsb, c, rsc, alpha);
+
+		if (std::is_constant_evaluated() || !use_blocked_gemm(m, n, k))
+			gemm_naive(m, n, k, a, rsa, csa, b, rsb, csb, c, rsc, alpha);
+		else
+			gemm_blocked(m, n, k, a, rsa, csa, b, rsb, csb, c, rsc, alpha);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Quantized GEMM
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Rows of B^T kept hot in cache while the rows of A stream past them
+	 */
+	static constexpr size_t GEMM_S8_BLOCK = 64;
+
+	/**
+	 * @brief Computes C = A * B on signed bytes with exact 32 bit accumulation. B is passed transposed so every
+	 * element of C is a dot product of 2 contiguous rows.
+	 *
+	 * @param m Rows of A and C
+	 * @param n Columns of B and C
+	 * @param k Columns of A and rows of B
+	 * @param a A data (row major)
+	 * @param lda A row stride
+	 * @param bt B^T data (row major, n x k)
+	 * @param ldb B^T row stride
+	 * @param c C data
+	 * @param ldc C row stride
+	 */
+	inline void gemm_s8(size_t m, size_t n, size_t k, const std::int8_t *a, size_t lda, const std::int8_t *bt,
+						size_t ldb, std::int32_t *c, size_t ldc) noexcept
+	{
+		for (size_t j0 = 0; j0 < n; j0 += GEMM_S8_BLOCK)
+		{
+			const auto j1 = std::min(n, j0 + GEMM_S8_BLOCK);
+
+			for (size_t i = 0; i < m; ++i)
+				for (size_t j = j0; j < j1; ++j) c[i * ldc + j] = simd::dot_s8(a + i * lda, bt + j * ldb, k);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Transpose
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Edge of the cache tiles the transposes work on
+	 */
+	static constexpr size_t TRANSPOSE_BLOCK = 64;
+
+	/**
+	 * @brief Tiled out-of-place transpose dst(c, r) = src(r, c). Cache sized tiles are split into register tiles that
+	 * are transposed with SIMD shuffles. src and dst must not overlap.
+	 *
+	 * @param rows Rows of src
+	 * @param cols Columns of src
+	 * @param src Source data
+	 * @param rss Source row stride
+	 * @param dst Destination data
+	 * @param rsd Destination row stride
+	 */
+	template<typename T>
+	constexpr void transpose(size_t rows, size_t cols, const T *src, size_t rss, T *dst, size_t rsd) noexcept
+	{
+		if (std::is_constant_evaluated())
+		{
+			for (size_t r = 0; r < rows; ++r)
+				for (size_t c = 0; c < cols; ++c) dst[c * rsd + r] = src[r * rss + c];
+			return;
+		}
+
+		constexpr auto TS = simd::tile_size<T>;
+
+		for (size_t rb = 0; rb < rows; rb += TRANSPOSE_BLOCK)
+			for (size_t cb = 0; cb < cols; cb += TRANSPOSE_BLOCK)
+			{
+				const auto r_end = std::min(rows, rb + TRANSPOSE_BLOCK);
+				const auto c_end = std::min(cols, cb + TRANSPOSE_BLOCK);
+
+				size_t r = rb;
+				if constexpr (TS > 1)
+					for (; r + TS <= r_end; r += TS)
+					{
+						size_t c = cb;
+						for (; c + TS <= c_end; c += TS)
+							simd::transpose_tile(src + r * rss + c, rss, dst + c * rsd + r, rsd);
+
+						for (; c < c_end; ++c)
+							for (size_t i = r; i < r + TS; ++i) dst[c * rsd + i] = src[i * rss + c];
+					}
+
+				for (; r < r_end; ++r)
+					for (size_t c = cb; c < c_end; ++c) dst[c * rsd + r] = src[r * rss + c];
+			}
+	}
+
+	namespace detail
+	{
+		/**
+		 * @brief Swaps the register tile at a with the transpose of the one at b. a == b transposes the tile in place.
+		 */
+		template<typename T>
+		void swap_tiles(T *a, T *b, size_t rs) noexcept
+		{
+			constexpr auto TS = simd::tile_size<T>;
+
+			T buf[TS * TS];
+			simd::transpose_tile(a, rs, buf, TS);
+			if (a != b)
+				simd::transpose_tile(b, rs, a, rs);
+
+			for (size_t i = 0; i < TS; ++i) std::copy_n(buf + i * TS, TS, b + i * rs);
+		}
+
+		/**
+		 * @brief Swaps the n x m block a with the transpose of the m x n block b. Full register tiles are swapped
+		 * with SIMD shuffles. a == b (with n == m) transposes the block in place.
+		 */
+		template<typename T>
+		constexpr void swap_transposed_base(size_t n, size_t m, T *a, T *b, size_t rs) noexcept
+		{
+			constexpr auto TS	= simd::tile_size<T>;
+			const auto	   diag = a == b;
+
+			size_t i0 = 0;
+
+			if constexpr (TS > 1)
+				if (!std::is_constant_evaluated())
+					for (; i0 + TS <= n; i0 += TS)
+					{
+						auto j = diag ? i0 : 0;
+
+						for (; j + TS <= m; j += TS) swap_tiles(a + i0 * rs + j, b + j * rs + i0, rs);
+
+						for (; j < m; ++j)
+							for (size_t i = i0; i < i0 + TS; ++i) std::swap(a[i * rs + j], b[j * rs + i]);
+					}
+
+			for (size_t i = i0; i < n; ++i)
+				for (size_t j = diag ? i + 1 : 0; j < m; ++j) std::swap(a[i * rs + j], b[j * rs + i]);
+		}
+
+		/**
+		 * @brief Swaps the n x m block a with the transpose of the m x n block b by recursively halving the longer
+		 * side, so every level of the cache is used without knowing its size.
+		 */
+		template<typename T>
+		constexpr void swap_transposed(size_t n, size_t m, T *a, T *b, size_t rs) noexcept
+		{
+			if (n * m <= 32 * 32)
+				swap_transposed_base(n, m, a, b, rs);
+			else if (n >= m)
+			{
+				swap_transposed(n / 2, m, a, b, rs);
+				swap_transposed(n - n / 2, m, a + n / 2 * rs, b + n / 2, rs);
+			}
+			else
+			{
+				swap_transposed(n, m / 2, a, b, rs);
+				swap_transposed(n, m - m / 2, a + m / 2, b + m / 2 * rs, rs);
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Cache oblivious in-place transpose of a square matrix. Diagonal quadrants are transposed recursively and
+	 * off diagonal quadrants swapped with each other.
+	 *
+	 * @param n Rows and columns
+	 * @param a Data
+	 * @param rs Row stride
+	 */
+	template<typename T>
+	constexpr void transpose_square(size_t n, T *a, size_t rs) noexcept
+	{
+		if (n <= 32)
+			return detail::swap_transposed_base(n, n, a, a, rs);
+
+		const auto h = n / 2;
+
+		transpose_square(h, a, rs);
+		transpose_square(n - h, a + h * rs + h, rs);
+		detail::swap_transposed(h, n - h, a + h, a + h * rs, rs);
+	}
+
+	/**
+	 * @brief In-place transpose of a contiguous rows x cols matrix by following the permutation cycles. Only needs a
+	 * bit per element to mark visited positions. The result has cols rows of rows columns.
+	 *
+	 * @param rows Rows
+	 * @param cols Columns
+	 * @param a Data
+	 */
+	template<typename T>
+	constexpr void transpose_cycles(size_t rows, size_t cols, T *a)
+	{
+		const auto n = rows * cols;
+		if (rows <= 1 || cols <= 1)
+			return;
+
+		// Element k moves to k * rows mod (n - 1). First and last stay.
+		std::vector<bool> visited(n);
+
+		for (size_t start = 1; start < n - 1; ++start)
+		{
+			if (visited[start])
+				continue;
+
+			auto val = a[start];
+			auto k	 = start;
+
+			do
+			{
+				k = k * rows % (n - 1);
+				std::swap(val, a[k]);
+				visited[k] = true;
+			} while (k != start);
+		}
+	}
+
+} // namespace ctl::mth::kernel
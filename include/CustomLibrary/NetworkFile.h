@@ -0,0 +1,460 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+#include "MatrixFile.h"
+#include "NeuralNet.h"
+
+namespace ctl::mcl
+{
+	// -----------------------------------------------------------------------------
+	// Binary Checkpoint Format
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Header of a network checkpoint. Fields are stored in the byte order given by endian. A table of
+	 * LayerRecords follows at table_offset, the parameters of all layers lie in one blob at data_offset which is
+	 * aligned to alignment so the file can be mapped and used in place.
+	 */
+	struct NetworkHeader
+	{
+		static constexpr std::array<char, 4> MAGIC	 = { 'C', 'T', 'L', 'N' };
+		static constexpr std::uint16_t		 VERSION = 1;
+
+		std::array<char, 4> magic		 = MAGIC;
+		std::uint16_t		version		 = VERSION;
+		mth::DType			dtype		 = mth::DType::f64;
+		std::uint8_t		endian		 = std::endian::native == std::endian::big ? mth::FileHeader::BIG
+																				   : mth::FileHeader::LITTLE;
+		std::uint32_t		alignment	 = 64;
+		std::uint32_t		layers		 = 0;
+		std::uint64_t		inputs		 = 0;
+		std::uint64_t		table_offset = sizeof(NetworkHeader);
+		std::uint64_t		data_offset	 = 0;
+		std::uint64_t		data_size	 = 0;
+		std::array<char, 16> reserved	 = {};
+
+		/**
+		 * @brief Checks if the file was written with the byte order of this machine
+		 * @return bool
+		 */
+		[[nodiscard]] auto is_native() const noexcept -> bool
+		{
+			return endian == (std::endian::native == std::endian::big ? mth::FileHeader::BIG : mth::FileHeader::LITTLE);
+		}
+	};
+
+	/**
+	 * @brief Shape, activation and parameter location of a layer. Offsets are bytes from the start of the blob.
+	 */
+	struct LayerRecord
+	{
+		std::uint64_t		rows			= 0;
+		std::uint64_t		cols			= 0;
+		std::uint64_t		weights_offset	= 0;
+		std::uint64_t		biases_offset	= 0;
+		Activation			activation		= Activation::sigmoid;
+		std::array<char, 7> reserved		= {};
+	};
+
+	static_assert(sizeof(NetworkHeader) == 64 && std::is_trivially_copyable_v<NetworkHeader>);
+	static_assert(sizeof(LayerRecord) == 40 && std::is_trivially_copyable_v<LayerRecord>);
+
+	namespace detail
+	{
+		inline void byteswap(NetworkHeader &h) noexcept
+		{
+			using mth::detail::byteswap;
+
+			h.version	   = byteswap(h.version);
+			h.alignment	   = byteswap(h.alignment);
+			h.layers	   = byteswap(h.layers);
+			h.inputs	   = byteswap(h.inputs);
+			h.table_offset = byteswap(h.table_offset);
+			h.data_offset  = byteswap(h.data_offset);
+			h.data_size	   = byteswap(h.data_size);
+		}
+
+		inline void byteswap(LayerRecord &r) noexcept
+		{
+			using mth::detail::byteswap;
+
+			r.rows			 = byteswap(r.rows);
+			r.cols			 = byteswap(r.cols);
+			r.weights_offset = byteswap(r.weights_offset);
+			r.biases_offset	 = byteswap(r.biases_offset);
+		}
+
+		/**
+		 * @brief Checks and converts a header to the byte order of this machine
+		 */
+		inline void validate(NetworkHeader &h)
+		{
+			if (h.magic != NetworkHeader::MAGIC)
+				throw std::runtime_error("Not a network checkpoint.");
+
+			if (!h.is_native())
+				byteswap(h);
+
+			if (h.version > NetworkHeader::VERSION)
+				throw std::runtime_error("Network checkpoint version is newer than supported.");
+			if (h.dtype > mth::DType::f64)
+				throw std::runtime_error("Unknown parameter type in network checkpoint.");
+			if (h.layers == 0 || h.table_offset < sizeof(NetworkHeader)
+				|| h.data_offset < mth::detail::checked_add(h.table_offset, h.layers * sizeof(LayerRecord)))
+				throw std::runtime_error("Corrupt network checkpoint header.");
+		}
+
+		/**
+		 * @brief Checks that the layers chain up and their parameters lie in the blob
+		 */
+		inline void validate(const NetworkHeader &h, const std::vector<LayerRecord> &records)
+		{
+			using mth::detail::checked_add, mth::detail::checked_mul;
+
+			const auto size = mth::detail::dtype_size(h.dtype);
+
+			auto inputs = h.inputs;
+			for (const auto &r : records)
+			{
+				if (r.cols != inputs || r.activation > Activation::softmax
+					|| checked_add(r.weights_offset, checked_mul(checked_mul(r.rows, r.cols), size)) > h.data_size
+					|| checked_add(r.biases_offset, checked_mul(r.rows, size)) > h.data_size)
+					throw std::runtime_error("Corrupt network checkpoint layer.");
+
+				inputs = r.rows;
+			}
+		}
+
+		/**
+		 * @brief Reads and validates the header and layer table of a checkpoint in memory
+		 */
+		inline auto parse(const std::byte *data, size_t size) -> std::pair<NetworkHeader, std::vector<LayerRecord>>
+		{
+			NetworkHeader h;
+			if (size < sizeof(h))
+				throw std::runtime_error("Network checkpoint header is truncated.");
+			std::memcpy(&h, data, sizeof(h));
+
+			validate(h);
+			if (mth::detail::checked_add(h.data_offset, h.data_size) > size)
+				throw std::runtime_error("Network checkpoint data is truncated.");
+
+			std::vector<LayerRecord> records(h.layers);
+			std::memcpy(records.data(), data + h.table_offset, records.size() * sizeof(LayerRecord));
+
+			if (!h.is_native())
+				for (auto &r : records) byteswap(r);
+
+			validate(h, records);
+
+			return { h, records };
+		}
+
+		/**
+		 * @brief Copies n elements stored as dtype into dst, converting the type and byte order
+		 */
+		template<typename T>
+		void convert(const std::byte *src, mth::DType dtype, bool native, T *dst, size_t n)
+		{
+			mth::detail::visit_dtype(dtype, [&]<typename S>(S) {
+				if constexpr (std::is_same_v<S, T>)
+					if (native)
+					{
+						std::memcpy(dst, src, n * sizeof(T));
+						return;
+					}
+
+				for (size_t i = 0; i < n; ++i)
+				{
+					S v;
+					std::memcpy(&v, src + i * sizeof(S), sizeof(S));
+					dst[i] = static_cast<T>(native ? v : mth::detail::byteswap(v));
+				}
+			});
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Write a network as a binary checkpoint: header, layer table and all parameters in one aligned blob.
+	 * With the default alignment the blob is the parameter buffer of the network and written in one go.
+	 *
+	 * @param o Binary output stream
+	 * @param nn Network
+	 * @param alignment Alignment of the blob and every matrix in it. Power of 2.
+	 * @return o
+	 */
+	template<arithmetic Weight>
+	auto save(std::ostream &o, const BasicNeuralNetwork<Weight> &nn, size_t alignment = 64) -> std::ostream &
+	{
+		assert(nn.begin() != nn.end() && "Network must have layers.");
+		assert(std::has_single_bit(alignment) && "Alignment must be a power of 2.");
+
+		const auto align = [alignment](size_t x) { return (x + alignment - 1) / alignment * alignment; };
+
+		NetworkHeader h;
+		h.dtype		= mth::dtype_of<Weight>;
+		h.alignment = static_cast<std::uint32_t>(alignment);
+		h.inputs	= nn.begin()->weights.dim().w;
+
+		std::vector<LayerRecord> records;
+		for (const auto &l : nn)
+		{
+			LayerRecord r;
+			r.rows			 = l.weights.dim().h;
+			r.cols			 = l.weights.dim().w;
+			r.activation	 = l.activation;
+			r.weights_offset = h.data_size;
+			r.biases_offset	 = align(r.weights_offset + l.weights.size() * sizeof(Weight));
+			h.data_size		 = align(r.biases_offset + l.biases.size() * sizeof(Weight));
+
+			records.push_back(r);
+		}
+
+		h.layers	  = static_cast<std::uint32_t>(records.size());
+		h.data_offset = align(h.table_offset + records.size() * sizeof(LayerRecord));
+
+		std::vector<std::byte> head(h.data_offset);
+		std::memcpy(head.data(), &h, sizeof(h));
+		std::memcpy(head.data() + h.table_offset, records.data(), records.size() * sizeof(LayerRecord));
+
+		o.write(reinterpret_cast<const char *>(head.data()), static_cast<std::streamsize>(head.size()));
+
+		// With the network's own alignment the blob is its parameter buffer
+		const auto params = nn.parameters();
+		if (params.size_bytes() == h.data_size)
+			return o.write(reinterpret_cast<const char *>(params.data()), static_cast<std::streamsize>(h.data_size));
+
+		std::vector<std::byte> blob(h.data_size);
+		for (auto [l, r] = std::pair(nn.begin(), records.begin()); l != nn.end(); ++l, ++r)
+		{
+			std::memcpy(blob.data() + r->weights_offset, l->weights.data(), l->weights.size() * sizeof(Weight));
+			std::memcpy(blob.data() + r->biases_offset, l->biases.data(), l->biases.size() * sizeof(Weight));
+		}
+
+		return o.write(reinterpret_cast<const char *>(blob.data()), static_cast<std::streamsize>(blob.size()));
+	}
+
+	/**
+	 * @brief Write a network as a binary checkpoint file
+	 *
+	 * @param path File to write
+	 * @param nn Network
+	 */
+	template<arithmetic Weight>
+	void save(const std::filesystem::path &path, const BasicNeuralNetwork<Weight> &nn)
+	{
+		std::ofstream o(path, std::ios::binary);
+		if (!save(o, nn))
+			throw std::runtime_error("Couldn't write network checkpoint.");
+	}
+
+	namespace detail
+	{
+		template<typename Weight>
+		auto build(const std::byte *data, size_t size) -> BasicNeuralNetwork<Weight>
+		{
+			const auto [h, records] = parse(data, size);
+			const auto *blob		= data + h.data_offset;
+
+			std::vector<size_t>		neurons = { h.inputs };
+			std::vector<Activation> activations;
+			for (const auto &r : records)
+			{
+				neurons.push_back(r.rows);
+				activations.push_back(r.activation);
+			}
+
+			BasicNeuralNetwork<Weight> nn(neurons, activations);
+			const auto				   params = nn.parameters();
+
+			// A checkpoint saved from this type with the network's own alignment is a copy of the parameter buffer
+			auto same = h.dtype == mth::dtype_of<Weight> && h.is_native() && h.data_size == params.size_bytes();
+			for (size_t i = 0; same && i < records.size(); ++i)
+				same = records[i].weights_offset == (nn.weights(i).data() - params.data()) * sizeof(Weight)
+					&& records[i].biases_offset == (nn.biases(i).data() - params.data()) * sizeof(Weight);
+
+			if (same)
+			{
+				std::memcpy(params.data(), blob, h.data_size);
+				return nn;
+			}
+
+			for (size_t i = 0; i < records.size(); ++i)
+			{
+				const auto &r = records[i];
+				convert(blob + r.weights_offset, h.dtype, h.is_native(), nn.weights(i).data(), r.rows * r.cols);
+				convert(blob + r.biases_offset, h.dtype, h.is_native(), nn.biases(i).data(), r.rows);
+			}
+
+			return nn;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Read a network from a binary checkpoint. Parameters of a different type or byte order are converted.
+	 *
+	 * @param in Binary input stream positioned at the checkpoint
+	 * @return Network
+	 */
+	template<arithmetic Weight = double>
+	auto load(std::istream &in) -> BasicNeuralNetwork<Weight>
+	{
+		NetworkHeader h;
+		if (!in.read(reinterpret_cast<char *>(&h), sizeof(h)))
+			throw std::runtime_error("Couldn't read network checkpoint header.");
+
+		auto native = h;
+		detail::validate(native);
+
+		// Only allocate what the stream can actually hold
+		const auto end = mth::detail::checked_add(native.data_offset, native.data_size);
+		if (end - sizeof(h) > mth::detail::remaining(in))
+			throw std::runtime_error("Network checkpoint data is truncated.");
+
+		std::vector<std::byte> buf(end);
+		std::memcpy(buf.data(), &h, sizeof(h));
+
+		const auto rest = static_cast<std::streamsize>(buf.size() - sizeof(h));
+		if (!in.read(reinterpret_cast<char *>(buf.data() + sizeof(h)), rest))
+			throw std::runtime_error("Network checkpoint data is truncated.");
+
+		return detail::build<Weight>(buf.data(), buf.size());
+	}
+
+	/**
+	 * @brief Read a network from a binary checkpoint file. The file is mapped and the parameters are copied straight
+	 * out of the mapping.
+	 *
+	 * @param path Checkpoint file
+	 * @return Network
+	 */
+	template<arithmetic Weight = double>
+	auto load(const std::filesystem::path &path) -> BasicNeuralNetwork<Weight>
+	{
+		const mth::MappedFile file(path);
+		return detail::build<Weight>(file.data(), file.size());
+	}
+
+	// -----------------------------------------------------------------------------
+	// Mapped Network
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Inference only network whose parameters lie in a mapped checkpoint. Opening only parses the header and
+	 * layer table; nothing is copied and pages are loaded by the OS on first use.
+	 *
+	 * @tparam Weight Parameter type. Must match the stored type.
+	 */
+	template<arithmetic Weight = double>
+	class MappedNeuralNetwork
+	{
+	public:
+		/**
+		 * @brief Layer viewing the mapped parameters
+		 */
+		struct MappedLayer
+		{
+			mth::MatrixView<const Weight> weights, biases;
+			Activation					  activation;
+		};
+
+		/**
+		 * @brief Map a checkpoint file
+		 * @param path Checkpoint file
+		 */
+		explicit MappedNeuralNetwork(const std::filesystem::path &path)
+			: m_file(std::make_shared<const mth::MappedFile>(path))
+		{
+			const auto [h, records] = detail::parse(m_file->data(), m_file->size());
+
+			if (h.dtype != mth::dtype_of<Weight> || !h.is_native())
+				throw std::runtime_error("Mapped network type or byte order doesn't match the checkpoint.");
+
+			const auto *blob = m_file->data() + h.data_offset;
+			if (reinterpret_cast<std::uintptr_t>(blob) % alignof(Weight) != 0)
+				throw std::runtime_error("Mapped network data is misaligned.");
+
+			m_layers.reserve(records.size());
+			for (const auto &r : records)
+			{
+				const auto *w = reinterpret_cast<const Weight *>(blob + r.weights_offset);
+				const auto *b = reinterpret_cast<const Weight *>(blob + r.biases_offset);
+
+				if (r.weights_offset % alignof(Weight) != 0 || r.biases_offset % alignof(Weight) != 0)
+					throw std::runtime_error("Mapped network data is misaligned.");
+
+				m_layers.push_back({ mth::MatrixView<const Weight>(w, r.rows, r.cols),
+									 mth::MatrixView<const Weight>(b, r.rows, 1), r.activation });
+			}
+		}
+
+		/**
+		 * @brief Performs a feedforward query with given input
+		 * @param input Matrix input to use
+		 * @return result matrix
+		 */
+		[[nodiscard]] auto query(const mth::Matrix<double> &input) const { return query_batch(input); }
+
+		/**
+		 * @brief Performs a feedforward query on a batch of inputs
+		 *
+		 * @param policy Execution policy the GEMMs are run with
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		template<exe::execution_policy P>
+		[[nodiscard]] auto query_batch(const P &policy, const mth::Matrix<double> &input) const
+		{
+			return detail::feedforward(policy, m_layers, input);
+		}
+		[[nodiscard]] auto query_batch(const mth::Matrix<double> &input) const { return query_batch(exe::seq, input); }
+
+		/**
+		 * @brief Copy the parameters into a trainable network
+		 * @return Network
+		 */
+		[[nodiscard]] auto to_network() const -> BasicNeuralNetwork<Weight>
+		{
+			std::vector<size_t>		neurons = { m_layers.front().weights.dim().w };
+			std::vector<Activation> activations;
+			for (const auto &l : m_layers)
+			{
+				neurons.push_back(l.weights.dim().h);
+				activations.push_back(l.activation);
+			}
+
+			BasicNeuralNetwork<Weight> nn(neurons, activations);
+			for (size_t i = 0; i < m_layers.size(); ++i)
+			{
+				nn.weights(i).assign(m_layers[i].weights);
+				nn.biases(i).assign(m_layers[i].biases);
+			}
+
+			return nn;
+		}
+
+		/**
+		 * @brief Returns the number of layers within the network
+		 * @return layer number
+		 */
+		[[nodiscard]] auto layers_n() const noexcept -> size_t { return m_layers.size() + 1; }
+
+		[[nodiscard]] auto begin() const noexcept { return m_layers.begin(); }
+		[[nodiscard]] auto end() const noexcept { return m_layers.end(); }
+
+	private:
+		std::shared_ptr<const mth::MappedFile> m_file;
+		std::vector<MappedLayer>			   m_layers;
+	};
+
+} // namespace ctl::mcl
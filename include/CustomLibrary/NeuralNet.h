@@ -3,19 +3,109 @@
 
 #include "utility.h"
 #include "Matrix.h"
+#include "Allocator.h"
+#include "Quantize.h"
+#include "Activation.h"
+#include "Optimizer.h"
 
 #include <cmath>
+#include <optional>
+#include <span>
+#include <utility>
 
 namespace ctl::mcl
 {
 	/**
-	 * @brief Simple Layer descriptor
+	 * @brief Simple Layer descriptor. The weights and biases view the parameter buffer of the network.
+	 * @tparam T Parameter type. f16 or bf16 halve the memory of the weights.
 	 */
+	template<typename T = double>
 	struct Layer
 	{
-		mth::Matrix<double> weights, biases;
+		mth::MatrixView<T> weights, biases;
+		Activation		   activation = Activation::sigmoid;
 	};
 
+	namespace detail
+	{
+		/**
+		 * @brief Largest amount of neurons of the hidden layers
+		 */
+		template<typename Layers>
+		auto hidden_neurons(const Layers &layers) noexcept -> size_t
+		{
+			const auto first = std::begin(layers), last = std::end(layers);
+
+			size_t hidden = 0;
+			for (auto i = first; i != last && std::next(i) != last; ++i) hidden = std::max(hidden, i->weights.dim().h);
+
+			return hidden;
+		}
+
+		/**
+		 * @brief Feedforward of a batch through a range of layers. Every layer is a single GEMM into a buffer
+		 * prefilled with the broadcast bias, followed by the activation in place. The hidden layers alternate between
+		 * 2 buffers so a query needs the same memory regardless of the depth.
+		 *
+		 * @param policy Execution policy the GEMMs are run with
+		 * @param layers Layers with strided weights, biases and an activation
+		 * @param in Inputs, one per column
+		 * @param ping, pong Buffers of hidden_neurons(layers) times the batch size elements each
+		 * @param out Outputs, one per column
+		 */
+		template<typename P, typename Layers>
+		void feedforward(const P &policy, const Layers &layers, mth::MatrixView<const double> in, double *ping,
+						 double *pong, mth::MatrixView<double> out)
+		{
+			const auto first = std::begin(layers), last = std::end(layers);
+			assert(first != last && in.dim().h == first->weights.dim().w && "Input must match the input layer.");
+			assert(out.dim().h == std::prev(last)->weights.dim().h && out.dim().w == in.dim().w
+				   && "Output must match the output layer.");
+
+			const auto batch = in.dim().w;
+
+			for (auto [i, l] = std::pair(first, size_t(0)); i != last; ++i, ++l)
+			{
+				const auto rows = i->weights.dim().h;
+
+				auto a = std::next(i) == last ? out : mth::MatrixView<double>(l % 2 ? pong : ping, rows, batch);
+
+				for (size_t r = 0; r < rows; ++r)
+					std::fill_n(a.data() + r * batch, batch, static_cast<double>(i->biases.data()[r]));
+
+				mth::detail::strided_product(policy, i->weights, in, a);
+				activate(i->activation, a.data(), rows, batch);
+
+				in = mth::MatrixView<const double>(a);
+			}
+		}
+
+		/**
+		 * @brief Feedforward of a batch through a range of layers into newly allocated outputs
+		 *
+		 * @param policy Execution policy the GEMMs are run with
+		 * @param layers Layers with strided weights, biases and an activation
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		template<typename P, typename Layers>
+		auto feedforward(const P &policy, const Layers &layers, const mth::Matrix<double> &input)
+			-> mth::Matrix<double>
+		{
+			assert(std::begin(layers) != std::end(layers) && "Network has no layers.");
+
+			const auto batch  = input.dim().w;
+			const auto hidden = hidden_neurons(layers);
+
+			std::vector<double> ping(hidden * batch), pong(hidden * batch);
+			mth::Matrix<double> output(std::prev(std::end(layers))->weights.dim().h, batch, 0.);
+
+			feedforward(policy, layers, input.view(), ping.data(), pong.data(), output.view());
+
+			return output;
+		}
+	} // namespace detail
+
 	// -----------------------------------------------------------------------------
 	// Neural Networks
 	// -----------------------------------------------------------------------------
@@ -23,15 +113,70 @@ namespace ctl::mcl
 	/**
 	 * @brief Basic Neural Network implementation using the feedforward as the query method and backpropogation as the
 	 * training method
+	 *
+	 * @tparam Weight Type the weights and biases are stored as. Queries are computed and returned in double, reduced
+	 * precision weights are accumulated in float.
 	 */
+	template<typename Weight = double>
 	class BasicNeuralNetwork
 	{
+		template<typename>
+		friend class BasicNeuralNetwork;
+
 	public:
+		using weight_type = Weight;
+
+		/**
+		 * @brief Alignment of the parameter buffer and of every matrix in it in bytes
+		 */
+		static constexpr size_t ALIGNMENT = 64;
+
 		/**
 		 * @brief Construct a empty neural network
 		 */
 		BasicNeuralNetwork() = default;
 
+		BasicNeuralNetwork(const BasicNeuralNetwork &nn)
+			: m_neurons_n(nn.m_neurons_n)
+			, m_params(nn.m_params)
+			, m_layers(nn.m_layers)
+		{
+			_bind_();
+		}
+		BasicNeuralNetwork(BasicNeuralNetwork &&) noexcept = default;
+
+		auto operator=(const BasicNeuralNetwork &nn) -> BasicNeuralNetwork &
+		{
+			if (this != &nn)
+			{
+				m_neurons_n = nn.m_neurons_n;
+				m_params	= nn.m_params;
+				m_layers	= nn.m_layers;
+				_bind_();
+			}
+			return *this;
+		}
+		auto operator=(BasicNeuralNetwork &&) noexcept -> BasicNeuralNetwork & = default;
+
+		/**
+		 * @brief Convert the parameters of a network to a different weight type. (e.g. a trained double network to f16
+		 * for inference)
+		 * @param nn Network to convert
+		 */
+		template<typename W>
+		explicit BasicNeuralNetwork(const BasicNeuralNetwork<W> &nn)
+			: m_neurons_n(nn.m_neurons_n)
+			, m_layers(nn.m_layers.size())
+		{
+			_allocate_();
+			for (size_t i = 0; i < m_layers.size(); ++i)
+			{
+				m_layers[i].weights.assign(nn.m_layers[i].weights);
+				m_layers[i].biases.assign(nn.m_layers[i].biases);
+				m_layers[i].activation = nn.m_layers[i].activation;
+			}
+		}
+
 		/**
 		 * @brief Construct a new Basic Neural Network object with a certain structure
 		 *
@@ -43,37 +188,84 @@ namespace ctl::mcl
 		template<typename Init>
 		BasicNeuralNetwork(std::initializer_list<size_t> &&structure, Init &&init) requires std::invocable<Init>
 			: m_neurons_n(structure)
+			, m_layers(m_neurons_n.size() - 1)
 		{
-			m_layers.reserve(m_neurons_n.size() - 1);
+			_allocate_();
+			for (auto &l : m_layers)
+			{
+				for (size_t i = 0; i < l.weights.size(); ++i) l.weights.data()[i] = static_cast<Weight>(init());
+				for (size_t i = 0; i < l.biases.size(); ++i) l.biases.data()[i] = static_cast<Weight>(init());
+			}
+		}
 
-			for (auto i = m_neurons_n.begin(), end = m_neurons_n.end() - 1; i != end; ++i)
-				m_layers.push_back({ mth::Matrix<double>(*(i + 1), *i, init), mth::Matrix<double>(*(i + 1), 1, init) });
+		/**
+		 * @brief Construct a new Basic Neural Network object with a certain structure and an activation per layer
+		 *
+		 * @tparam Init Initializer Functor
+		 * @param structure Defines the structure of the neural network. For example { 2, 2, 1 } means 2 inputs, 1
+		 * hidden layer with 2 neurons, 1 output
+		 * @param activations Activation of every layer after the input. For example { Activation::relu,
+		 * Activation::softmax }
+		 * @param init Functor used to initialize the network. Sig.: double func();
+		 */
+		template<typename Init>
+		BasicNeuralNetwork(std::initializer_list<size_t> &&structure, std::initializer_list<Activation> activations,
+						   Init &&init) requires std::invocable<Init>
+			: BasicNeuralNetwork(std::move(structure), std::forward<Init>(init))
+		{
+			assert(activations.size() == m_layers.size() && "Every layer needs an activation.");
+			for (size_t i = 0; const auto f : activations) m_layers[i++].activation = f;
 		}
 
 		/**
-		 * @brief Add a additional layer to the neural network
+		 * @brief Construct a network with zeroed parameters in one allocation, e.g. to fill its parameters() from a
+		 * file
+		 *
+		 * @param structure Neurons of every layer including the input
+		 * @param activations Activation of every layer after the input
+		 */
+		BasicNeuralNetwork(std::span<const size_t> structure, std::span<const Activation> activations)
+			: m_neurons_n(structure.begin(), structure.end())
+			, m_layers(activations.size())
+		{
+			assert(structure.size() == activations.size() + 1 && "Every layer needs an activation.");
+
+			for (size_t i = 0; i < m_layers.size(); ++i) m_layers[i].activation = activations[i];
+			_allocate_();
+		}
+
+		/**
+		 * @brief Add a additional layer to the neural network. The parameter buffer grows, the parameters of the
+		 * existing layers keep their offsets.
 		 *
 		 * @param weights Weights to include
 		 * @param biases Biases to include
+		 * @param activation Activation of the layer
 		 */
-		void add_layer(const mth::Matrix<double> &weights, const mth::Matrix<double> &biases)
+		template<mth::matrix_expression W, mth::matrix_expression B>
+		void add_layer(const W &weights, const B &biases, Activation activation = Activation::sigmoid)
 		{
 			if (m_neurons_n.empty())
 				m_neurons_n.emplace_back(weights.dim().w);
 
 			assert(weights.dim().w == m_neurons_n.back()
 				   && "Matrix column size must match the neurons of the previous last layer.");
+			assert(biases.dim().h == weights.dim().h && biases.dim().w == 1 && "Every neuron needs a bias.");
 
 			m_neurons_n.emplace_back(weights.dim().h);
-			m_layers.push_back({ weights, biases });
+			m_layers.push_back({ {}, {}, activation });
+			_allocate_();
+
+			m_layers.back().weights.assign(weights);
+			m_layers.back().biases.assign(biases);
 		}
 
 		/**
 		 * @brief Returns a weight matrix of a layer
 		 * @param idx layer index
-		 * @return weight matrix reference
+		 * @return view of the weights. Assigning to it or assign copies into the network.
 		 */
-		auto weights(size_t idx) noexcept -> auto &
+		auto weights(size_t idx) noexcept -> mth::MatrixView<Weight>
 		{
 			assert(idx < m_layers.size() && "Weights of specified layer don't exist.");
 			return m_layers[idx].weights;
@@ -82,14 +274,33 @@ namespace ctl::mcl
 		/**
 		 * @brief Returns a bias matrix of a layer
 		 * @param idx layer index
-		 * @return bias matrix reference
+		 * @return view of the biases. Assigning to it or assign copies into the network.
 		 */
-		auto biases(size_t idx) noexcept -> auto &
+		auto biases(size_t idx) noexcept -> mth::MatrixView<Weight>
 		{
 			assert(idx < m_layers.size() && "Biases of specified layer don't exist.");
 			return m_layers[idx].biases;
 		}
 
+		/**
+		 * @brief Returns the activation of a layer
+		 * @param idx layer index
+		 * @return activation reference
+		 */
+		auto activation(size_t idx) noexcept -> auto &
+		{
+			assert(idx < m_layers.size() && "Activation of specified layer doesn't exist.");
+			return m_layers[idx].activation;
+		}
+
+		/**
+		 * @brief Returns all parameters. Layer by layer the weights then the biases, each starting on a ALIGNMENT
+		 * boundary; the padding in between is zero.
+		 * @return parameter buffer
+		 */
+		[[nodiscard]] auto parameters() noexcept -> std::span<Weight> { return m_params; }
+		[[nodiscard]] auto parameters() const noexcept -> std::span<const Weight> { return m_params; }
+
 		/**
 		 * @brief Returns the number of layers within the network
 		 * @return layer number
@@ -112,12 +323,27 @@ namespace ctl::mcl
 		 * @param input Matrix input to use
 		 * @return result matrix
 		 */
-		[[nodiscard]] auto query(mth::Matrix<double> input) const
+		[[nodiscard]] auto query(const mth::Matrix<double> &input) const { return query_batch(input); }
+
+		/**
+		 * @brief Performs a feedforward query on a batch of inputs. Every layer is a single GEMM followed by the
+		 * activation in place.
+		 *
+		 * @param policy Execution policy the GEMMs are run with
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		template<exe::execution_policy P>
+		[[nodiscard]] auto query_batch(const P &policy, const mth::Matrix<double> &input) const
 		{
-			for (const auto &i : m_layers) // Feed forward through each layer
-				input = (i.biases + i.weights.dot_product(input)).apply(sigmoid<double>);
-			return input;
+			return detail::feedforward(policy, m_layers, input);
 		}
+		/**
+		 * @brief Performs a sequential feedforward query on a batch of inputs
+		 * @param input Inputs, one per column
+		 * @return Outputs, one per column
+		 */
+		[[nodiscard]] auto query_batch(const mth::Matrix<double> &input) const { return query_batch(exe::seq, input); }
 
 		[[nodiscard]] auto begin() const noexcept { return m_layers.begin(); }
 		[[nodiscard]] auto begin() noexcept { return m_layers.begin(); }
@@ -132,8 +358,347 @@ namespace ctl::mcl
 		[[nodiscard]] auto rend() noexcept { return m_layers.rend(); }
 
 	private:
-		std::vector<size_t> m_neurons_n;
-		std::vector<Layer>	m_layers;
+		std::vector<size_t>											   m_neurons_n;
+		std::vector<Weight, mem::AlignedAllocator<Weight, ALIGNMENT>> m_params;
+		std::vector<Layer<Weight>>									   m_layers;
+
+		/**
+		 * @brief Elements from the start of a matrix of n elements to the start of the next one
+		 */
+		static constexpr auto _padded_(size_t n) noexcept -> size_t
+		{
+			constexpr auto step = std::max<size_t>(1, ALIGNMENT / sizeof(Weight));
+			return (n + step - 1) / step * step;
+		}
+
+		/**
+		 * @brief Sizes the buffer for the structure, zeroing new parameters, and points the layers into it
+		 */
+		void _allocate_()
+		{
+			size_t n = 0;
+			for (size_t l = 0; l < m_layers.size(); ++l)
+				n += _padded_(m_neurons_n[l + 1] * m_neurons_n[l]) + _padded_(m_neurons_n[l + 1]);
+
+			m_params.resize(n);
+			_bind_();
+		}
+
+		/**
+		 * @brief Points the views of the layers into the buffer
+		 */
+		void _bind_() noexcept
+		{
+			auto *p = m_params.data();
+			for (size_t l = 0; l < m_layers.size(); ++l)
+			{
+				const auto h = m_neurons_n[l + 1], w = m_neurons_n[l];
+
+				m_layers[l].weights = mth::MatrixView<Weight>(p, h, w), p += _padded_(h * w);
+				m_layers[l].biases	= mth::MatrixView<Weight>(p, h, 1), p += _padded_(h);
+			}
+		}
+	};
+
+	/**
+	 * @brief Inference only copy of a network with int8 weights. Each weight row gets its own symmetric scale,
+	 * activations are quantized per query or with ranges calibrated on sample inputs.
+	 */
+	class QuantizedNeuralNetwork
+	{
+	public:
+		/**
+		 * @brief Construct a empty quantized network
+		 */
+		QuantizedNeuralNetwork() = default;
+
+		/**
+		 * @brief Quantize the weights of a network. Activations are quantized over their own range on every query.
+		 * @param nn Network to quantize
+		 */
+		template<typename W>
+		explicit QuantizedNeuralNetwork(const BasicNeuralNetwork<W> &nn)
+		{
+			m_layers.reserve(nn.end() - nn.begin());
+			for (const auto &l : nn)
+				m_layers.push_back(
+					{ mth::QuantizedMatrix(l.weights), mth::Matrix<double>(l.biases), l.activation, std::nullopt });
+		}
+
+		/**
+		 * @brief Quantize the weights of a network and calibrate the activation ranges of every layer on sample
+		 * inputs. Queries then skip the range search.
+		 *
+		 * @param nn Network to quantize
+		 * @param input_begin Calibration input begin
+		 * @param input_end Calibration input end
+		 */
+		template<typename W, typename Iter>
+		QuantizedNeuralNetwork(const BasicNeuralNetwork<W> &nn, Iter input_begin, Iter input_end) requires
+			mth::matrix_expression<typename std::iterator_traits<Iter>::value_type>
+			: QuantizedNeuralNetwork(nn)
+		{
+			std::vector<mth::Calibrator> calib(m_layers.size());
+
+			for (; input_begin != input_end; ++input_begin)
+			{
+				mth::Matrix<double> x(*input_begin);
+				for (size_t i = 0; const auto &l : nn)
+				{
+					calib[i++].observe(x);
+					x = l.biases + l.weights.dot_product(x);
+					activate(l.activation, x.data(), x.dim().h, x.dim().w);
+				}
+			}
+
+			for (size_t i = 0; i < m_layers.size(); ++i)
+				if (!calib[i].empty())
+					m_layers[i].input = calib[i].params();
+		}
+
+		/**
+		 * @brief Performs a feedforward query with given input
+		 * @param input Matrix input to use
+		 * @return result matrix
+		 */
+		[[nodiscard]] auto query(mth::Matrix<double> input) const
+		{
+			for (const auto &l : m_layers)
+			{
+				input = l.biases + (l.input ? l.weights.dot_product(input, *l.input) : l.weights.dot_product(input));
+				activate(l.activation, input.data(), input.dim().h, input.dim().w);
+			}
+			return input;
+		}
+
+		/**
+		 * @brief Returns the number of layers within the network
+		 * @return layer number
+		 */
+		[[nodiscard]] auto layers_n() const noexcept -> size_t { return m_layers.size() + 1; }
+
+	private:
+		struct QuantizedLayer
+		{
+			mth::QuantizedMatrix			weights;
+			mth::Matrix<double>				biases;
+			Activation						activation;
+			std::optional<mth::QuantParams> input;
+		};
+
+		std::vector<QuantizedLayer> m_layers;
+	};
+
+	/**
+	 * @brief Inference only copy of a network with float parameters for single sample latency. The layer plan and
+	 * all buffers are set up on construction, a query allocates nothing.
+	 *
+	 * The weights of a layer are stored in panels of PANEL_ROWS rows, column by column. A panel is computed in a
+	 * register starting from its biases, one broadcast input at a time, and the activation is applied to the
+	 * register before it is stored. Softmax needs the whole output and runs after its layer.
+	 */
+	class FrozenNeuralNetwork
+	{
+	public:
+		/**
+		 * @brief Rows computed together in a register
+		 */
+		static constexpr size_t PANEL_ROWS = simd::Pack<float>::width;
+
+		/**
+		 * @brief Construct a empty frozen network
+		 */
+		FrozenNeuralNetwork() = default;
+
+		/**
+		 * @brief Freeze the parameters and activations of a network
+		 * @param nn Network to freeze
+		 */
+		template<typename W>
+		explicit FrozenNeuralNetwork(const BasicNeuralNetwork<W> &nn)
+		{
+			size_t n = 0, widest = 0;
+			for (const auto &l : nn)
+			{
+				const auto rows = l.weights.dim().h, cols = l.weights.dim().w;
+				const auto panels = (rows + PANEL_ROWS - 1) / PANEL_ROWS, padded = panels * PANEL_ROWS;
+
+				m_steps.push_back({ rows, cols, panels, n, n + padded * cols, _kernel_(l.activation),
+									l.activation == Activation::softmax });
+
+				n += padded * cols + padded;
+				widest = std::max(widest, padded);
+			}
+
+			m_params.resize(n);
+			m_ping.resize(widest);
+			m_pong.resize(widest);
+
+			for (size_t i = 0; const auto &l : nn)
+			{
+				const auto &s = m_steps[i++];
+
+				auto *w = m_params.data() + s.weights;
+				for (size_t r = 0; r < s.rows; ++r)
+					for (size_t c = 0; c < s.cols; ++c)
+						w[(r / PANEL_ROWS * s.cols + c) * PANEL_ROWS + r % PANEL_ROWS]
+							= static_cast<float>(l.weights.data()[r * s.cols + c]);
+
+				for (size_t r = 0; r < s.rows; ++r)
+					m_params[s.biases + r] = static_cast<float>(l.biases.data()[r]);
+			}
+		}
+
+		/**
+		 * @brief Performs a feedforward query of a single sample. Uses the buffers of the object, so a frozen
+		 * network serves one thread at a time; copy it for more.
+		 *
+		 * @param input Input of inputs() elements
+		 * @param output Output of outputs() elements
+		 */
+		void infer(std::span<const float> input, std::span<float> output) noexcept
+		{
+			assert(!m_steps.empty() && "Network has no layers.");
+			assert(input.size() == inputs() && output.size() == outputs() && "Sizes must match the network.");
+
+			const auto *x = input.data();
+			for (size_t i = 0; i < m_steps.size(); ++i)
+			{
+				const auto &s = m_steps[i];
+				auto	   *y = (i % 2 ? m_pong : m_ping).data();
+
+				s.kernel(m_params.data() + s.weights, m_params.data() + s.biases, x, y, s.panels, s.cols);
+				if (s.softmax)
+					detail::softmax(y, s.rows, 1);
+
+				x = y;
+			}
+
+			std::copy_n(x, output.size(), output.data());
+		}
+
+		/**
+		 * @brief Returns the number of inputs
+		 * @return input size
+		 */
+		[[nodiscard]] auto inputs() const noexcept -> size_t { return m_steps.empty() ? 0 : m_steps.front().cols; }
+
+		/**
+		 * @brief Returns the number of outputs
+		 * @return output size
+		 */
+		[[nodiscard]] auto outputs() const noexcept -> size_t { return m_steps.empty() ? 0 : m_steps.back().rows; }
+
+		/**
+		 * @brief Returns the number of layers within the network
+		 * @return layer number
+		 */
+		[[nodiscard]] auto layers_n() const noexcept -> size_t { return m_steps.size() + 1; }
+
+	private:
+		using Kernel = void (*)(const float *, const float *, const float *, float *, size_t, size_t) noexcept;
+
+		/**
+		 * @brief Layer of the plan. Offsets index the parameter buffer, so copies stay valid.
+		 */
+		struct Step
+		{
+			size_t rows, cols, panels;
+			size_t weights, biases;
+			Kernel kernel;
+			bool   softmax;
+		};
+
+		/**
+		 * @brief Epilogue of layers without an element wise activation
+		 */
+		struct Linear
+		{
+			template<typename T>
+			auto operator()(T x) const noexcept -> T
+			{
+				return x;
+			}
+			template<typename P, typename R>
+			static auto pack(R a) noexcept -> R
+			{
+				return a;
+			}
+		};
+
+		std::vector<float, mem::AlignedAllocator<float>> m_params, m_ping, m_pong;
+		std::vector<Step>								  m_steps;
+
+		static auto _kernel_(Activation f) noexcept -> Kernel
+		{
+			switch (f)
+			{
+			case Activation::sigmoid:
+				return &_dense_<act::Sigmoid, float>;
+			case Activation::tanh:
+				return &_dense_<act::Tanh, float>;
+			case Activation::relu:
+				return &_dense_<act::ReLU, float>;
+			case Activation::leaky_relu:
+				return &_dense_<act::LeakyReLU, float>;
+			case Activation::identity:
+			case Activation::softmax:
+				break;
+			}
+			return &_dense_<Linear, float>;
+		}
+
+		/**
+		 * @brief y = F(W x + b) over panels of PANEL_ROWS rows. 4 panels run together so their accumulations hide
+		 * each other's latency and share the input broadcasts.
+		 */
+		template<typename F, typename T>
+		static void _dense_(const T *w, const T *b, const T *x, T *y, size_t panels, size_t cols) noexcept
+		{
+			if constexpr (simd::vectorizable_unary<F, T>)
+			{
+				using P = simd::Pack<T>;
+
+				constexpr size_t group = 4;
+				const auto		 panel = cols * P::width;
+
+				size_t p = 0;
+				for (; p + group <= panels; p += group)
+				{
+					typename P::reg acc[group];
+					for (size_t k = 0; k < group; ++k) acc[k] = P::load(b + (p + k) * P::width);
+
+					const auto *wp = w + p * panel;
+					for (size_t c = 0; c < cols; ++c)
+					{
+						const auto xc = P::set1(x[c]);
+						for (size_t k = 0; k < group; ++k)
+							acc[k] = simd::detail::madd<P>(P::load(wp + k * panel + c * P::width), xc, acc[k]);
+					}
+
+					for (size_t k = 0; k < group; ++k) P::store(y + (p + k) * P::width, F::template pack<P>(acc[k]));
+				}
+
+				for (; p < panels; ++p)
+				{
+					auto		acc = P::load(b + p * P::width);
+					const auto *wp	= w + p * panel;
+					for (size_t c = 0; c < cols; ++c)
+						acc = simd::detail::madd<P>(P::load(wp + c * P::width), P::set1(x[c]), acc);
+
+					P::store(y + p * P::width, F::template pack<P>(acc));
+				}
+			}
+			else
+				for (size_t r = 0; r < panels * PANEL_ROWS; ++r)
+				{
+					const auto *wr = w + r / PANEL_ROWS * cols * PANEL_ROWS + r % PANEL_ROWS;
+
+					auto acc = b[r];
+					for (size_t c = 0; c < cols; ++c) acc += wr[c * PANEL_ROWS] * x[c];
+					y[r] = F{}(acc);
+				}
+		}
 	};
 
 	// -----------------------------------------------------------------------------
@@ -146,10 +711,11 @@ namespace ctl::mcl
 	 * @param nn Neural Network to train on
 	 * @param input Input matrix to fit with
 	 * @param output Output matrix to fit with
-	 * @param learning_rate The learning speed
+	 * @param opt Optimizer applying the gradients
 	 */
-	void fit(BasicNeuralNetwork &nn, const mth::Matrix<double> &input, const mth::Matrix<double> &output,
-			 double learning_rate = 0.1)
+	template<typename Weight, optimizer Opt>
+	void fit(BasicNeuralNetwork<Weight> &nn, const mth::Matrix<double> &input, const mth::Matrix<double> &output,
+			 Opt &opt)
 	{
 		// Feedforward results
 		std::vector<mth::Matrix<double>> feedforward;
@@ -158,8 +724,10 @@ namespace ctl::mcl
 		feedforward.emplace_back(input); // Input is first result
 
 		for (const auto &layer : nn) // Feedforward and store each result
-			feedforward.emplace_back(
-				(layer.weights.dot_product(feedforward.back()) + layer.biases).apply(sigmoid<double>));
+		{
+			auto &a = feedforward.emplace_back(layer.weights.dot_product(feedforward.back()) + layer.biases);
+			activate(layer.activation, a.data(), a.dim().h, a.dim().w);
+		}
 
 		// Loss calculation
 		std::vector<mth::Matrix<double>> loss;
@@ -170,21 +738,430 @@ namespace ctl::mcl
 		for (auto ri = nn.rbegin(); ri != nn.rend(); ++ri) // Create losses using backward weight iteration
 			loss.emplace_back(ri->weights.transpose().dot_product(loss.back()));
 
-		// Calculate delta
+		// Calculate delta into a gradient buffer laid out like the parameters
+		const auto			params = nn.parameters();
+		std::vector<double> grad(params.size());
+
 		for (auto [i_error, i_output, i_layer] = std::tuple{ loss.begin(), feedforward.rbegin(), nn.rbegin() };
 			 i_layer != nn.rend(); ++i_error, ++i_output, ++i_layer)
 		{
-			const auto d_bias	= learning_rate * *i_error * *i_output * (1. - *i_output);
-			const auto d_weight = d_bias.dot_product((i_output + 1)->transpose());
+			const auto h = i_layer->weights.dim().h, w = i_layer->weights.dim().w;
 
-			i_layer->weights += d_weight;
-			i_layer->biases += d_bias;
+			mth::MatrixView<double> d_bias(grad.data() + (i_layer->biases.data() - params.data()), h, 1);
+			mth::MatrixView<double> d_weight(grad.data() + (i_layer->weights.data() - params.data()), h, w);
+
+			d_bias.assign(*i_error);
+			derive(i_layer->activation, i_output->data(), d_bias.data(), h, 1);
+
+			d_weight.assign(d_bias.dot_product((i_output + 1)->view().transpose()));
 		}
+
+		opt.init(0, params.size());
+		opt.step();
+		opt.update(0, params.data(), grad.data(), 0, params.size(), 1.);
+	}
+	/**
+	 * @brief Performs the training method of the given neural network using a input and output matrix
+	 *
+	 * @param nn Neural Network to train on
+	 * @param input Input matrix to fit with
+	 * @param output Output matrix to fit with
+	 * @param learning_rate The learning speed
+	 */
+	template<typename Weight>
+	void fit(BasicNeuralNetwork<Weight> &nn, const mth::Matrix<double> &input, const mth::Matrix<double> &output,
+			 double learning_rate = 0.1)
+	{
+		SGD opt(learning_rate);
+		fit(nn, input, output, opt);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Mini-Batch Training
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Mini-batch gradient descent with the same gradients as fit, averaged over the batch. The columns of a
+	 * batch are split into shards which run forward and backward on their own workspace and gradient buffers; the
+	 * gradients are summed when updating. All buffers are allocated once on construction.
+	 *
+	 * @tparam Weight Weight type of the network
+	 */
+	template<typename Weight = double>
+	class MiniBatchTrainer
+	{
+	public:
+		/**
+		 * @brief Construct a trainer for a network
+		 *
+		 * @param nn Network to train. Must outlive the trainer and keep its structure.
+		 * @param batch_size Largest batch that will be fitted
+		 * @param policy Execution policy the batches will be fitted with. Decides the amount of shards.
+		 */
+		template<exe::execution_policy P = exe::Sequenced>
+		MiniBatchTrainer(BasicNeuralNetwork<Weight> &nn, size_t batch_size, const P &policy = {})
+			: m_nn(&nn)
+			, m_batch(batch_size)
+			, m_shards(std::max<size_t>(1, std::min(exe::concurrency(policy), batch_size)))
+		{
+			const auto cols = (batch_size + m_shards.size() - 1) / m_shards.size();
+
+			for (auto &ws : m_shards)
+			{
+				for (const auto &l : nn)
+				{
+					ws.act.emplace_back(l.weights.dim().h * cols);
+					ws.err.emplace_back(l.weights.dim().h * cols);
+				}
+				ws.grad.resize(nn.parameters().size());
+			}
+		}
+
+		/**
+		 * @brief Performs a gradient descent step on a batch
+		 *
+		 * @param policy Execution policy
+		 * @param input Inputs, one per column
+		 * @param output Expected outputs, one per column
+		 * @param opt Optimizer applying the averaged gradients
+		 */
+		template<exe::execution_policy P, mth::strided_matrix I, mth::strided_matrix O, optimizer Opt>
+		void fit_batch(const P &policy, const I &input, const O &output, Opt &opt)
+		{
+			const auto n = input.dim().w;
+			assert(n == output.dim().w && n <= m_batch && "Batch must fit into the trainer.");
+
+			if (n == 0)
+				return;
+
+			const auto cols = (n + m_shards.size() - 1) / m_shards.size();
+
+			exe::for_blocks(policy, m_shards.size(), cols * _parameters_(), [&](size_t s0, size_t s1) {
+				for (auto s = s0; s < s1; ++s)
+					if (const auto c0 = s * cols; c0 < n)
+						_shard_(m_shards[s], input, output, c0, std::min(n, c0 + cols));
+			});
+
+			_update_(policy, opt, 1. / static_cast<double>(n));
+		}
+		template<mth::strided_matrix I, mth::strided_matrix O, optimizer Opt>
+		void fit_batch(const I &input, const O &output, Opt &opt)
+		{
+			fit_batch(exe::seq, input, output, opt);
+		}
+		/**
+		 * @brief Performs a gradient descent step on a batch with plain SGD
+		 *
+		 * @param policy Execution policy
+		 * @param input Inputs, one per column
+		 * @param output Expected outputs, one per column
+		 * @param learning_rate The learning speed
+		 */
+		template<exe::execution_policy P, mth::strided_matrix I, mth::strided_matrix O>
+		void fit_batch(const P &policy, const I &input, const O &output, double learning_rate = 0.1)
+		{
+			SGD opt(learning_rate);
+			fit_batch(policy, input, output, opt);
+		}
+		template<mth::strided_matrix I, mth::strided_matrix O>
+		void fit_batch(const I &input, const O &output, double learning_rate = 0.1)
+		{
+			fit_batch(exe::seq, input, output, learning_rate);
+		}
+
+		/**
+		 * @brief Fits a whole dataset once in batches of the trainer's batch size, in column order
+		 *
+		 * @param policy Execution policy
+		 * @param inputs Inputs, one per column
+		 * @param outputs Expected outputs, one per column
+		 * @param opt Optimizer applying the averaged gradients
+		 */
+		template<exe::execution_policy P, mth::strided_matrix I, mth::strided_matrix O, optimizer Opt>
+		void fit_epoch(const P &policy, const I &inputs, const O &outputs, Opt &opt)
+		{
+			const auto n = inputs.dim().w;
+			for (size_t c0 = 0; c0 < n; c0 += m_batch)
+			{
+				const auto m = std::min(m_batch, n - c0);
+				fit_batch(policy, inputs.block(0, c0, inputs.dim().h, m), outputs.block(0, c0, outputs.dim().h, m),
+						  opt);
+			}
+		}
+		template<mth::strided_matrix I, mth::strided_matrix O, optimizer Opt>
+		void fit_epoch(const I &inputs, const O &outputs, Opt &opt)
+		{
+			fit_epoch(exe::seq, inputs, outputs, opt);
+		}
+		/**
+		 * @brief Fits a whole dataset once in batches of the trainer's batch size with plain SGD
+		 *
+		 * @param policy Execution policy
+		 * @param inputs Inputs, one per column
+		 * @param outputs Expected outputs, one per column
+		 * @param learning_rate The learning speed
+		 */
+		template<exe::execution_policy P, mth::strided_matrix I, mth::strided_matrix O>
+		void fit_epoch(const P &policy, const I &inputs, const O &outputs, double learning_rate = 0.1)
+		{
+			SGD opt(learning_rate);
+			fit_epoch(policy, inputs, outputs, opt);
+		}
+		template<mth::strided_matrix I, mth::strided_matrix O>
+		void fit_epoch(const I &inputs, const O &outputs, double learning_rate = 0.1)
+		{
+			fit_epoch(exe::seq, inputs, outputs, learning_rate);
+		}
+
+		[[nodiscard]] auto batch_size() const noexcept { return m_batch; }
+		[[nodiscard]] auto shards() const noexcept { return m_shards.size(); }
+
+	private:
+		/**
+		 * @brief Per shard activations and back propagated errors of every layer, and gradient sums laid out like the
+		 * parameters of the network
+		 */
+		struct Workspace
+		{
+			std::vector<std::vector<double>> act, err;
+			std::vector<double>				 grad;
+		};
+
+		BasicNeuralNetwork<Weight> *m_nn;
+		size_t						m_batch;
+		std::vector<Workspace>		m_shards;
+
+		auto _parameters_() const noexcept
+		{
+			size_t n = 0;
+			for (const auto &l : *m_nn) n += l.weights.dim().area();
+			return n;
+		}
+
+		template<typename I, typename O>
+		void _shard_(Workspace &ws, const I &input, const O &output, size_t c0, size_t c1) const
+		{
+			const auto m	  = c1 - c0;
+			const auto layers = _layers_();
+
+			const mth::MatrixView<const double> in = input.block(0, c0, input.dim().h, m);
+
+			// Feedforward
+			auto prev = in;
+			for (size_t l = 0; l < layers; ++l)
+			{
+				const auto &layer = _layer_(l);
+				const auto	h	  = layer.weights.dim().h;
+
+				mth::MatrixView<double> a(ws.act[l].data(), h, m);
+				for (size_t r = 0; r < h; ++r)
+					std::fill_n(a.data() + r * m, m, static_cast<double>(layer.biases.data()[r]));
+
+				mth::detail::strided_product(layer.weights, prev, a);
+				activate(layer.activation, a.data(), h, m);
+
+				prev = mth::MatrixView<const double>(a);
+			}
+
+			// Loss of prediction to output
+			mth::MatrixView<double>(ws.err[layers - 1].data(), prev.dim().h, m) = output.block(0, c0, prev.dim().h, m)
+				- prev;
+
+			// Back propagate the loss and sum up the gradients
+			for (auto l = layers; l-- > 0;)
+			{
+				const auto &layer = _layer_(l);
+				const auto	h = layer.weights.dim().h, w = layer.weights.dim().w;
+
+				const auto *a = ws.act[l].data();
+				const auto	a_prev = l == 0 ? in : mth::MatrixView<const double>(ws.act[l - 1].data(), w, m);
+
+				mth::MatrixView<double> e(ws.err[l].data(), h, m);
+
+				if (l > 0)
+				{
+					mth::MatrixView<double> e_prev(ws.err[l - 1].data(), w, m);
+					e_prev = 0.;
+					mth::detail::strided_product(layer.weights.transpose(), e, e_prev);
+				}
+
+				derive(layer.activation, a, e.data(), h, m);
+
+				mth::MatrixView<double> grad_w(ws.grad.data() + _offset_(layer.weights), h, w);
+				mth::detail::strided_product(e, a_prev.transpose(), grad_w);
+
+				auto *grad_b = ws.grad.data() + _offset_(layer.biases);
+				for (size_t r = 0; r < h; ++r) grad_b[r] += simd::sum(e.data() + r * m, m);
+			}
+		}
+
+		template<typename P, typename Opt>
+		void _update_(const P &policy, Opt &opt, double scale)
+		{
+			const auto params = m_nn->parameters();
+
+			opt.init(0, params.size());
+			opt.step();
+
+			// One sweep over all parameters: sum the shards, update and zero the sums
+			exe::for_blocks(policy, params.size(), m_shards.size(), [&](size_t first, size_t last) {
+				auto *g = m_shards.front().grad.data();
+				for (auto ws = m_shards.begin() + 1; ws < m_shards.end(); ++ws)
+				{
+					simd::transform(g + first, g + first, ws->grad.data() + first, last - first, simd::Add{});
+					std::fill(ws->grad.begin() + first, ws->grad.begin() + last, 0.);
+				}
+
+				opt.update(0, params.data(), g, first, last, scale);
+				std::fill(g + first, g + last, 0.);
+			});
+		}
+
+		/**
+		 * @brief Offset of a matrix of the network in its parameter buffer
+		 */
+		auto _offset_(const mth::MatrixView<Weight> &m) const noexcept -> size_t
+		{
+			return static_cast<size_t>(m.data() - m_nn->parameters().data());
+		}
+
+		auto _layers_() const noexcept -> size_t { return static_cast<size_t>(m_nn->end() - m_nn->begin()); }
+		auto _layer_(size_t l) const noexcept -> const Layer<Weight> & { return *(m_nn->begin() + l); }
+	};
+
+	// -----------------------------------------------------------------------------
+	// Loss
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Loss function of a prediction to its target
+	 */
+	enum class Loss : std::uint8_t
+	{
+		mse,		   ///< Mean of the squared errors over all outputs
+		cross_entropy, ///< Mean over the samples of -sum y * log(p). Expects a probability distribution as output.
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Sum of the loss terms of n predictions to their targets, both contiguous. Cross entropy only takes
+		 * the logarithm of outputs with a non zero target, which is one per sample for one-hot targets.
+		 */
+		inline auto loss_sum(Loss f, const double *pred, const double *target, size_t n) noexcept -> double
+		{
+			static constexpr double min_probability = 1e-12;
+
+			switch (f)
+			{
+			case Loss::mse:
+				return simd::squared_distance(pred, target, n);
+			case Loss::cross_entropy:
+			{
+				double sum = 0.;
+				for (size_t i = 0; i < n; ++i)
+					if (target[i] != 0.)
+						sum -= target[i] * std::log(std::max(pred[i], min_probability));
+				return sum;
+			}
+			}
+
+			return 0.;
+		}
+
+		/**
+		 * @brief Loss of a range of layers over a dataset. The samples are queried in batches of GEMMs, the batches
+		 * are split over the policy and every block of them reuses one set of buffers. The loss of every batch is
+		 * kept apart and summed in order, so the result doesn't depend on the policy.
+		 *
+		 * @param policy Execution policy the batches are split with
+		 * @param layers Layers with strided weights, biases and an activation
+		 * @param inputs Inputs, one per column
+		 * @param outputs Expected outputs, one per column
+		 * @param f Loss function
+		 * @param batch_size Samples per GEMM
+		 * @return Mean loss
+		 */
+		template<typename P, typename Layers, typename I, typename O>
+		auto loss(const P &policy, const Layers &layers, const I &inputs, const O &outputs, Loss f,
+				  size_t batch_size) -> double
+		{
+			const auto n = inputs.dim().w, rows = outputs.dim().h;
+			assert(n == outputs.dim().w && "Every input needs an output.");
+			assert(std::begin(layers) != std::end(layers) && rows == std::prev(std::end(layers))->weights.dim().h
+				   && "Outputs must match the output layer.");
+			assert(batch_size > 0 && "Batches need samples.");
+
+			if (n == 0)
+				return 0.;
+
+			const auto batches = (n + batch_size - 1) / batch_size;
+			const auto hidden  = hidden_neurons(layers);
+
+			size_t work = 0;
+			for (const auto &l : layers) work += l.weights.dim().area();
+
+			std::vector<double> partial(batches);
+
+			exe::for_blocks(policy, batches, batch_size * work, [&](size_t b0, size_t b1) {
+				std::vector<double> ping(hidden * batch_size), pong(hidden * batch_size);
+				std::vector<double> pred(rows * batch_size), target(rows * batch_size);
+
+				for (auto b = b0; b < b1; ++b)
+				{
+					const auto c0 = b * batch_size, m = std::min(batch_size, n - c0);
+
+					mth::MatrixView<double> p(pred.data(), rows, m);
+					feedforward(exe::seq, layers, inputs.block(0, c0, inputs.dim().h, m), ping.data(), pong.data(), p);
+
+					mth::MatrixView<double>(target.data(), rows, m).assign(outputs.block(0, c0, rows, m));
+					partial[b] = loss_sum(f, pred.data(), target.data(), rows * m);
+				}
+			});
+
+			const auto total = simd::sum(partial.data(), partial.size());
+			return total / static_cast<double>(f == Loss::mse ? n * rows : n);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Evaluates the mean loss of the network over a dataset. Samples are queried in batches, each a GEMM per
+	 * layer, and the batches are split over the policy. Nothing is allocated per sample.
+	 *
+	 * @param policy Execution policy
+	 * @param nn Network to evaluate
+	 * @param inputs Inputs, one per column
+	 * @param outputs Expected outputs, one per column
+	 * @param f Loss function
+	 * @param batch_size Samples per GEMM
+	 * @return Mean loss
+	 */
+	template<exe::execution_policy P, typename Weight, mth::strided_matrix I, mth::strided_matrix O>
+	[[nodiscard]] auto loss(const P &policy, const BasicNeuralNetwork<Weight> &nn, const I &inputs, const O &outputs,
+							Loss f = Loss::mse, size_t batch_size = 256) -> double
+	{
+		return detail::loss(policy, nn, inputs, outputs, f, batch_size);
+	}
+	/**
+	 * @brief Evaluates the mean loss of the network over a dataset sequentially
+	 *
+	 * @param nn Network to evaluate
+	 * @param inputs Inputs, one per column
+	 * @param outputs Expected outputs, one per column
+	 * @param f Loss function
+	 * @param batch_size Samples per GEMM
+	 * @return Mean loss
+	 */
+	template<typename Weight, mth::strided_matrix I, mth::strided_matrix O>
+	[[nodiscard]] auto loss(const BasicNeuralNetwork<Weight> &nn, const I &inputs, const O &outputs,
+							Loss f = Loss::mse, size_t batch_size = 256) -> double
+	{
+		return loss(exe::seq, nn, inputs, outputs, f, batch_size);
 	}
 
 	/**
 	 * @brief Calculates the total cost/loss of the network to the given output array using the input array. Input and
-	 * output array length must be the same!
+	 * output array length must be the same! Queries every sample on its own, see loss for evaluating whole datasets.
 	 *
 	 * @param nn Neural Networt to calculate the cost with
 	 * @param input_begin The input array begin address
@@ -192,17 +1169,18 @@ namespace ctl::mcl
 	 * @param output_begin The output array begin address
 	 * @return total cost as a double
 	 */
-	template<typename Iter1, typename Iter2>
-	auto cost(
-		const BasicNeuralNetwork &nn, Iter1 input_begin, Iter1 input_end,
-		Iter2 output_begin) requires std::same_as<mth::Matrix<double>, typename std::iterator_traits<Iter1>::value_type>
-		&&std::same_as<mth::Matrix<double>, typename std::iterator_traits<Iter2>::value_type>
+	template<typename Weight, typename Iter1, typename Iter2>
+	auto cost(const BasicNeuralNetwork<Weight> &nn, Iter1 input_begin, Iter1 input_end, Iter2 output_begin) requires
+		mth::matrix_expression<typename std::iterator_traits<Iter1>::value_type>
+		&&mth::matrix_expression<typename std::iterator_traits<Iter2>::value_type>
 	{
 		auto cost = 0.;
 		for (; input_begin != input_end; ++input_begin, ++output_begin)
 		{
-			const auto pred = nn.query(*input_begin);
-			for (auto v : *output_begin - pred) cost += v * v;
+			const auto				  pred = nn.query(mth::Matrix<double>(*input_begin));
+			const mth::Matrix<double> err  = *output_begin - pred;
+
+			cost += mth::dot(err, err);
 		}
 
 		return cost;
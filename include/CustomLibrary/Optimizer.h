@@ -0,0 +1,266 @@
+#pragma once
+
+#include <cmath>
+#include <concepts>
+#include <vector>
+
+#include "Simd.h"
+
+namespace ctl::mcl
+{
+	// -----------------------------------------------------------------------------
+	// Optimizers
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Update rule of the network parameters. Parameters are addressed by slot; the trainers pass the whole
+	 * contiguous parameter buffer of a network as slot 0. Gradients point in the direction that decreases the loss.
+	 *
+	 * init sizes the state of a slot and is called before training. step starts an update of all slots and update
+	 * applies a range of a slot; different ranges may be updated concurrently.
+	 */
+	template<typename O>
+	concept optimizer = requires(O &o, double *param, const double *grad, size_t n)
+	{
+		o.init(n, n);
+		o.step();
+		o.update(n, param, grad, n, n, 1.);
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Pack interface on a single double, used for the tail of fused updates and for reduced precision
+		 * parameters
+		 */
+		struct ScalarPack
+		{
+			using reg					  = double;
+			static constexpr size_t width = 1;
+
+			template<typename T>
+			static auto load(const T *p) noexcept -> reg
+			{
+				return static_cast<double>(*p);
+			}
+			template<typename T>
+			static void store(T *p, reg a) noexcept
+			{
+				*p = static_cast<T>(a);
+			}
+			static auto set1(double a) noexcept -> reg { return a; }
+			static auto add(reg a, reg b) noexcept -> reg { return a + b; }
+			static auto sub(reg a, reg b) noexcept -> reg { return a - b; }
+			static auto mul(reg a, reg b) noexcept -> reg { return a * b; }
+			static auto div(reg a, reg b) noexcept -> reg { return a / b; }
+			static auto sqrt(reg a) noexcept -> reg { return std::sqrt(a); }
+		};
+
+		/**
+		 * @brief Checks if updates of T parameters can run on the double pack
+		 */
+		template<typename T>
+		concept packed_update = std::same_as<T, double> && requires(typename simd::Pack<T>::reg r)
+		{
+			simd::Pack<T>::sqrt(r);
+		};
+
+		/**
+		 * @brief Runs f.template operator()<P>(i) over [first, last) with P the double pack where the parameters are
+		 * doubles, then with ScalarPack for the rest. Every element is read and written once.
+		 */
+		template<typename T, typename F>
+		void fused_update(size_t first, size_t last, F &&f) noexcept
+		{
+			auto i = first;
+
+			if constexpr (packed_update<T>)
+			{
+				using P = simd::Pack<T>;
+				for (; i + P::width <= last; i += P::width) f.template operator()<P>(i);
+			}
+
+			for (; i < last; ++i) f.template operator()<ScalarPack>(i);
+		}
+
+		/**
+		 * @brief Zeroed state vector of a slot
+		 */
+		inline void init_slot(std::vector<std::vector<double>> &state, size_t slot, size_t n)
+		{
+			if (state.size() <= slot)
+				state.resize(slot + 1);
+			if (state[slot].size() != n)
+				state[slot].assign(n, 0.);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Plain gradient descent: p += lr * g
+	 */
+	class SGD
+	{
+	public:
+		explicit SGD(double learning_rate = 0.1) noexcept
+			: m_lr(learning_rate)
+		{
+		}
+
+		void init(size_t, size_t) noexcept {}
+		void step() noexcept {}
+
+		/**
+		 * @brief Update a range of a slot
+		 *
+		 * @param param Parameters of the slot
+		 * @param grad Gradients of the slot
+		 * @param first First element
+		 * @param last End element
+		 * @param scale Factor of the gradients (e.g. 1 / batch size)
+		 */
+		template<typename T>
+		void update(size_t, T *param, const double *grad, size_t first, size_t last, double scale) const noexcept
+		{
+			detail::fused_update<T>(first, last, [&, lr = m_lr * scale]<typename P>(size_t i) {
+				P::store(param + i, P::add(P::load(param + i), P::mul(P::load(grad + i), P::set1(lr))));
+			});
+		}
+
+		[[nodiscard]] auto learning_rate() const noexcept { return m_lr; }
+
+	private:
+		double m_lr;
+	};
+
+	/**
+	 * @brief Gradient descent with momentum: v = mu * v + lr * g, p += v
+	 */
+	class Momentum
+	{
+	public:
+		explicit Momentum(double learning_rate = 0.01, double momentum = 0.9) noexcept
+			: m_lr(learning_rate)
+			, m_mu(momentum)
+		{
+		}
+
+		void init(size_t slot, size_t n) { detail::init_slot(m_v, slot, n); }
+		void step() noexcept {}
+
+		template<typename T>
+		void update(size_t slot, T *param, const double *grad, size_t first, size_t last, double scale) noexcept
+		{
+			auto *v = m_v[slot].data();
+
+			detail::fused_update<T>(first, last, [&, lr = m_lr * scale]<typename P>(size_t i) {
+				const auto vi = P::add(P::mul(P::load(v + i), P::set1(m_mu)), P::mul(P::load(grad + i), P::set1(lr)));
+				P::store(v + i, vi);
+				P::store(param + i, P::add(P::load(param + i), vi));
+			});
+		}
+
+	private:
+		double							 m_lr, m_mu;
+		std::vector<std::vector<double>> m_v;
+	};
+
+	/**
+	 * @brief RMSProp: s = rho * s + (1 - rho) * g^2, p += lr * g / (sqrt(s) + eps)
+	 */
+	class RMSProp
+	{
+	public:
+		explicit RMSProp(double learning_rate = 0.001, double decay = 0.9, double epsilon = 1e-8) noexcept
+			: m_lr(learning_rate)
+			, m_rho(decay)
+			, m_eps(epsilon)
+		{
+		}
+
+		void init(size_t slot, size_t n) { detail::init_slot(m_s, slot, n); }
+		void step() noexcept {}
+
+		template<typename T>
+		void update(size_t slot, T *param, const double *grad, size_t first, size_t last, double scale) noexcept
+		{
+			auto *s = m_s[slot].data();
+
+			detail::fused_update<T>(first, last, [&]<typename P>(size_t i) {
+				const auto g  = P::mul(P::load(grad + i), P::set1(scale));
+				const auto g2 = P::mul(g, g);
+				const auto si = P::add(P::mul(P::load(s + i), P::set1(m_rho)), P::mul(g2, P::set1(1. - m_rho)));
+				P::store(s + i, si);
+
+				const auto d = P::div(P::mul(g, P::set1(m_lr)), P::add(P::sqrt(si), P::set1(m_eps)));
+				P::store(param + i, P::add(P::load(param + i), d));
+			});
+		}
+
+	private:
+		double							 m_lr, m_rho, m_eps;
+		std::vector<std::vector<double>> m_s;
+	};
+
+	/**
+	 * @brief Adam: bias corrected first and second moment estimates. The corrections are folded into the step size
+	 * and epsilon, so the update is p += lr_t * m / (sqrt(v) + eps_t).
+	 */
+	class Adam
+	{
+	public:
+		explicit Adam(double learning_rate = 0.001, double beta1 = 0.9, double beta2 = 0.999,
+					  double epsilon = 1e-8) noexcept
+			: m_lr(learning_rate)
+			, m_b1(beta1)
+			, m_b2(beta2)
+			, m_eps(epsilon)
+		{
+		}
+
+		void init(size_t slot, size_t n)
+		{
+			detail::init_slot(m_m, slot, n);
+			detail::init_slot(m_v, slot, n);
+		}
+
+		void step() noexcept
+		{
+			++m_t;
+
+			const auto c2 = std::sqrt(1. - std::pow(m_b2, static_cast<double>(m_t)));
+			m_lr_t		  = m_lr * c2 / (1. - std::pow(m_b1, static_cast<double>(m_t)));
+			m_eps_t		  = m_eps * c2;
+		}
+
+		template<typename T>
+		void update(size_t slot, T *param, const double *grad, size_t first, size_t last, double scale) noexcept
+		{
+			auto *m = m_m[slot].data(), *v = m_v[slot].data();
+
+			detail::fused_update<T>(first, last, [&]<typename P>(size_t i) {
+				const auto g  = P::mul(P::load(grad + i), P::set1(scale));
+				const auto mi = P::add(P::mul(P::load(m + i), P::set1(m_b1)), P::mul(g, P::set1(1. - m_b1)));
+				const auto g2 = P::mul(g, g);
+				const auto vi = P::add(P::mul(P::load(v + i), P::set1(m_b2)), P::mul(g2, P::set1(1. - m_b2)));
+				P::store(m + i, mi);
+				P::store(v + i, vi);
+
+				const auto d = P::div(P::mul(mi, P::set1(m_lr_t)), P::add(P::sqrt(vi), P::set1(m_eps_t)));
+				P::store(param + i, P::add(P::load(param + i), d));
+			});
+		}
+
+		/**
+		 * @brief Number of steps taken
+		 * @return Steps
+		 */
+		[[nodiscard]] auto steps() const noexcept { return m_t; }
+
+	private:
+		double							 m_lr, m_b1, m_b2, m_eps;
+		double							 m_lr_t = 0., m_eps_t = 0.;
+		size_t							 m_t	= 0;
+		std::vector<std::vector<double>> m_m, m_v;
+	};
+
+} // namespace ctl::mcl
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "Matrix.h"
+
+namespace ctl::mth
+{
+	// -----------------------------------------------------------------------------
+	// Quantization Parameters
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief How real ranges are mapped onto int8
+	 */
+	enum class QuantScheme
+	{
+		symmetric,	///< Zero point 0, range [-max|x|, max|x|]
+		asymmetric, ///< Range [min, max] mapped onto [-128, 127]
+	};
+
+	/**
+	 * @brief Which elements share a scale and zero point
+	 */
+	enum class QuantGranularity
+	{
+		tensor, ///< One pair for the whole matrix
+		row,	///< One pair per row
+	};
+
+	/**
+	 * @brief Affine mapping between reals and int8. real = scale * (q - zero_point)
+	 */
+	struct QuantParams
+	{
+		double		 scale		= 1.;
+		std::int32_t zero_point = 0;
+
+		/**
+		 * @brief Parameters covering a real range. The range is widened to contain 0 so it stays exactly
+		 * representable.
+		 *
+		 * @param lo Smallest value
+		 * @param hi Largest value
+		 * @param scheme Mapping scheme
+		 * @return Parameters
+		 */
+		static auto from_range(double lo, double hi, QuantScheme scheme) noexcept -> QuantParams
+		{
+			lo = std::min(lo, 0.), hi = std::max(hi, 0.);
+
+			if (scheme == QuantScheme::symmetric)
+			{
+				const auto m = std::max(-lo, hi);
+				return { m > 0. ? m / 127. : 1., 0 };
+			}
+
+			if (hi <= lo)
+				return {};
+
+			const auto scale = (hi - lo) / 255.;
+			return { scale, static_cast<std::int32_t>(std::clamp(std::nearbyint(-128. - lo / scale), -128., 127.)) };
+		}
+
+		/**
+		 * @brief Quantize a real, rounding to nearest and saturating
+		 * @param x Real
+		 * @return Quantized value
+		 */
+		[[nodiscard]] auto quantize(double x) const noexcept -> std::int8_t
+		{
+			return static_cast<std::int8_t>(std::clamp(std::nearbyint(x / scale) + zero_point, -128., 127.));
+		}
+
+		/**
+		 * @brief Real value of a quantized value
+		 * @param q Quantized value
+		 * @return Real
+		 */
+		[[nodiscard]] auto dequantize(std::int8_t q) const noexcept -> double { return scale * (q - zero_point); }
+	};
+
+	namespace detail
+	{
+		/**
+		 * @brief Quantizes n elements into q
+		 * @return Sum of the quantized values
+		 */
+		template<typename T>
+		auto quantize(const T *x, size_t n, QuantParams p, std::int8_t *q) noexcept -> std::int32_t
+		{
+			const auto	 inv = 1. / p.scale, zp = static_cast<double>(p.zero_point);
+			std::int32_t sum = 0;
+
+			for (size_t i = 0; i < n; ++i)
+			{
+				q[i] = static_cast<std::int8_t>(std::clamp(std::nearbyint(x[i] * inv) + zp, -128., 127.));
+				sum += q[i];
+			}
+
+			return sum;
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Calibration
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Records the range of representative data (e.g. the activations of a layer over a calibration set) to
+	 * derive static quantization parameters from
+	 */
+	class Calibrator
+	{
+	public:
+		/**
+		 * @brief Widen the recorded range by the elements of a matrix
+		 * @param e Matrix expression
+		 */
+		template<matrix_expression E>
+		void observe(const E &e)
+		{
+			if (e.dim().area() == 0)
+				return;
+
+			m_lo = std::min(m_lo, static_cast<double>(mth::min(e)));
+			m_hi = std::max(m_hi, static_cast<double>(mth::max(e)));
+		}
+
+		/**
+		 * @brief Check if anything was observed
+		 * @return bool
+		 */
+		[[nodiscard]] auto empty() const noexcept -> bool { return m_lo > m_hi; }
+
+		/**
+		 * @brief Parameters covering the observed range
+		 * @param scheme Mapping scheme
+		 * @return Parameters
+		 */
+		[[nodiscard]] auto params(QuantScheme scheme = QuantScheme::asymmetric) const noexcept -> QuantParams
+		{
+			return empty() ? QuantParams{} : QuantParams::from_range(m_lo, m_hi, scheme);
+		}
+
+		[[nodiscard]] auto lo() const noexcept { return m_lo; }
+		[[nodiscard]] auto hi() const noexcept { return m_hi; }
+
+	private:
+		double m_lo = std::numeric_limits<double>::infinity(), m_hi = -std::numeric_limits<double>::infinity();
+	};
+
+	// -----------------------------------------------------------------------------
+	// Quantized Matrix
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Int8 matrix with a scale and zero point per tensor or per row. Products with real matrices quantize
+	 * the other operand per column, multiply with the int8 GEMM kernel and rescale the int32 results.
+	 */
+	class QuantizedMatrix
+	{
+	public:
+		/**
+		 * @brief Construct a empty quantized matrix
+		 */
+		QuantizedMatrix() = default;
+
+		/**
+		 * @brief Quantize a matrix expression
+		 *
+		 * @param e Matrix expression
+		 * @param scheme Mapping scheme
+		 * @param granularity Elements sharing parameters
+		 */
+		template<matrix_expression E>
+		explicit QuantizedMatrix(const E &e, QuantScheme scheme = QuantScheme::symmetric,
+								 QuantGranularity granularity = QuantGranularity::row)
+			: m_data(e.dim().area())
+			, m_dim(e.dim())
+			, m_granularity(granularity)
+			, m_sums(e.dim().h)
+		{
+			const Matrix<double> src(e);
+
+			if (granularity == QuantGranularity::tensor)
+				m_params.push_back(src.size() == 0 ? QuantParams{}
+												   : QuantParams::from_range(mth::min(src), mth::max(src), scheme));
+			else
+			{
+				m_params.reserve(m_dim.h);
+				for (size_t r = 0; r < m_dim.h; ++r)
+				{
+					const auto *row = src.data() + r * m_dim.w;
+					m_params.push_back(m_dim.w == 0 ? QuantParams{}
+													: QuantParams::from_range(simd::min(row, m_dim.w),
+																			  simd::max(row, m_dim.w), scheme));
+				}
+			}
+
+			for (size_t r = 0; r < m_dim.h; ++r)
+			{
+				const auto first = r * m_dim.w;
+				m_sums[r]		 = detail::quantize(src.data() + first, m_dim.w, params(r), m_data.data() + first);
+			}
+		}
+
+		/**
+		 * @brief Get the dimensions
+		 * @return Dim
+		 */
+		[[nodiscard]] constexpr auto dim() const noexcept -> const auto & { return m_dim; }
+		/**
+		 * @brief Get the quantized elements (row major)
+		 * @return Data
+		 */
+		[[nodiscard]] auto data() const noexcept -> const std::int8_t * { return m_data.data(); }
+		/**
+		 * @brief Get the granularity of the parameters
+		 * @return Granularity
+		 */
+		[[nodiscard]] auto granularity() const noexcept { return m_granularity; }
+		/**
+		 * @brief Get the parameters of a row
+		 * @param r Row index
+		 * @return Parameters
+		 */
+		[[nodiscard]] auto params(size_t r) const noexcept -> const QuantParams &
+		{
+			return m_params[m_granularity == QuantGranularity::tensor ? 0 : r];
+		}
+
+		/**
+		 * @brief Convert back to reals
+		 * @return Matrix
+		 */
+		[[nodiscard]] auto dequantize() const -> Matrix<double>
+		{
+			Matrix<double> m(m_dim.h, m_dim.w, 0.);
+			for (size_t r = 0; r < m_dim.h; ++r)
+				for (size_t c = 0; c < m_dim.w; ++c)
+					m[r * m_dim.w + c] = params(r).dequantize(m_data[r * m_dim.w + c]);
+
+			return m;
+		}
+
+		/**
+		 * @brief Multiply with a real matrix. Every column of it is quantized asymmetrically over its own range.
+		 *
+		 * @param policy Execution policy
+		 * @param x Right operand
+		 * @return Product
+		 */
+		template<exe::execution_policy P, matrix_expression E>
+		[[nodiscard]] auto dot_product(const P &policy, const E &x) const -> Matrix<double>
+		{
+			return _product_(policy, x, [](const double *col, size_t k) {
+				return k == 0 ? QuantParams{}
+							  : QuantParams::from_range(simd::min(col, k), simd::max(col, k), QuantScheme::asymmetric);
+			});
+		}
+		/**
+		 * @brief Multiply with a real matrix quantized with fixed parameters. (e.g. from a Calibrator)
+		 *
+		 * @param policy Execution policy
+		 * @param x Right operand
+		 * @param xp Parameters to quantize x with
+		 * @return Product
+		 */
+		template<exe::execution_policy P, matrix_expression E>
+		[[nodiscard]] auto dot_product(const P &policy, const E &x, QuantParams xp) const -> Matrix<double>
+		{
+			return _product_(policy, x, [xp](const double *, size_t) { return xp; });
+		}
+		template<matrix_expression E>
+		[[nodiscard]] auto dot_product(const E &x) const -> Matrix<double>
+		{
+			return dot_product(exe::seq, x);
+		}
+		template<matrix_expression E>
+		[[nodiscard]] auto dot_product(const E &x, QuantParams xp) const -> Matrix<double>
+		{
+			return dot_product(exe::seq, x, xp);
+		}
+
+	private:
+		std::vector<std::int8_t>  m_data;
+		Dim<size_t>				  m_dim;
+		QuantGranularity		  m_granularity = QuantGranularity::tensor;
+		std::vector<QuantParams>  m_params;
+		std::vector<std::int32_t> m_sums; // Row sums of the quantized values for the zero point corrections
+
+		template<typename P, typename E, typename F>
+		auto _product_(const P &policy, const E &x, F &&col_params) const -> Matrix<double>
+		{
+			assert(m_dim.w == x.dim().h && "Width must be same a height for dot product.");
+
+			const auto m = m_dim.h, n = x.dim().w, k = m_dim.w;
+
+			// Quantize x column by column into the rows of x^T
+			std::vector<std::int8_t>  xt(n * k);
+			std::vector<QuantParams>  xp(n);
+			std::vector<std::int32_t> xs(n);
+			std::vector<double>		  col(k);
+
+			for (size_t j = 0; j < n; ++j)
+			{
+				for (size_t p = 0; p < k; ++p) col[p] = static_cast<double>(x(j, p));
+
+				xp[j] = col_params(col.data(), k);
+				xs[j] = detail::quantize(col.data(), k, xp[j], xt.data() + j * k);
+			}
+
+			std::vector<std::int32_t> acc(m * n);
+			Matrix<double>			  res(m, n, 0.);
+
+			// sum((a - za)(x - zx)) = sum(a x) - zx sum(a) - za sum(x) + k za zx
+			exe::for_blocks(policy, m, n * k, [&](size_t r0, size_t r1) {
+				kernel::gemm_s8(r1 - r0, n, k, m_data.data() + r0 * k, k, xt.data(), k, acc.data() + r0 * n, n);
+
+				for (size_t i = r0; i < r1; ++i)
+				{
+					const auto &pa = params(i);
+					for (size_t j = 0; j < n; ++j)
+					{
+						const auto za = static_cast<double>(pa.zero_point), zx = static_cast<double>(xp[j].zero_point);
+						const auto v  = acc[i * n + j] - zx * m_sums[i] - za * xs[j] + static_cast<double>(k) * za * zx;
+
+						res[i * n + j] = pa.scale * xp[j].scale * v;
+					}
+				}
+			});
+
+			return res;
+		}
+	};
+
+} // namespace ctl::mth
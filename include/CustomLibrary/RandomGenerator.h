@@ -50,6 +50,12 @@ namespace ctl::rnd
 				return static_cast<Type>(std::uniform_int_distribution<>(min, max)(m_gen));
 		}
 
+		/**
+		 * @brief Returns the underlying generator, e.g. for standard distributions
+		 * @return Generator
+		 */
+		constexpr auto generator() noexcept -> G & { return m_gen; }
+
 		// IN PROGRESS
 		// template<typename Iter/*, typename = typename std::enable_if_t<!std::is_same_v<typename std::iterator_traits<Iter>::type_value, void>>*/>
 		// constexpr auto rand_iter(Iter first, const Iter &last) -> Iter
@@ -0,0 +1,1205 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__F16C__)
+#	include <immintrin.h>
+#elif defined(__ARM_NEON)
+#	include <arm_neon.h>
+#endif
+
+#include "Half.h"
+
+namespace ctl::simd
+{
+	// -----------------------------------------------------------------------------
+	// Packs
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Describes the native vector register of a type. The primary template has no register and makes every
+	 * kernel use its scalar loop. Operations missing from a specialization (e.g. integer division) also fall back to
+	 * scalar.
+	 * @tparam T Element type
+	 */
+	template<typename T>
+	struct Pack
+	{
+		static constexpr size_t width = 1;
+	};
+
+#if defined(__AVX512F__)
+	template<>
+	struct Pack<float>
+	{
+		using reg					  = __m512;
+		static constexpr size_t width = 16;
+
+		static auto load(const float *p) noexcept { return _mm512_loadu_ps(p); }
+		static void store(float *p, reg a) noexcept { _mm512_storeu_ps(p, a); }
+		static auto set1(float a) noexcept { return _mm512_set1_ps(a); }
+		static auto add(reg a, reg b) noexcept { return _mm512_add_ps(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm512_sub_ps(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm512_mul_ps(a, b); }
+		static auto div(reg a, reg b) noexcept { return _mm512_div_ps(a, b); }
+		static auto fmadd(reg a, reg b, reg c) noexcept { return _mm512_fmadd_ps(a, b, c); }
+		static auto min(reg a, reg b) noexcept { return _mm512_min_ps(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm512_max_ps(a, b); }
+		static auto round(reg a) noexcept { return _mm512_roundscale_ps(a, _MM_FROUND_TO_NEAREST_INT); }
+		static auto exp2i(reg n) noexcept { return _mm512_scalef_ps(_mm512_set1_ps(1.f), n); }
+		static auto sqrt(reg a) noexcept { return _mm512_sqrt_ps(a); }
+	};
+
+	template<>
+	struct Pack<double>
+	{
+		using reg					  = __m512d;
+		static constexpr size_t width = 8;
+
+		static auto load(const double *p) noexcept { return _mm512_loadu_pd(p); }
+		static void store(double *p, reg a) noexcept { _mm512_storeu_pd(p, a); }
+		static auto set1(double a) noexcept { return _mm512_set1_pd(a); }
+		static auto add(reg a, reg b) noexcept { return _mm512_add_pd(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm512_sub_pd(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm512_mul_pd(a, b); }
+		static auto div(reg a, reg b) noexcept { return _mm512_div_pd(a, b); }
+		static auto fmadd(reg a, reg b, reg c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+		static auto min(reg a, reg b) noexcept { return _mm512_min_pd(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm512_max_pd(a, b); }
+		static auto round(reg a) noexcept { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT); }
+		static auto exp2i(reg n) noexcept { return _mm512_scalef_pd(_mm512_set1_pd(1.), n); }
+		static auto sqrt(reg a) noexcept { return _mm512_sqrt_pd(a); }
+	};
+
+	template<>
+	struct Pack<std::int32_t>
+	{
+		using reg					  = __m512i;
+		static constexpr size_t width = 16;
+
+		static auto load(const std::int32_t *p) noexcept { return _mm512_loadu_si512(p); }
+		static void store(std::int32_t *p, reg a) noexcept { _mm512_storeu_si512(p, a); }
+		static auto set1(std::int32_t a) noexcept { return _mm512_set1_epi32(a); }
+		static auto add(reg a, reg b) noexcept { return _mm512_add_epi32(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm512_sub_epi32(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm512_mullo_epi32(a, b); }
+		static auto min(reg a, reg b) noexcept { return _mm512_min_epi32(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm512_max_epi32(a, b); }
+	};
+
+	template<>
+	struct Pack<std::int64_t>
+	{
+		using reg					  = __m512i;
+		static constexpr size_t width = 8;
+
+		static auto load(const std::int64_t *p) noexcept { return _mm512_loadu_si512(p); }
+		static void store(std::int64_t *p, reg a) noexcept { _mm512_storeu_si512(p, a); }
+		static auto set1(std::int64_t a) noexcept { return _mm512_set1_epi64(a); }
+		static auto add(reg a, reg b) noexcept { return _mm512_add_epi64(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm512_sub_epi64(a, b); }
+		static auto min(reg a, reg b) noexcept { return _mm512_min_epi64(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm512_max_epi64(a, b); }
+#	if defined(__AVX512DQ__)
+		static auto mul(reg a, reg b) noexcept { return _mm512_mullo_epi64(a, b); }
+#	endif
+	};
+#elif defined(__AVX2__)
+	template<>
+	struct Pack<float>
+	{
+		using reg					  = __m256;
+		static constexpr size_t width = 8;
+
+		static auto load(const float *p) noexcept { return _mm256_loadu_ps(p); }
+		static void store(float *p, reg a) noexcept { _mm256_storeu_ps(p, a); }
+		static auto set1(float a) noexcept { return _mm256_set1_ps(a); }
+		static auto add(reg a, reg b) noexcept { return _mm256_add_ps(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm256_sub_ps(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm256_mul_ps(a, b); }
+		static auto div(reg a, reg b) noexcept { return _mm256_div_ps(a, b); }
+		static auto min(reg a, reg b) noexcept { return _mm256_min_ps(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm256_max_ps(a, b); }
+		static auto round(reg a) noexcept { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static auto sqrt(reg a) noexcept { return _mm256_sqrt_ps(a); }
+		static auto exp2i(reg n) noexcept
+		{
+			const auto e = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+			return _mm256_castsi256_ps(_mm256_slli_epi32(e, 23));
+		}
+#	if defined(__FMA__)
+		static auto fmadd(reg a, reg b, reg c) noexcept { return _mm256_fmadd_ps(a, b, c); }
+#	endif
+	};
+
+	template<>
+	struct Pack<double>
+	{
+		using reg					  = __m256d;
+		static constexpr size_t width = 4;
+
+		static auto load(const double *p) noexcept { return _mm256_loadu_pd(p); }
+		static void store(double *p, reg a) noexcept { _mm256_storeu_pd(p, a); }
+		static auto set1(double a) noexcept { return _mm256_set1_pd(a); }
+		static auto add(reg a, reg b) noexcept { return _mm256_add_pd(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm256_sub_pd(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm256_mul_pd(a, b); }
+		static auto div(reg a, reg b) noexcept { return _mm256_div_pd(a, b); }
+		static auto min(reg a, reg b) noexcept { return _mm256_min_pd(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm256_max_pd(a, b); }
+		static auto round(reg a) noexcept { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+		static auto sqrt(reg a) noexcept { return _mm256_sqrt_pd(a); }
+		static auto exp2i(reg n) noexcept
+		{
+			// Adding 1.5 * 2^52 moves the integer into the low mantissa bits
+			const auto i = _mm256_castpd_si256(_mm256_add_pd(n, _mm256_set1_pd(0x1.8p52)));
+			return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(i, _mm256_set1_epi64x(1023)), 52));
+		}
+#	if defined(__FMA__)
+		static auto fmadd(reg a, reg b, reg c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+#	endif
+	};
+
+	template<>
+	struct Pack<std::int32_t>
+	{
+		using reg					  = __m256i;
+		static constexpr size_t width = 8;
+
+		static auto load(const std::int32_t *p) noexcept
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const reg *>(p));
+		}
+		static void store(std::int32_t *p, reg a) noexcept { _mm256_storeu_si256(reinterpret_cast<reg *>(p), a); }
+		static auto set1(std::int32_t a) noexcept { return _mm256_set1_epi32(a); }
+		static auto add(reg a, reg b) noexcept { return _mm256_add_epi32(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm256_sub_epi32(a, b); }
+		static auto mul(reg a, reg b) noexcept { return _mm256_mullo_epi32(a, b); }
+		static auto min(reg a, reg b) noexcept { return _mm256_min_epi32(a, b); }
+		static auto max(reg a, reg b) noexcept { return _mm256_max_epi32(a, b); }
+	};
+
+	template<>
+	struct Pack<std::int64_t>
+	{
+		using reg					  = __m256i;
+		static constexpr size_t width = 4;
+
+		static auto load(const std::int64_t *p) noexcept
+		{
+			return _mm256_loadu_si256(reinterpret_cast<const reg *>(p));
+		}
+		static void store(std::int64_t *p, reg a) noexcept { _mm256_storeu_si256(reinterpret_cast<reg *>(p), a); }
+		static auto set1(std::int64_t a) noexcept { return _mm256_set1_epi64x(a); }
+		static auto add(reg a, reg b) noexcept { return _mm256_add_epi64(a, b); }
+		static auto sub(reg a, reg b) noexcept { return _mm256_sub_epi64(a, b); }
+	};
+#elif defined(__ARM_NEON)
+	template<>
+	struct Pack<float>
+	{
+		using reg					  = float32x4_t;
+		static constexpr size_t width = 4;
+
+		static auto load(const float *p) noexcept { return vld1q_f32(p); }
+		static void store(float *p, reg a) noexcept { vst1q_f32(p, a); }
+		static auto set1(float a) noexcept { return vdupq_n_f32(a); }
+		static auto add(reg a, reg b) noexcept { return vaddq_f32(a, b); }
+		static auto sub(reg a, reg b) noexcept { return vsubq_f32(a, b); }
+		static auto mul(reg a, reg b) noexcept { return vmulq_f32(a, b); }
+		static auto min(reg a, reg b) noexcept { return vminq_f32(a, b); }
+		static auto max(reg a, reg b) noexcept { return vmaxq_f32(a, b); }
+#	if defined(__aarch64__)
+		static auto div(reg a, reg b) noexcept { return vdivq_f32(a, b); }
+		static auto fmadd(reg a, reg b, reg c) noexcept { return vfmaq_f32(c, a, b); }
+		static auto round(reg a) noexcept { return vrndnq_f32(a); }
+		static auto sqrt(reg a) noexcept { return vsqrtq_f32(a); }
+		static auto exp2i(reg n) noexcept
+		{
+			return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23));
+		}
+#	endif
+	};
+
+#	if defined(__aarch64__)
+	template<>
+	struct Pack<double>
+	{
+		using reg					  = float64x2_t;
+		static constexpr size_t width = 2;
+
+		static auto load(const double *p) noexcept { return vld1q_f64(p); }
+		static void store(double *p, reg a) noexcept { vst1q_f64(p, a); }
+		static auto set1(double a) noexcept { return vdupq_n_f64(a); }
+		static auto add(reg a, reg b) noexcept { return vaddq_f64(a, b); }
+		static auto sub(reg a, reg b) noexcept { return vsubq_f64(a, b); }
+		static auto mul(reg a, reg b) noexcept { return vmulq_f64(a, b); }
+		static auto div(reg a, reg b) noexcept { return vdivq_f64(a, b); }
+		static auto min(reg a, reg b) noexcept { return vminq_f64(a, b); }
+		static auto max(reg a, reg b) noexcept { return vmaxq_f64(a, b); }
+		static auto fmadd(reg a, reg b, reg c) noexcept { return vfmaq_f64(c, a, b); }
+		static auto round(reg a) noexcept { return vrndnq_f64(a); }
+		static auto sqrt(reg a) noexcept { return vsqrtq_f64(a); }
+		static auto exp2i(reg n) noexcept
+		{
+			return vreinterpretq_f64_s64(vshlq_n_s64(vaddq_s64(vcvtq_s64_f64(n), vdupq_n_s64(1023)), 52));
+		}
+	};
+#	endif
+
+	template<>
+	struct Pack<std::int32_t>
+	{
+		using reg					  = int32x4_t;
+		static constexpr size_t width = 4;
+
+		static auto load(const std::int32_t *p) noexcept { return vld1q_s32(p); }
+		static void store(std::int32_t *p, reg a) noexcept { vst1q_s32(p, a); }
+		static auto set1(std::int32_t a) noexcept { return vdupq_n_s32(a); }
+		static auto add(reg a, reg b) noexcept { return vaddq_s32(a, b); }
+		static auto sub(reg a, reg b) noexcept { return vsubq_s32(a, b); }
+		static auto mul(reg a, reg b) noexcept { return vmulq_s32(a, b); }
+		static auto min(reg a, reg b) noexcept { return vminq_s32(a, b); }
+		static auto max(reg a, reg b) noexcept { return vmaxq_s32(a, b); }
+	};
+
+	template<>
+	struct Pack<std::int64_t>
+	{
+		using reg					  = int64x2_t;
+		static constexpr size_t width = 2;
+
+		static auto load(const std::int64_t *p) noexcept { return vld1q_s64(p); }
+		static void store(std::int64_t *p, reg a) noexcept { vst1q_s64(p, a); }
+		static auto set1(std::int64_t a) noexcept { return vdupq_n_s64(a); }
+		static auto add(reg a, reg b) noexcept { return vaddq_s64(a, b); }
+		static auto sub(reg a, reg b) noexcept { return vsubq_s64(a, b); }
+	};
+#endif
+
+	// -----------------------------------------------------------------------------
+	// Exponential
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Constants of the vector exp. ln 2 is split so n * ln2_hi is exact, the clamps keep 2^n normal.
+		 * The polynomial approximates (exp(r) - 1 - r) / r^2 on |r| <= ln 2 / 2: Taylor terms for double, the Cephes
+		 * minimax fit for float.
+		 */
+		template<typename T>
+		struct ExpConstants;
+
+		template<>
+		struct ExpConstants<float>
+		{
+			static constexpr float lo = -87.f, hi = 88.f, log2e = 1.44269504f;
+			static constexpr float ln2_hi = 0.693359375f, ln2_lo = -2.12194440e-4f;
+			static constexpr float poly[] = { 1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f,
+											  4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f };
+		};
+
+		template<>
+		struct ExpConstants<double>
+		{
+			static constexpr double lo = -708., hi = 709., log2e = 1.4426950408889634;
+			static constexpr double ln2_hi = 6.93145751953125e-1, ln2_lo = 1.42860682030941723212e-6;
+			static constexpr double poly[] = { 1. / 479001600, 1. / 39916800, 1. / 3628800, 1. / 362880,
+											   1. / 40320,	  1. / 5040,	  1. / 720,		1. / 120,
+											   1. / 24,		  1. / 6,		  1. / 2 };
+		};
+
+		template<typename P>
+		struct pack_value;
+		template<typename T>
+		struct pack_value<Pack<T>>
+		{
+			using type = T;
+		};
+
+		/**
+		 * @brief a * b + c, fused when the pack supports it
+		 */
+		template<typename P, typename R>
+		auto madd(R a, R b, R c) noexcept
+		{
+			if constexpr (requires { P::fmadd(a, b, c); })
+				return P::fmadd(a, b, c);
+			else
+				return P::add(P::mul(a, b), c);
+		}
+
+		/**
+		 * @brief exp of every lane. exp(x) = 2^n * exp(r) with n = round(x / ln 2) and a polynomial for exp(r).
+		 * Accurate to a few ulp; inputs are clamped so results never overflow to infinity or flush to zero.
+		 */
+		template<typename P, typename R>
+		auto exp(R x) noexcept -> R
+		{
+			using C = ExpConstants<typename pack_value<P>::type>;
+
+			x			 = P::min(P::max(x, P::set1(C::lo)), P::set1(C::hi));
+			const auto n = P::round(P::mul(x, P::set1(C::log2e)));
+			const auto r = P::sub(P::sub(x, P::mul(n, P::set1(C::ln2_hi))), P::mul(n, P::set1(C::ln2_lo)));
+
+			auto y = P::set1(C::poly[0]);
+			for (size_t i = 1; i < std::size(C::poly); ++i) y = madd<P>(y, r, P::set1(C::poly[i]));
+			y = madd<P>(y, P::mul(r, r), P::add(r, P::set1(1)));
+
+			return P::mul(y, P::exp2i(n));
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Operations
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Addition usable as scalar functor and on packs
+	 */
+	struct Add
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a + b;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::add(a, b))
+		{
+			return P::add(a, b);
+		}
+	};
+	/**
+	 * @brief Subtraction usable as scalar functor and on packs
+	 */
+	struct Sub
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a - b;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::sub(a, b))
+		{
+			return P::sub(a, b);
+		}
+	};
+	/**
+	 * @brief Multiplication usable as scalar functor and on packs
+	 */
+	struct Mul
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a * b;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::mul(a, b))
+		{
+			return P::mul(a, b);
+		}
+	};
+	/**
+	 * @brief Division usable as scalar functor and on packs
+	 */
+	struct Div
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a / b;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::div(a, b))
+		{
+			return P::div(a, b);
+		}
+	};
+
+	/**
+	 * @brief Minimum usable as scalar functor and on packs
+	 */
+	struct Min
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return b < a ? b : a;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::min(a, b))
+		{
+			return P::min(a, b);
+		}
+	};
+	/**
+	 * @brief Maximum usable as scalar functor and on packs
+	 */
+	struct Max
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a < b ? b : a;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::max(a, b))
+		{
+			return P::max(a, b);
+		}
+	};
+	/**
+	 * @brief Accumulation a + |b| usable as scalar functor and on packs
+	 */
+	struct AddAbs
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a + (b < B(0) ? -b : b);
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::add(a, P::max(b, P::sub(P::set1(0), b))))
+		{
+			return P::add(a, P::max(b, P::sub(P::set1(0), b)));
+		}
+	};
+	/**
+	 * @brief Accumulation a + b * b usable as scalar functor and on packs
+	 */
+	struct AddSquare
+	{
+		template<typename A, typename B>
+		constexpr auto operator()(A a, B b) const noexcept
+		{
+			return a + b * b;
+		}
+		template<typename P, typename R>
+		static auto pack(R a, R b) noexcept -> decltype(P::add(a, P::mul(b, b)))
+		{
+			if constexpr (requires { P::fmadd(b, b, a); })
+				return P::fmadd(b, b, a);
+			else
+				return P::add(a, P::mul(b, b));
+		}
+	};
+
+	/**
+	 * @brief Exponential usable as scalar functor and on packs. The pack version is the polynomial approximation.
+	 */
+	struct Exp
+	{
+		template<typename A>
+		auto operator()(A a) const noexcept
+		{
+			return std::exp(a);
+		}
+		template<typename P, typename R>
+		static auto pack(R a) noexcept -> decltype(P::exp2i(P::round(a)))
+		{
+			return detail::exp<P>(a);
+		}
+	};
+
+	/**
+	 * @brief Checks if Op has a vector implementation for T on the target
+	 */
+	template<typename Op, typename T>
+	concept vectorizable = requires(typename Pack<T>::reg r)
+	{
+		Op::template pack<Pack<T>>(r, r);
+	};
+
+	/**
+	 * @brief Checks if the unary Op has a vector implementation for T on the target
+	 */
+	template<typename Op, typename T>
+	concept vectorizable_unary = requires(typename Pack<T>::reg r)
+	{
+		Op::template pack<Pack<T>>(r);
+	};
+
+	// -----------------------------------------------------------------------------
+	// Kernels
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief dst[i] = op(a[i], b[i]). Runs the vector loop when possible and the scalar loop for the tail or in
+	 * constant evaluation. dst may alias a or b.
+	 *
+	 * @param dst Destination
+	 * @param a Left operand
+	 * @param b Right operand
+	 * @param n Element count
+	 * @param op Operation
+	 */
+	template<typename T, typename Op>
+	constexpr void transform(T *dst, const T *a, const T *b, size_t n, Op op) noexcept
+	{
+		size_t i = 0;
+
+		if constexpr (vectorizable<Op, T>)
+			if (!std::is_constant_evaluated())
+			{
+				using P = Pack<T>;
+				for (; i + P::width <= n; i += P::width)
+					P::store(dst + i, Op::template pack<P>(P::load(a + i), P::load(b + i)));
+			}
+
+		for (; i < n; ++i) dst[i] = op(a[i], b[i]);
+	}
+
+	/**
+	 * @brief dst[i] = op(a[i], s). Same rules as the binary transform.
+	 *
+	 * @param dst Destination
+	 * @param a Left operand
+	 * @param s Scalar right operand
+	 * @param n Element count
+	 * @param op Operation
+	 */
+	template<typename T, typename Op>
+	constexpr void transform(T *dst, const T *a, T s, size_t n, Op op) noexcept
+	{
+		size_t i = 0;
+
+		if constexpr (vectorizable<Op, T>)
+			if (!std::is_constant_evaluated())
+			{
+				using P		 = Pack<T>;
+				const auto v = P::set1(s);
+				for (; i + P::width <= n; i += P::width) P::store(dst + i, Op::template pack<P>(P::load(a + i), v));
+			}
+
+		for (; i < n; ++i) dst[i] = op(a[i], s);
+	}
+
+	/**
+	 * @brief dst[i] = op(s, a[i]). Same rules as the binary transform.
+	 *
+	 * @param dst Destination
+	 * @param s Scalar left operand
+	 * @param a Right operand
+	 * @param n Element count
+	 * @param op Operation
+	 */
+	template<typename T, typename Op>
+	constexpr void transform(T *dst, T s, const T *a, size_t n, Op op) noexcept
+	{
+		size_t i = 0;
+
+		if constexpr (vectorizable<Op, T>)
+			if (!std::is_constant_evaluated())
+			{
+				using P		 = Pack<T>;
+				const auto v = P::set1(s);
+				for (; i + P::width <= n; i += P::width) P::store(dst + i, Op::template pack<P>(v, P::load(a + i)));
+			}
+
+		for (; i < n; ++i) dst[i] = op(s, a[i]);
+	}
+
+	/**
+	 * @brief dst[i] = op(a[i]). Same rules as the binary transform.
+	 *
+	 * @param dst Destination
+	 * @param a Operand
+	 * @param n Element count
+	 * @param op Unary operation
+	 */
+	template<typename T, typename Op>
+	constexpr void transform(T *dst, const T *a, size_t n, Op op) noexcept
+	{
+		size_t i = 0;
+
+		if constexpr (vectorizable_unary<Op, T>)
+			if (!std::is_constant_evaluated())
+			{
+				using P = Pack<T>;
+				for (; i + P::width <= n; i += P::width) P::store(dst + i, Op::template pack<P>(P::load(a + i)));
+			}
+
+		for (; i < n; ++i) dst[i] = op(a[i]);
+	}
+
+	/**
+	 * @brief dst[i] = exp(x[i]) with the vector approximation where available. dst may alias x.
+	 *
+	 * @param dst Destination
+	 * @param x Exponents
+	 * @param n Element count
+	 */
+	template<typename T>
+	void exp(T *dst, const T *x, size_t n) noexcept
+	{
+		transform(dst, x, n, Exp{});
+	}
+
+	/**
+	 * @brief Fused y[i] += alpha * x[i]
+	 *
+	 * @param y Destination and addend
+	 * @param alpha Scale of x
+	 * @param x Scaled operand
+	 * @param n Element count
+	 */
+	template<typename T>
+	constexpr void axpy(T *y, T alpha, const T *x, size_t n) noexcept
+	{
+		size_t i = 0;
+
+		if constexpr (vectorizable<Mul, T> && vectorizable<Add, T>)
+			if (!std::is_constant_evaluated())
+			{
+				using P		 = Pack<T>;
+				const auto a = P::set1(alpha);
+
+				for (; i + P::width <= n; i += P::width)
+					if constexpr (requires { P::fmadd(a, a, a); })
+						P::store(y + i, P::fmadd(a, P::load(x + i), P::load(y + i)));
+					else
+						P::store(y + i, P::add(P::load(y + i), P::mul(a, P::load(x + i))));
+			}
+
+		for (; i < n; ++i) y[i] += alpha * x[i];
+	}
+
+	// -----------------------------------------------------------------------------
+	// Reductions
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		/**
+		 * @brief Length below which floating point sums are accumulated directly. Longer ones are split in halves and
+		 * summed pairwise, keeping the rounding error logarithmic in the length.
+		 */
+		static constexpr size_t PAIRWISE_BLOCK = 1024;
+
+		template<typename T, typename Op>
+		auto horizontal(typename Pack<T>::reg r, Op op) noexcept -> T
+		{
+			T buf[Pack<T>::width];
+			Pack<T>::store(buf, r);
+
+			T res = buf[0];
+			for (size_t i = 1; i < Pack<T>::width; ++i) res = op(res, buf[i]);
+
+			return res;
+		}
+
+		template<typename T, typename F>
+		constexpr auto pairwise(size_t first, size_t n, F &&block) noexcept -> T
+		{
+			if (!std::is_floating_point_v<T> || n <= PAIRWISE_BLOCK)
+				return block(first, n);
+
+			const auto half = n / 2;
+			return pairwise<T>(first, half, block) + pairwise<T>(first + half, n - half, block);
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Folds x into init using 4 independent vector accumulators, which are folded with combine at the end.
+	 * Runs the vector loop when possible and the scalar loop for the tail or in constant evaluation.
+	 *
+	 * @param x Elements
+	 * @param n Element count
+	 * @param init Initial value of every accumulator
+	 * @param op Accumulation. Sig.: T op(T acc, T x);
+	 * @param combine Combination of 2 accumulators. Sig.: T combine(T, T);
+	 * @return Result
+	 */
+	template<typename T, typename Op, typename Combine>
+	constexpr auto reduce(const T *x, size_t n, T init, Op op, Combine combine) noexcept -> T
+	{
+		size_t i   = 0;
+		T	   res = init;
+
+		if constexpr (vectorizable<Op, T> && vectorizable<Combine, T>)
+			if (!std::is_constant_evaluated() && n >= Pack<T>::width)
+			{
+				using P = Pack<T>;
+
+				typename P::reg acc[4] = { P::set1(init), P::set1(init), P::set1(init), P::set1(init) };
+
+				for (; i + 4 * P::width <= n; i += 4 * P::width)
+					for (size_t k = 0; k < 4; ++k) acc[k] = Op::template pack<P>(acc[k], P::load(x + i + k * P::width));
+				for (; i + P::width <= n; i += P::width) acc[0] = Op::template pack<P>(acc[0], P::load(x + i));
+
+				res = detail::horizontal<T>(Combine::template pack<P>(Combine::template pack<P>(acc[0], acc[1]),
+																	  Combine::template pack<P>(acc[2], acc[3])),
+											combine);
+			}
+
+		for (; i < n; ++i) res = op(res, x[i]);
+
+		return res;
+	}
+
+	/**
+	 * @brief Sum of x. Floating point sums are computed pairwise.
+	 *
+	 * @param x Elements
+	 * @param n Element count
+	 * @return Sum
+	 */
+	template<typename T>
+	constexpr auto sum(const T *x, size_t n) noexcept -> T
+	{
+		return detail::pairwise<T>(0, n, [x](size_t i, size_t m) { return reduce(x + i, m, T(0), Add{}, Add{}); });
+	}
+
+	/**
+	 * @brief Sum of the absolute values of x. Floating point sums are computed pairwise.
+	 *
+	 * @param x Elements
+	 * @param n Element count
+	 * @return Sum
+	 */
+	template<typename T>
+	constexpr auto sum_abs(const T *x, size_t n) noexcept -> T
+	{
+		return detail::pairwise<T>(0, n, [x](size_t i, size_t m) { return reduce(x + i, m, T(0), AddAbs{}, Add{}); });
+	}
+
+	/**
+	 * @brief Sum of the squares of x. Floating point sums are computed pairwise.
+	 *
+	 * @param x Elements
+	 * @param n Element count
+	 * @return Sum
+	 */
+	template<typename T>
+	constexpr auto sum_squares(const T *x, size_t n) noexcept -> T
+	{
+		return detail::pairwise<T>(0, n,
+								   [x](size_t i, size_t m) { return reduce(x + i, m, T(0), AddSquare{}, Add{}); });
+	}
+
+	/**
+	 * @brief Dot product of a and b. Floating point sums are computed pairwise.
+	 *
+	 * @param a Left operand
+	 * @param b Right operand
+	 * @param n Element count
+	 * @return Sum of a[i] * b[i]
+	 */
+	template<typename T>
+	constexpr auto dot(const T *a, const T *b, size_t n) noexcept -> T
+	{
+		return detail::pairwise<T>(0, n, [a, b](size_t first, size_t m) {
+			size_t i   = 0;
+			T	   res = 0;
+
+			if constexpr (vectorizable<Mul, T> && vectorizable<Add, T>)
+				if (!std::is_constant_evaluated() && m >= Pack<T>::width)
+				{
+					using P = Pack<T>;
+
+					const auto *x = a + first, *y = b + first;
+					const auto	z = P::set1(T(0));
+
+					typename P::reg acc[4] = { z, z, z, z };
+
+					for (; i + 4 * P::width <= m; i += 4 * P::width)
+						for (size_t k = 0; k < 4; ++k)
+						{
+							const auto xv = P::load(x + i + k * P::width), yv = P::load(y + i + k * P::width);
+
+							if constexpr (requires { P::fmadd(z, z, z); })
+								acc[k] = P::fmadd(xv, yv, acc[k]);
+							else
+								acc[k] = P::add(acc[k], P::mul(xv, yv));
+						}
+					for (; i + P::width <= m; i += P::width)
+						acc[0] = P::add(acc[0], P::mul(P::load(x + i), P::load(y + i)));
+
+					res = detail::horizontal<T>(P::add(P::add(acc[0], acc[1]), P::add(acc[2], acc[3])), Add{});
+				}
+
+			for (; i < m; ++i) res += a[first + i] * b[first + i];
+
+			return res;
+		});
+	}
+
+	/**
+	 * @brief Squared euclidean distance of a and b, with the difference and the square fused into the accumulation.
+	 * Floating point sums are computed pairwise.
+	 *
+	 * @param a Left operand
+	 * @param b Right operand
+	 * @param n Element count
+	 * @return Sum of (a[i] - b[i])^2
+	 */
+	template<typename T>
+	constexpr auto squared_distance(const T *a, const T *b, size_t n) noexcept -> T
+	{
+		return detail::pairwise<T>(0, n, [a, b](size_t first, size_t m) {
+			size_t i   = 0;
+			T	   res = 0;
+
+			if constexpr (vectorizable<Sub, T> && vectorizable<AddSquare, T>)
+				if (!std::is_constant_evaluated() && m >= Pack<T>::width)
+				{
+					using P = Pack<T>;
+
+					const auto *x = a + first, *y = b + first;
+					const auto	z = P::set1(T(0));
+
+					typename P::reg acc[4] = { z, z, z, z };
+
+					for (; i + 4 * P::width <= m; i += 4 * P::width)
+						for (size_t k = 0; k < 4; ++k)
+						{
+							const auto d = P::sub(P::load(x + i + k * P::width), P::load(y + i + k * P::width));
+							acc[k]		 = AddSquare::pack<P>(acc[k], d);
+						}
+					for (; i + P::width <= m; i += P::width)
+						acc[0] = AddSquare::pack<P>(acc[0], P::sub(P::load(x + i), P::load(y + i)));
+
+					res = detail::horizontal<T>(P::add(P::add(acc[0], acc[1]), P::add(acc[2], acc[3])), Add{});
+				}
+
+			for (; i < m; ++i)
+			{
+				const auto d = a[first + i] - b[first + i];
+				res += d * d;
+			}
+
+			return res;
+		});
+	}
+
+	/**
+	 * @brief Exact dot product of signed bytes accumulated in 32 bits. Uses VNNI (u8 x s8 with the bias of b taken
+	 * off again) when available, otherwise bytes are widened to 16 bits and multiplied pairwise with madd.
+	 *
+	 * @param a Left operand
+	 * @param b Right operand
+	 * @param n Element count
+	 * @return Sum of a[i] * b[i]
+	 */
+	inline auto dot_s8(const std::int8_t *a, const std::int8_t *b, size_t n) noexcept -> std::int32_t
+	{
+		size_t		 i	 = 0;
+		std::int32_t res = 0;
+
+#if defined(__AVX512VNNI__) && defined(__AVX512BW__)
+		{
+			// dpbusd wants unsigned bytes: sum((b + 128) * a) - 128 * sum(a)
+			const auto bias = _mm512_set1_epi8(-128), ones = _mm512_set1_epi8(1);
+
+			auto acc = _mm512_setzero_si512(), sum = _mm512_setzero_si512();
+			for (; i + 64 <= n; i += 64)
+			{
+				const auto va = _mm512_loadu_si512(a + i), vb = _mm512_loadu_si512(b + i);
+
+				acc = _mm512_dpbusd_epi32(acc, _mm512_xor_si512(vb, bias), va);
+				sum = _mm512_dpbusd_epi32(sum, ones, va);
+			}
+			res += _mm512_reduce_add_epi32(_mm512_sub_epi32(acc, _mm512_slli_epi32(sum, 7)));
+		}
+#elif defined(__AVX512BW__)
+		{
+			auto acc = _mm512_setzero_si512();
+			for (; i + 32 <= n; i += 32)
+			{
+				const auto va = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(a + i)));
+				const auto vb = _mm512_cvtepi8_epi16(_mm256_loadu_si256((const __m256i *)(b + i)));
+
+				acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+			}
+			res += _mm512_reduce_add_epi32(acc);
+		}
+#endif
+
+#if defined(__AVX2__)
+		{
+			auto acc = _mm256_setzero_si256();
+			for (; i + 16 <= n; i += 16)
+			{
+				const auto va = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(a + i)));
+				const auto vb = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)(b + i)));
+
+				acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+			}
+
+			auto s = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+			s	   = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0b01001110));
+			s	   = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0b10110001));
+			res += _mm_cvtsi128_si32(s);
+		}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+		{
+			auto acc = vdupq_n_s32(0);
+			for (; i + 16 <= n; i += 16)
+			{
+				const auto va = vld1q_s8(a + i), vb = vld1q_s8(b + i);
+#	if defined(__ARM_FEATURE_DOTPROD)
+				acc = vdotq_s32(acc, va, vb);
+#	else
+				acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+				acc = vpadalq_s16(acc, vmull_high_s8(va, vb));
+#	endif
+			}
+			res += vaddvq_s32(acc);
+		}
+#endif
+
+		for (; i < n; ++i) res += std::int32_t(a[i]) * b[i];
+
+		return res;
+	}
+
+	/**
+	 * @brief Smallest element of x
+	 *
+	 * @param x Elements
+	 * @param n Element count. Must not be 0.
+	 * @return Minimum
+	 */
+	template<typename T>
+	constexpr auto min(const T *x, size_t n) noexcept -> T
+	{
+		return reduce(x, n, x[0], Min{}, Min{});
+	}
+
+	/**
+	 * @brief Largest element of x
+	 *
+	 * @param x Elements
+	 * @param n Element count. Must not be 0.
+	 * @return Maximum
+	 */
+	template<typename T>
+	constexpr auto max(const T *x, size_t n) noexcept -> T
+	{
+		return reduce(x, n, x[0], Max{}, Max{});
+	}
+
+	// -----------------------------------------------------------------------------
+	// Conversions
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief dst[i] = static_cast<D>(src[i]). Conversions between float and the reduced precision types run 8 or 16
+	 * elements at a time with F16C, AVX-512 (BF16) or NEON. Everything else and the tail take the scalar loop.
+	 * The AVX-512 BF16 instruction flushes subnormal inputs to zero, the other paths round them to nearest even.
+	 *
+	 * @param dst Destination
+	 * @param src Source
+	 * @param n Element count
+	 */
+	template<typename D, typename S>
+	constexpr void convert(D *dst, const S *src, size_t n) noexcept
+	{
+		size_t i = 0;
+
+		[[maybe_unused]] constexpr bool half_to_float = std::same_as<S, mth::f16> && std::same_as<D, float>;
+		[[maybe_unused]] constexpr bool float_to_half = std::same_as<S, float> && std::same_as<D, mth::f16>;
+		[[maybe_unused]] constexpr bool bf16_to_float = std::same_as<S, mth::bf16> && std::same_as<D, float>;
+		[[maybe_unused]] constexpr bool float_to_bf16 = std::same_as<S, float> && std::same_as<D, mth::bf16>;
+
+		if (!std::is_constant_evaluated())
+		{
+#if defined(__AVX512F__)
+			if constexpr (half_to_float)
+				for (; i + 16 <= n; i += 16)
+					_mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i *)src + i / 16)));
+			else if constexpr (float_to_half)
+				for (; i + 16 <= n; i += 16)
+					_mm256_storeu_si256((__m256i *)dst + i / 16,
+										_mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+			else if constexpr (bf16_to_float)
+				for (; i + 16 <= n; i += 16)
+				{
+					const auto h = _mm256_loadu_si256((const __m256i *)src + i / 16);
+					_mm512_storeu_si512(dst + i, _mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16));
+				}
+			else if constexpr (float_to_bf16)
+				for (; i + 16 <= n; i += 16)
+				{
+					const auto v = _mm512_loadu_ps(src + i);
+#	if defined(__AVX512BF16__)
+					_mm256_storeu_si256((__m256i *)dst + i / 16, std::bit_cast<__m256i>(_mm512_cvtneps_pbh(v)));
+#	else
+					const auto x   = _mm512_castps_si512(v);
+					const auto lsb = _mm512_and_si512(_mm512_srli_epi32(x, 16), _mm512_set1_epi32(1));
+					auto	   r   = _mm512_add_epi32(x, _mm512_add_epi32(_mm512_set1_epi32(0x7fff), lsb));
+					r = _mm512_mask_mov_epi32(r, _mm512_cmp_ps_mask(v, v, _CMP_UNORD_Q),
+											  _mm512_or_si512(x, _mm512_set1_epi32(0x400000)));
+					_mm256_storeu_si256((__m256i *)dst + i / 16, _mm512_cvtepi32_epi16(_mm512_srli_epi32(r, 16)));
+#	endif
+				}
+#endif
+
+#if defined(__F16C__)
+			if constexpr (half_to_float)
+				for (; i + 8 <= n; i += 8)
+					_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(src + i))));
+			else if constexpr (float_to_half)
+				for (; i + 8 <= n; i += 8)
+					_mm_storeu_si128((__m128i *)(dst + i),
+									 _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+
+#if defined(__AVX2__)
+			if constexpr (bf16_to_float)
+				for (; i + 8 <= n; i += 8)
+					_mm256_storeu_si256(
+						(__m256i *)(dst + i),
+						_mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(src + i))), 16));
+			else if constexpr (float_to_bf16)
+				for (; i + 8 <= n; i += 8)
+				{
+					// Round to nearest even on the integer bits, keep NaNs quiet, narrow to 16 bits
+					const auto v   = _mm256_loadu_ps(src + i);
+					const auto x   = _mm256_castps_si256(v);
+					const auto lsb = _mm256_and_si256(_mm256_srli_epi32(x, 16), _mm256_set1_epi32(1));
+					auto	   r   = _mm256_add_epi32(x, _mm256_add_epi32(_mm256_set1_epi32(0x7fff), lsb));
+					r = _mm256_blendv_epi8(r, _mm256_or_si256(x, _mm256_set1_epi32(0x400000)),
+										   _mm256_castps_si256(_mm256_cmp_ps(v, v, _CMP_UNORD_Q)));
+					r = _mm256_srli_epi32(r, 16);
+					r = _mm256_permute4x64_epi64(_mm256_packus_epi32(r, r), 0b1000);
+					_mm_storeu_si128((__m128i *)(dst + i), _mm256_castsi256_si128(r));
+				}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+			if constexpr (half_to_float)
+				for (; i + 4 <= n; i += 4)
+					vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16((const std::uint16_t *)(src + i)))));
+			else if constexpr (float_to_half)
+				for (; i + 4 <= n; i += 4)
+					vst1_u16((std::uint16_t *)(dst + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+			else if constexpr (bf16_to_float)
+				for (; i + 4 <= n; i += 4)
+					vst1q_u32((std::uint32_t *)(dst + i), vshll_n_u16(vld1_u16((const std::uint16_t *)(src + i)), 16));
+			else if constexpr (float_to_bf16)
+				for (; i + 4 <= n; i += 4)
+				{
+					const auto v   = vld1q_f32(src + i);
+					const auto x   = vreinterpretq_u32_f32(v);
+					const auto lsb = vandq_u32(vshrq_n_u32(x, 16), vdupq_n_u32(1));
+					const auto r   = vaddq_u32(x, vaddq_u32(vdupq_n_u32(0x7fff), lsb));
+					vst1_u16((std::uint16_t *)(dst + i),
+							 vshrn_n_u32(vbslq_u32(vceqq_f32(v, v), r, vorrq_u32(x, vdupq_n_u32(0x400000))), 16));
+				}
+#endif
+		}
+
+		for (; i < n; ++i) dst[i] = static_cast<D>(src[i]);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Register Transposes
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Side length of the square tile transposed in registers by transpose_tile. Only depends on the size of the
+	 * element since the bits are just moved around. 1 means there is no register transpose.
+	 * @tparam T Element type
+	 */
+	template<typename T>
+	constexpr size_t tile_size = [] {
+#if defined(__AVX512F__) || defined(__AVX2__)
+		if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 4)
+			return 8;
+		else if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 8)
+			return 4;
+#elif defined(__ARM_NEON)
+		if constexpr (std::is_trivially_copyable_v<T> && sizeof(T) == 4)
+			return 4;
+#endif
+		return 1;
+	}();
+
+	namespace detail
+	{
+#if defined(__AVX512F__) || defined(__AVX2__)
+		inline void transpose_8x8(const float *src, size_t rss, float *dst, size_t rsd) noexcept
+		{
+			__m256 r[8], t[8];
+
+			for (size_t i = 0; i < 8; ++i) r[i] = _mm256_loadu_ps(src + i * rss);
+
+			for (size_t i = 0; i < 8; i += 2)
+			{
+				t[i]	 = _mm256_unpacklo_ps(r[i], r[i + 1]);
+				t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+			}
+
+			for (size_t i = 0; i < 8; i += 4)
+			{
+				r[i]	 = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+				r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+				r[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+				r[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+			}
+
+			for (size_t i = 0; i < 4; ++i)
+			{
+				_mm256_storeu_ps(dst + i * rsd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+				_mm256_storeu_ps(dst + (i + 4) * rsd, _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+			}
+		}
+
+		inline void transpose_4x4(const double *src, size_t rss, double *dst, size_t rsd) noexcept
+		{
+			const auto r0 = _mm256_loadu_pd(src), r1 = _mm256_loadu_pd(src + rss);
+			const auto r2 = _mm256_loadu_pd(src + 2 * rss), r3 = _mm256_loadu_pd(src + 3 * rss);
+
+			const auto t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+			const auto t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+
+			_mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+			_mm256_storeu_pd(dst + rsd, _mm256_permute2f128_pd(t1, t3, 0x20));
+			_mm256_storeu_pd(dst + 2 * rsd, _mm256_permute2f128_pd(t0, t2, 0x31));
+			_mm256_storeu_pd(dst + 3 * rsd, _mm256_permute2f128_pd(t1, t3, 0x31));
+		}
+#elif defined(__ARM_NEON)
+		inline void transpose_4x4(const float *src, size_t rss, float *dst, size_t rsd) noexcept
+		{
+			const auto p01 = vtrnq_f32(vld1q_f32(src), vld1q_f32(src + rss));
+			const auto p23 = vtrnq_f32(vld1q_f32(src + 2 * rss), vld1q_f32(src + 3 * rss));
+
+			vst1q_f32(dst, vcombine_f32(vget_low_f32(p01.val[0]), vget_low_f32(p23.val[0])));
+			vst1q_f32(dst + rsd, vcombine_f32(vget_low_f32(p01.val[1]), vget_low_f32(p23.val[1])));
+			vst1q_f32(dst + 2 * rsd, vcombine_f32(vget_high_f32(p01.val[0]), vget_high_f32(p23.val[0])));
+			vst1q_f32(dst + 3 * rsd, vcombine_f32(vget_high_f32(p01.val[1]), vget_high_f32(p23.val[1])));
+		}
+#endif
+	} // namespace detail
+
+	/**
+	 * @brief Transposes a tile_size<T> square tile in registers. dst must not overlap src.
+	 *
+	 * @param src Upper left of the source tile
+	 * @param rss Source row stride
+	 * @param dst Upper left of the destination tile
+	 * @param rsd Destination row stride
+	 */
+	template<typename T>
+	void transpose_tile(const T *src, size_t rss, T *dst, size_t rsd) noexcept requires(tile_size<T> > 1)
+	{
+#if defined(__AVX512F__) || defined(__AVX2__)
+		if constexpr (sizeof(T) == 4)
+			detail::transpose_8x8(reinterpret_cast<const float *>(src), rss, reinterpret_cast<float *>(dst), rsd);
+		else
+			detail::transpose_4x4(reinterpret_cast<const double *>(src), rss, reinterpret_cast<double *>(dst), rsd);
+#elif defined(__ARM_NEON)
+		detail::transpose_4x4(reinterpret_cast<const float *>(src), rss, reinterpret_cast<float *>(dst), rsd);
+#endif
+	}
+
+} // namespace ctl::simd
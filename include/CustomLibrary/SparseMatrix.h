@@ -0,0 +1,580 @@
+#ifndef _CTL_SPARSE_MATRIX_
+#define _CTL_SPARSE_MATRIX_
+
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <algorithm>
+
+#include "Matrix.h"
+
+namespace ctl::mth
+{
+	// -----------------------------------------------------------------------------
+	// Sparse Matrix Implementation
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Storage order of a sparse matrix
+	 */
+	enum class SparseFormat
+	{
+		csr, // Compressed rows
+		csc	 // Compressed columns
+	};
+
+	/**
+	 * @brief Single element used to build sparse matrices
+	 */
+	template<arithmetic Type>
+	struct Triplet
+	{
+		size_t row, col;
+		Type   value;
+	};
+
+	/**
+	 * @brief Compressed sparse matrix. Only nonzeros are stored, sorted by their inner index inside each outer slice
+	 * (rows for CSR, columns for CSC). Memory and multiplication time scale with the nonzeros. It is a matrix
+	 * expression so it converts into a dense Matrix and mixes with dense expressions.
+	 *
+	 * @tparam Type Element type
+	 * @tparam F Storage order
+	 * @tparam Allocator Allocator of the values. The index arrays use it rebound.
+	 */
+	template<arithmetic Type, SparseFormat F, typename Allocator = std::allocator<Type>>
+	class SparseMatrix
+	{
+		template<arithmetic, SparseFormat, typename>
+		friend class SparseMatrix;
+
+		template<typename T>
+		using rebind_t = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+	public:
+		using value_type	 = Type;
+		using allocator_type = Allocator;
+		using index_type	 = std::uint32_t;
+
+		static constexpr SparseFormat format = F;
+
+		/**
+		 * @brief Construct a empty sparse matrix
+		 */
+		SparseMatrix() = default;
+		/**
+		 * @brief Construct a all zero sparse matrix
+		 *
+		 * @param r Rows
+		 * @param c Columns
+		 * @param alloc Allocator
+		 */
+		SparseMatrix(size_t r, size_t c, const Allocator &alloc = Allocator())
+			: m_dim{ c, r }
+			, m_outer(_outer_n_() + 1, 0, alloc)
+			, m_inner(alloc)
+			, m_values(alloc)
+		{
+		}
+		/**
+		 * @brief Construct from unordered elements. Duplicates are summed.
+		 *
+		 * @param r Rows
+		 * @param c Columns
+		 * @param elements Elements
+		 * @param alloc Allocator
+		 */
+		SparseMatrix(size_t r, size_t c, std::span<const Triplet<Type>> elements, const Allocator &alloc = Allocator())
+			: SparseMatrix(r, c, alloc)
+		{
+			for (const auto &t : elements)
+			{
+				assert(t.row < r && t.col < c && "Element lies outside of the matrix.");
+				++m_outer[_outer_(t.col, t.row) + 1];
+			}
+
+			for (size_t i = 0; i < _outer_n_(); ++i) m_outer[i + 1] += m_outer[i];
+
+			m_inner.resize(elements.size());
+			m_values.resize(elements.size());
+
+			std::vector<size_t, rebind_t<size_t>> pos(m_outer.begin(), m_outer.end() - 1, alloc);
+			for (const auto &t : elements)
+			{
+				const auto p = pos[_outer_(t.col, t.row)]++;
+				m_inner[p]	 = static_cast<index_type>(_inner_(t.col, t.row));
+				m_values[p]	 = t.value;
+			}
+
+			_sort_and_merge_();
+		}
+		/**
+		 * @brief Compress a dense matrix or expression. Zeros are dropped.
+		 *
+		 * @param e Expression
+		 * @param alloc Allocator
+		 */
+		template<matrix_expression E>
+		explicit SparseMatrix(const E &e, const Allocator &alloc = Allocator())
+			: SparseMatrix(e.dim().h, e.dim().w, alloc)
+		{
+			for (size_t o = 0; o < _outer_n_(); ++o)
+			{
+				for (size_t i = 0; i < _inner_n_(); ++i)
+				{
+					const auto v = static_cast<Type>(F == SparseFormat::csr ? e(i, o) : e(o, i));
+					if (v != Type(0))
+					{
+						m_inner.push_back(static_cast<index_type>(i));
+						m_values.push_back(v);
+					}
+				}
+
+				m_outer[o + 1] = m_values.size();
+			}
+		}
+		/**
+		 * @brief Convert from the other storage order
+		 * @param m Sparse matrix
+		 */
+		template<SparseFormat F2>
+		explicit SparseMatrix(const SparseMatrix<Type, F2, Allocator> &m) requires(F2 != F)
+			: SparseMatrix(m.m_dim.h, m.m_dim.w, m.get_allocator())
+		{
+			// The arrays of a CSR matrix are the CSC arrays of its transpose and vice versa
+			_transposed_from_(m.m_outer, m.m_inner, m.m_values);
+		}
+
+		/**
+		 * @brief Get a element. Searches the compressed slice.
+		 *
+		 * @param c column
+		 * @param r row
+		 * @return Value or zero
+		 */
+		auto operator()(size_t c, size_t r) const noexcept -> Type
+		{
+			assert(c < m_dim.w && r < m_dim.h);
+
+			const auto o	 = _outer_(c, r);
+			const auto first = m_inner.begin() + m_outer[o], last = m_inner.begin() + m_outer[o + 1];
+			const auto it	 = std::lower_bound(first, last, static_cast<index_type>(_inner_(c, r)));
+
+			return it != last && *it == _inner_(c, r) ? m_values[it - m_inner.begin()] : Type(0);
+		}
+
+		/**
+		 * @brief Get the dimensions of the matrix
+		 * @return Dim
+		 */
+		[[nodiscard]] auto dim() const noexcept -> const Dim<size_t> & { return m_dim; }
+		/**
+		 * @brief Gets the total size of the matrix (including zeros)
+		 * @return size
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_dim.area(); }
+		/**
+		 * @brief Gets the amount of stored elements
+		 * @return Nonzeros
+		 */
+		[[nodiscard]] auto nnz() const noexcept -> size_t { return m_values.size(); }
+
+		/**
+		 * @brief Get the slice offsets. Slice i spans [outer()[i], outer()[i + 1]).
+		 * @return Offsets
+		 */
+		[[nodiscard]] auto outer() const noexcept -> std::span<const size_t> { return m_outer; }
+		/**
+		 * @brief Get the inner index (column for CSR, row for CSC) of every stored element
+		 * @return Indices
+		 */
+		[[nodiscard]] auto inner() const noexcept -> std::span<const index_type> { return m_inner; }
+		/**
+		 * @brief Get the stored elements
+		 * @return Values
+		 */
+		[[nodiscard]] auto values() const noexcept -> std::span<const Type> { return m_values; }
+		/**
+		 * @brief Get the stored elements
+		 * @return Values
+		 */
+		[[nodiscard]] auto values() noexcept -> std::span<Type> { return m_values; }
+
+		/**
+		 * @brief Get the allocator of the matrix
+		 * @return Allocator
+		 */
+		[[nodiscard]] auto get_allocator() const noexcept -> Allocator { return m_values.get_allocator(); }
+
+		/**
+		 * @brief Expand into a dense matrix
+		 * @return Matrix
+		 */
+		auto to_dense() const -> Matrix<Type, Allocator>
+		{
+			Matrix<Type, Allocator> mat(m_dim.h, m_dim.w, Type(0), get_allocator());
+
+			for (size_t o = 0; o < _outer_n_(); ++o)
+				for (auto p = m_outer[o]; p < m_outer[o + 1]; ++p)
+					if constexpr (F == SparseFormat::csr)
+						mat(m_inner[p], o) = m_values[p];
+					else
+						mat(o, m_inner[p]) = m_values[p];
+
+			return mat;
+		}
+
+		/**
+		 * @brief Multiply with a dense matrix or vector (SpMM / SpMV). CSR splits the rows of the result, CSC its
+		 * columns according to the execution policy.
+		 *
+		 * @param policy Execution policy
+		 * @param mat2 Dense matrix or view
+		 * @return Dense result
+		 */
+		template<exe::execution_policy P, strided_matrix M>
+		auto dot_product(const P &policy, const M &mat2) const
+		{
+			assert(m_dim.w == mat2.dim().h && "Width must be same a height for dot product.");
+
+			using T = std::common_type_t<typename M::value_type, Type>;
+
+			const auto n   = mat2.dim().w;
+			const auto rsb = mat2.row_stride(), csb = mat2.col_stride();
+			const auto *b  = mat2.data();
+
+			Matrix<T, rebind_t<T>> mat(m_dim.h, n, T(0), rebind_t<T>(get_allocator()));
+			auto				  *c = mat.data();
+
+			// c[r, j0:j1] += v * b[k, j0:j1]
+			const auto row_axpy = [&](size_t r, size_t k, Type v, size_t j0, size_t j1) {
+				if constexpr (std::same_as<T, Type> && std::same_as<std::remove_const_t<typename M::value_type>, T>)
+					if (csb == 1)
+						return simd::axpy(c + r * n + j0, v, b + k * rsb + j0, j1 - j0);
+
+				for (auto j = j0; j < j1; ++j) c[r * n + j] += static_cast<T>(v) * static_cast<T>(b[k * rsb + j * csb]);
+			};
+
+			if constexpr (F == SparseFormat::csr)
+				exe::for_blocks(policy, m_dim.h, std::max<size_t>(nnz() / std::max<size_t>(m_dim.h, 1), 1) * n,
+								[&](size_t r0, size_t r1) {
+									for (auto r = r0; r < r1; ++r)
+										for (auto p = m_outer[r]; p < m_outer[r + 1]; ++p)
+											row_axpy(r, m_inner[p], m_values[p], 0, n);
+								});
+			else // Rows of the result are scattered into, so the columns are split up
+				exe::for_blocks(policy, n, nnz(), [&](size_t j0, size_t j1) {
+					for (size_t k = 0; k < m_dim.w; ++k)
+						for (auto p = m_outer[k]; p < m_outer[k + 1]; ++p) row_axpy(m_inner[p], k, m_values[p], j0, j1);
+				});
+
+			return mat;
+		}
+		/**
+		 * @brief Multiply with a dense matrix or vector (SpMM / SpMV) on the calling thread
+		 * @param mat2 Dense matrix or view
+		 * @return Dense result
+		 */
+		template<strided_matrix M>
+		auto dot_product(const M &mat2) const
+		{
+			return dot_product(exe::seq, mat2);
+		}
+
+		/**
+		 * @brief Transpose into a new sparse matrix of the same storage order
+		 * @return Transposed matrix
+		 */
+		auto transpose() const -> SparseMatrix
+		{
+			// Transposing and switching the format at the same time keeps the arrays as they are
+			const SparseMatrix<Type, _other_format_(), Allocator> t(Dim<size_t>{ m_dim.h, m_dim.w }, m_outer, m_inner,
+																	m_values);
+
+			return SparseMatrix(t);
+		}
+
+		/**
+		 * @brief Apply a function onto the stored elements
+		 * @param func Unary function
+		 */
+		template<typename Func>
+		auto apply(Func func) -> auto &
+		{
+			std::transform(m_values.begin(), m_values.end(), m_values.begin(), std::move(func));
+			return *this;
+		}
+
+		/**
+		 * @brief Remove stored elements that became zero
+		 * @return auto&
+		 */
+		auto prune() -> auto &
+		{
+			size_t w = 0;
+
+			for (size_t o = 0, p = 0; o < _outer_n_(); ++o)
+			{
+				for (; p < m_outer[o + 1]; ++p)
+					if (m_values[p] != Type(0))
+					{
+						m_inner[w]	= m_inner[p];
+						m_values[w] = m_values[p];
+						++w;
+					}
+
+				m_outer[o + 1] = w;
+			}
+
+			m_inner.resize(w);
+			m_values.resize(w);
+
+			return *this;
+		}
+
+		/**
+		 * @brief Multiply the stored elements with a scalar
+		 * @param s Scalar
+		 */
+		auto operator*=(Type s) noexcept -> auto &
+		{
+			simd::transform(m_values.data(), m_values.data(), s, m_values.size(), simd::Mul{});
+			return *this;
+		}
+		/**
+		 * @brief Divide the stored elements by a scalar
+		 * @param s Scalar
+		 */
+		auto operator/=(Type s) noexcept -> auto &
+		{
+			simd::transform(m_values.data(), m_values.data(), s, m_values.size(), simd::Div{});
+			return *this;
+		}
+
+		/**
+		 * @brief Combine the stored elements with the elements of a dense expression at the same positions. Elements
+		 * outside of the pattern are not touched.
+		 *
+		 * @param e Dense expression of the same dimension
+		 * @param op Binary operation
+		 */
+		template<matrix_expression E, typename Op>
+		auto combine(const E &e, Op op) -> auto &
+		{
+			_ELEMENT_WISE_CHECK_(m_dim, e.dim());
+
+			for (size_t o = 0; o < _outer_n_(); ++o)
+				for (auto p = m_outer[o]; p < m_outer[o + 1]; ++p)
+					m_values[p] = static_cast<Type>(F == SparseFormat::csr ? op(m_values[p], e(m_inner[p], o))
+																		   : op(m_values[p], e(o, m_inner[p])));
+
+			return *this;
+		}
+
+		/**
+		 * @brief Elementwise combination of 2 sparse matrices over the union of their patterns
+		 *
+		 * @param m Other sparse matrix of the same dimension
+		 * @param op Binary operation
+		 * @return Result
+		 */
+		template<typename Op>
+		auto merge(const SparseMatrix &m, Op op) const -> SparseMatrix
+		{
+			_ELEMENT_WISE_CHECK_(m_dim, m.m_dim);
+
+			SparseMatrix res(m_dim.h, m_dim.w, get_allocator());
+			res.m_inner.reserve(nnz() + m.nnz());
+			res.m_values.reserve(nnz() + m.nnz());
+
+			for (size_t o = 0; o < _outer_n_(); ++o)
+			{
+				auto p1 = m_outer[o], p2 = m.m_outer[o];
+				const auto e1 = m_outer[o + 1], e2 = m.m_outer[o + 1];
+
+				while (p1 < e1 || p2 < e2)
+				{
+					const auto i1 = p1 < e1 ? m_inner[p1] : ~index_type(0);
+					const auto i2 = p2 < e2 ? m.m_inner[p2] : ~index_type(0);
+
+					res.m_inner.push_back(std::min(i1, i2));
+					res.m_values.push_back(static_cast<Type>(op(i1 <= i2 ? m_values[p1] : Type(0),
+																i2 <= i1 ? m.m_values[p2] : Type(0))));
+
+					p1 += i1 <= i2;
+					p2 += i2 <= i1;
+				}
+
+				res.m_outer[o + 1] = res.m_values.size();
+			}
+
+			return res;
+		}
+
+	private:
+		Dim<size_t> m_dim = { 0, 0 };
+
+		std::vector<size_t, rebind_t<size_t>>			m_outer = std::vector<size_t, rebind_t<size_t>>(1, 0);
+		std::vector<index_type, rebind_t<index_type>> m_inner;
+		std::vector<Type, Allocator>					m_values;
+
+		static constexpr auto _other_format_() noexcept
+		{
+			return F == SparseFormat::csr ? SparseFormat::csc : SparseFormat::csr;
+		}
+
+		auto _outer_n_() const noexcept -> size_t { return F == SparseFormat::csr ? m_dim.h : m_dim.w; }
+		auto _inner_n_() const noexcept -> size_t { return F == SparseFormat::csr ? m_dim.w : m_dim.h; }
+
+		static constexpr auto _outer_(size_t c, size_t r) noexcept -> size_t { return F == SparseFormat::csr ? r : c; }
+		static constexpr auto _inner_(size_t c, size_t r) noexcept -> size_t { return F == SparseFormat::csr ? c : r; }
+
+		template<typename O, typename I, typename V>
+		SparseMatrix(Dim<size_t> dim, O &&outer, I &&inner, V &&values)
+			: m_dim(dim)
+			, m_outer(std::forward<O>(outer))
+			, m_inner(std::forward<I>(inner))
+			, m_values(std::forward<V>(values))
+		{
+		}
+
+		/**
+		 * @brief Fills the arrays by transposing compressed arrays with swapped outer and inner dimension. Counting
+		 * sort by the inner index keeps the new slices sorted.
+		 */
+		template<typename O, typename I, typename V>
+		void _transposed_from_(const O &outer, const I &inner, const V &values)
+		{
+			m_inner.resize(values.size());
+			m_values.resize(values.size());
+
+			for (auto i : inner) ++m_outer[i + 1];
+			for (size_t i = 0; i < _outer_n_(); ++i) m_outer[i + 1] += m_outer[i];
+
+			std::vector<size_t, rebind_t<size_t>> pos(m_outer.begin(), m_outer.end() - 1, get_allocator());
+			for (size_t o = 0; o + 1 < outer.size(); ++o)
+				for (auto p = outer[o]; p < outer[o + 1]; ++p)
+				{
+					const auto q = pos[inner[p]]++;
+					m_inner[q]	 = static_cast<index_type>(o);
+					m_values[q]	 = values[p];
+				}
+		}
+
+		/**
+		 * @brief Sorts every slice by inner index and sums duplicates
+		 */
+		void _sort_and_merge_()
+		{
+			std::vector<std::pair<index_type, Type>> slice;
+			size_t									 w = 0;
+
+			for (size_t o = 0, p = 0; o < _outer_n_(); ++o)
+			{
+				slice.clear();
+				for (; p < m_outer[o + 1]; ++p) slice.emplace_back(m_inner[p], m_values[p]);
+
+				std::sort(slice.begin(), slice.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+				for (size_t i = 0; i < slice.size(); ++i)
+					if (i > 0 && slice[i].first == slice[i - 1].first)
+						m_values[w - 1] += slice[i].second;
+					else
+					{
+						m_inner[w]	= slice[i].first;
+						m_values[w] = slice[i].second;
+						++w;
+					}
+
+				m_outer[o + 1] = w;
+			}
+
+			m_inner.resize(w);
+			m_values.resize(w);
+		}
+	};
+
+	template<arithmetic Type, typename Allocator = std::allocator<Type>>
+	using CSRMatrix = SparseMatrix<Type, SparseFormat::csr, Allocator>;
+
+	template<arithmetic Type, typename Allocator = std::allocator<Type>>
+	using CSCMatrix = SparseMatrix<Type, SparseFormat::csc, Allocator>;
+
+	// -----------------------------------------------------------------------------
+	// Arithmitic Overloads
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		template<typename T>
+		struct is_sparse_matrix : std::false_type
+		{
+		};
+
+		template<typename T, SparseFormat F, typename A>
+		struct is_sparse_matrix<SparseMatrix<T, F, A>> : std::true_type
+		{
+		};
+
+		template<typename T>
+		concept sparse_matrix = is_sparse_matrix<std::remove_cvref_t<T>>::value;
+
+		/**
+		 * @brief Operands of a multiplication or division that keep the sparsity pattern of the left (or for a
+		 * multiplication either) sparse operand
+		 */
+		template<typename L, typename R>
+		concept sparse_scaling = (sparse_matrix<L> && !sparse_matrix<R>) || (!sparse_matrix<L> && sparse_matrix<R>);
+
+		/**
+		 * @brief Applies op(sparse element, other element) on the pattern of s
+		 */
+		template<typename S, typename O, typename Op>
+		auto sparse_pattern(S s, const O &o, Op op)
+		{
+			if constexpr (arithmetic<O>)
+				s.apply([&](auto x) { return op(x, static_cast<typename S::value_type>(o)); });
+			else
+				s.combine(o, op);
+
+			return s;
+		}
+	} // namespace detail
+
+	template<typename E>
+	auto operator-(E &&e) requires matrix_expression<std::remove_cvref_t<E>> && detail::sparse_matrix<E>
+	{
+		auto m = std::remove_cvref_t<E>(std::forward<E>(e));
+		return m.apply([](auto x) { return -x; });
+	}
+
+	template<typename L, typename R>
+	auto operator+(L &&l, R &&r) requires detail::expression_operands<L, R> && detail::sparse_matrix<L>
+		&& std::same_as<std::remove_cvref_t<L>, std::remove_cvref_t<R>>
+	{
+		return l.merge(r, simd::Add{});
+	}
+	template<typename L, typename R>
+	auto operator-(L &&l, R &&r) requires detail::expression_operands<L, R> && detail::sparse_matrix<L>
+		&& std::same_as<std::remove_cvref_t<L>, std::remove_cvref_t<R>>
+	{
+		return l.merge(r, simd::Sub{});
+	}
+	template<typename L, typename R>
+	auto operator*(L &&l, R &&r) requires detail::expression_operands<L, R> && detail::sparse_scaling<L, R>
+	{
+		if constexpr (detail::sparse_matrix<L>)
+			return detail::sparse_pattern(std::forward<L>(l), r, simd::Mul{});
+		else
+			return detail::sparse_pattern(std::forward<R>(r), l, simd::Mul{});
+	}
+	template<typename L, typename R>
+	auto operator/(L &&l, R &&r) requires detail::expression_operands<L, R> && detail::sparse_scaling<L, R>
+		&& detail::sparse_matrix<L>
+	{
+		return detail::sparse_pattern(std::forward<L>(l), r, simd::Div{});
+	}
+
+} // namespace ctl::mth
+
+#endif
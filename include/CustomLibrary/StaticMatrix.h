@@ -0,0 +1,507 @@
+#ifndef _CTL_STATIC_MATRIX_
+#define _CTL_STATIC_MATRIX_
+
+#include <array>
+#include <utility>
+#include <cmath>
+
+#include "Matrix.h"
+
+namespace ctl::mth
+{
+	namespace detail
+	{
+		/**
+		 * @brief Calls f with every index from 0 to N as a integral constant. Fully unrolled at compile time.
+		 */
+		template<size_t N, typename F>
+		constexpr void unroll(F &&f)
+		{
+			[&]<size_t... I>(std::index_sequence<I...>) { (f(std::integral_constant<size_t, I>{}), ...); }
+			(std::make_index_sequence<N>{});
+		}
+	} // namespace detail
+
+	// -----------------------------------------------------------------------------
+	// Static Matrix Implementation
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Fixed size matrix living on the stack. Dimensions are checked at compile time and all kernels are
+	 * unrolled. It is a matrix expression and strided matrix so it mixes with Matrix and MatrixView.
+	 *
+	 * @tparam Type Element type
+	 * @tparam R Rows
+	 * @tparam C Columns
+	 */
+	template<arithmetic Type, size_t R, size_t C>
+	class StaticMatrix
+	{
+	public:
+		using value_type	 = Type;
+		using allocator_type = std::allocator<Type>;
+
+		static constexpr size_t rows = R;
+		static constexpr size_t cols = C;
+
+		/**
+		 * @brief Construct a zero initialized matrix
+		 */
+		constexpr StaticMatrix() = default;
+		/**
+		 * @brief Create and initialize matrix with a value
+		 * @param val Value to init
+		 */
+		constexpr explicit StaticMatrix(Type val) noexcept { m_data.fill(val); }
+		/**
+		 * @brief Create matrix from its elements in row major order
+		 * @param vals R * C values
+		 */
+		template<arithmetic... Ts>
+		constexpr StaticMatrix(Ts... vals) noexcept requires(sizeof...(Ts) == R * C && R * C > 1)
+			: m_data{ static_cast<Type>(vals)... }
+		{
+		}
+		/**
+		 * @brief Construct a matrix using a generator function
+		 * @param generator function to use for filling out the matrix
+		 */
+		template<std::invocable _Gen>
+		constexpr explicit StaticMatrix(_Gen generator)
+		{
+			for (auto &i : m_data) i = generator();
+		}
+		/**
+		 * @brief Evaluate a dynamic matrix or expression into the static matrix. Dimensions must match.
+		 * @param e Expression to evaluate
+		 */
+		template<matrix_expression E>
+		constexpr explicit StaticMatrix(const E &e) noexcept
+		{
+			assert(e.dim() == dim() && "Dimensions must match the static matrix.");
+
+			detail::unroll<R>([&](auto r) {
+				detail::unroll<C>([&](auto c) { (*this)(c, r) = static_cast<Type>(e(c, r)); });
+			});
+		}
+
+		/**
+		 * @brief Create a identity matrix
+		 * @return Identity
+		 */
+		static constexpr auto identity() noexcept -> StaticMatrix requires(R == C)
+		{
+			StaticMatrix m;
+			detail::unroll<R>([&](auto i) { m(i, i) = Type(1); });
+			return m;
+		}
+
+		/**
+		 * @brief Get a constant value from the matrix
+		 * @param c column
+		 * @param r row
+		 */
+		constexpr auto operator()(size_t c, size_t r) const noexcept -> Type
+		{
+			assert(c < C && r < R);
+			return m_data[c + C * r];
+		}
+		/**
+		 * @brief Get a value the matrix
+		 * @param c column
+		 * @param r row
+		 */
+		constexpr auto operator()(size_t c, size_t r) noexcept -> Type &
+		{
+			assert(c < C && r < R);
+			return m_data[c + C * r];
+		}
+
+		/**
+		 * @brief Get the direct matrix location without column or row
+		 * @param loc Direct location
+		 * @return Value
+		 */
+		constexpr auto operator[](size_t loc) noexcept -> Type & { return m_data[loc]; }
+		/**
+		 * @brief Get the direct matrix location without column or row
+		 * @param loc Direct location
+		 * @return Value
+		 */
+		constexpr auto operator[](size_t loc) const noexcept -> Type { return m_data[loc]; }
+
+		/**
+		 * @brief Get the matrix data as a const vals*
+		 * @return data in form of ptr to const data
+		 */
+		constexpr auto data() const noexcept -> const Type * { return m_data.data(); }
+		/**
+		 * @brief Get the matrix data as a vals*
+		 * @return data in form of ptr to data
+		 */
+		constexpr auto data() noexcept -> Type * { return m_data.data(); }
+
+		/**
+		 * @brief Get the dimensions of the matrix
+		 * @return Dim
+		 */
+		[[nodiscard]] static constexpr auto dim() noexcept -> const Dim<size_t> & { return s_dim; }
+		/**
+		 * @brief Gets the total size of the matrix
+		 * @return size
+		 */
+		[[nodiscard]] static constexpr auto size() noexcept -> size_t { return R * C; }
+		/**
+		 * @brief Get the distance between 2 rows in memory
+		 * @return stride
+		 */
+		[[nodiscard]] static constexpr auto row_stride() noexcept -> size_t { return C; }
+		/**
+		 * @brief Get the distance between 2 columns in memory
+		 * @return stride
+		 */
+		[[nodiscard]] static constexpr auto col_stride() noexcept -> size_t { return 1; }
+
+		/**
+		 * @brief Perform a unrolled dot product with a other static matrix. Inner dimensions are checked at compile
+		 * time.
+		 * @param mat2 Other matrix
+		 * @return Result
+		 */
+		template<typename T, size_t C2>
+		constexpr auto dot_product(const StaticMatrix<T, C, C2> &mat2) const noexcept
+		{
+			StaticMatrix<std::common_type_t<T, Type>, R, C2> mat;
+
+			detail::unroll<R>([&](auto y1) {
+				detail::unroll<C2>([&](auto x2) {
+					detail::unroll<C>([&](auto x1) { mat(x2, y1) += (*this)(x1, y1) * mat2(x2, x1); });
+				});
+			});
+
+			return mat;
+		}
+		/**
+		 * @brief Perform a dot product with a dynamic matrix or view
+		 * @param mat2 Other matrix
+		 * @return Dynamic result
+		 */
+		template<strided_matrix M>
+		constexpr auto dot_product(const M &mat2) const noexcept
+		{
+			using T = std::common_type_t<typename M::value_type, Type>;
+
+			Matrix<T> mat(R, mat2.dim().w, 0);
+			detail::strided_product(*this, mat2, mat);
+
+			return mat;
+		}
+
+		/**
+		 * @brief Transpose the matrix to a new matrix
+		 * @return Transposed matrix
+		 */
+		constexpr auto transpose() const noexcept
+		{
+			StaticMatrix<Type, C, R> mat;
+			detail::unroll<R>([&](auto r) { detail::unroll<C>([&](auto c) { mat(r, c) = (*this)(c, r); }); });
+			return mat;
+		}
+
+		/**
+		 * @brief Calculate the determinant of a square matrix
+		 * @return Determinant
+		 */
+		constexpr auto determinant() const noexcept requires(R == C)
+		{
+			const auto &m = *this;
+
+			if constexpr (R == 1)
+				return m[0];
+			else if constexpr (R == 2)
+				return m[0] * m[3] - m[1] * m[2];
+			else if constexpr (R == 3)
+				return m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6])
+					+ m[2] * (m[3] * m[7] - m[4] * m[6]);
+			else
+			{
+				using F = std::conditional_t<std::is_floating_point_v<Type>, Type, double>;
+
+				auto lu	 = StaticMatrix<F, R, C>(*this);
+				F	 det = 1;
+
+				for (size_t k = 0; k < R; ++k)
+				{
+					auto p = k;
+					for (size_t i = k + 1; i < R; ++i)
+						if (_abs_(lu(k, i)) > _abs_(lu(k, p)))
+							p = i;
+
+					if (lu(k, p) == F(0))
+						return F(0);
+					if (p != k)
+					{
+						lu._swap_rows_(k, p);
+						det = -det;
+					}
+
+					det *= lu(k, k);
+					for (size_t i = k + 1; i < R; ++i)
+					{
+						const auto f = lu(k, i) / lu(k, k);
+						for (size_t j = k; j < C; ++j) lu(j, i) -= f * lu(j, k);
+					}
+				}
+
+				return det;
+			}
+		}
+
+		/**
+		 * @brief Invert a square matrix. 2x2 and 3x3 use the adjugate, larger sizes Gauss-Jordan elimination with
+		 * partial pivoting. The matrix must not be singular.
+		 * @return Inverse
+		 */
+		constexpr auto inverse() const noexcept requires(R == C && std::is_floating_point_v<Type>)
+		{
+			const auto &m = *this;
+
+			if constexpr (R == 1)
+				return StaticMatrix(Type(1) / m[0]);
+			else if constexpr (R == 2)
+			{
+				const auto d = Type(1) / determinant();
+				return StaticMatrix(m[3] * d, -m[1] * d, -m[2] * d, m[0] * d);
+			}
+			else if constexpr (R == 3)
+			{
+				const auto d = Type(1) / determinant();
+				return StaticMatrix((m[4] * m[8] - m[5] * m[7]) * d, (m[2] * m[7] - m[1] * m[8]) * d,
+									(m[1] * m[5] - m[2] * m[4]) * d, (m[5] * m[6] - m[3] * m[8]) * d,
+									(m[0] * m[8] - m[2] * m[6]) * d, (m[2] * m[3] - m[0] * m[5]) * d,
+									(m[3] * m[7] - m[4] * m[6]) * d, (m[1] * m[6] - m[0] * m[7]) * d,
+									(m[0] * m[4] - m[1] * m[3]) * d);
+			}
+			else
+			{
+				auto a	 = *this;
+				auto inv = identity();
+
+				for (size_t k = 0; k < R; ++k)
+				{
+					auto p = k;
+					for (size_t i = k + 1; i < R; ++i)
+						if (_abs_(a(k, i)) > _abs_(a(k, p)))
+							p = i;
+
+					assert(a(k, p) != Type(0) && "Matrix is singular.");
+
+					a._swap_rows_(k, p);
+					inv._swap_rows_(k, p);
+
+					const auto d = Type(1) / a(k, k);
+					detail::unroll<C>([&](auto j) { a(j, k) *= d, inv(j, k) *= d; });
+
+					for (size_t i = 0; i < R; ++i)
+						if (i != k)
+						{
+							const auto f = a(k, i);
+							detail::unroll<C>([&](auto j) { a(j, i) -= f * a(j, k), inv(j, i) -= f * inv(j, k); });
+						}
+				}
+
+				return inv;
+			}
+		}
+
+		/**
+		 * @brief Apply a function onto the matrix
+		 * @param func Unary function
+		 */
+		template<typename F>
+		constexpr auto apply(F func) noexcept -> auto &
+		{
+			detail::unroll<R * C>([&](auto i) { m_data[i] = func(m_data[i]); });
+			return *this;
+		}
+
+		template<typename T>
+		constexpr auto operator+=(const T &x) noexcept -> auto &
+		{
+			return _compound_(x, simd::Add{});
+		}
+		template<typename T>
+		constexpr auto operator-=(const T &x) noexcept -> auto &
+		{
+			return _compound_(x, simd::Sub{});
+		}
+		template<typename T>
+		constexpr auto operator*=(const T &x) noexcept -> auto &
+		{
+			return _compound_(x, simd::Mul{});
+		}
+		template<typename T>
+		constexpr auto operator/=(const T &x) noexcept -> auto &
+		{
+			return _compound_(x, simd::Div{});
+		}
+
+		/**
+		 * @brief Iterator const begin
+		 * @return begin
+		 */
+		constexpr auto begin() const noexcept { return m_data.begin(); }
+		/**
+		 * @brief Iterator begin
+		 * @return begin
+		 */
+		constexpr auto begin() noexcept { return m_data.begin(); }
+		/**
+		 * @brief Iterator const end
+		 * @return end
+		 */
+		constexpr auto end() const noexcept { return m_data.end(); }
+		/**
+		 * @brief Iterator end
+		 * @return end
+		 */
+		constexpr auto end() noexcept { return m_data.end(); }
+
+	private:
+		static constexpr Dim<size_t> s_dim = { C, R };
+
+		std::array<Type, R * C> m_data = {};
+
+		template<typename T, typename Op>
+		constexpr auto _compound_(const T &x, Op op) noexcept -> StaticMatrix &
+		{
+			if constexpr (arithmetic<T>)
+				detail::unroll<R * C>(
+					[&](auto i) { m_data[i] = static_cast<Type>(op(m_data[i], static_cast<Type>(x))); });
+			else
+			{
+				if constexpr (requires { T::rows; })
+					static_assert(T::rows == R && T::cols == C, "Elementwise applications need both matricies to be "
+																"the same in dimension.");
+				else
+					_ELEMENT_WISE_CHECK_(dim(), x.dim());
+
+				detail::unroll<R>([&](auto r) {
+					detail::unroll<C>([&](auto c) { (*this)(c, r) = static_cast<Type>(op((*this)(c, r), x(c, r))); });
+				});
+			}
+
+			return *this;
+		}
+
+		constexpr void _swap_rows_(size_t r1, size_t r2) noexcept
+		{
+			detail::unroll<C>([&](auto c) { std::swap((*this)(c, r1), (*this)(c, r2)); });
+		}
+
+		template<typename T>
+		static constexpr auto _abs_(T x) noexcept -> T
+		{
+			return x < T(0) ? -x : x;
+		}
+
+		template<arithmetic, size_t, size_t>
+		friend class StaticMatrix;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Arithmitic Overloads
+	// -----------------------------------------------------------------------------
+
+	namespace detail
+	{
+		template<typename T>
+		struct is_static_matrix : std::false_type
+		{
+		};
+
+		template<typename T, size_t R, size_t C>
+		struct is_static_matrix<StaticMatrix<T, R, C>> : std::true_type
+		{
+		};
+
+		template<typename T>
+		concept static_matrix = is_static_matrix<std::remove_cvref_t<T>>::value;
+
+		/**
+		 * @brief Operands that are evaluated eagerly on the stack instead of building a expression
+		 */
+		template<typename L, typename R>
+		concept static_operands = (static_matrix<L> && static_matrix<R>) || (static_matrix<L> && arithmetic<R>)
+			|| (arithmetic<L> && static_matrix<R>);
+
+		/**
+		 * @brief Element i of a static matrix or the scalar itself
+		 */
+		template<typename T>
+		constexpr auto static_at(const T &x, size_t i) noexcept
+		{
+			if constexpr (arithmetic<T>)
+				return x;
+			else
+				return x[i];
+		}
+
+		/**
+		 * @brief Elementwise operation of static matrices or a static matrix and a scalar. The element type follows
+		 * binary_value like in matrix expressions.
+		 */
+		template<typename Op, typename L, typename R>
+		constexpr auto static_elementwise(const L &l, const R &r, Op op) noexcept
+		{
+			using S = std::conditional_t<arithmetic<L>, R, L>;
+			using T = typename binary_value<L, R>::type;
+
+			if constexpr (static_matrix<L> && static_matrix<R>)
+				static_assert(L::rows == R::rows && L::cols == R::cols,
+							  "Elementwise applications need both matricies to be the same in dimension.");
+
+			StaticMatrix<T, S::rows, S::cols> m;
+			unroll<S::rows * S::cols>([&](auto i) {
+				m[i] = static_cast<T>(op(static_cast<T>(static_at(l, i)), static_cast<T>(static_at(r, i))));
+			});
+
+			return m;
+		}
+	} // namespace detail
+
+	template<typename E>
+	constexpr auto operator-(E &&e) noexcept
+		requires matrix_expression<std::remove_cvref_t<E>> && detail::static_matrix<E>
+	{
+		return detail::static_elementwise(typename std::remove_cvref_t<E>::value_type(0), e, simd::Sub{});
+	}
+
+	template<typename L, typename R>
+	constexpr auto operator+(L &&l, R &&r) noexcept
+		requires detail::expression_operands<L, R> && detail::static_operands<L, R>
+	{
+		return detail::static_elementwise(l, r, simd::Add{});
+	}
+	template<typename L, typename R>
+	constexpr auto operator-(L &&l, R &&r) noexcept
+		requires detail::expression_operands<L, R> && detail::static_operands<L, R>
+	{
+		return detail::static_elementwise(l, r, simd::Sub{});
+	}
+	template<typename L, typename R>
+	constexpr auto operator*(L &&l, R &&r) noexcept
+		requires detail::expression_operands<L, R> && detail::static_operands<L, R>
+	{
+		return detail::static_elementwise(l, r, simd::Mul{});
+	}
+	template<typename L, typename R>
+	constexpr auto operator/(L &&l, R &&r) noexcept
+		requires detail::expression_operands<L, R> && detail::static_operands<L, R>
+	{
+		return detail::static_elementwise(l, r, simd::Div{});
+	}
+
+} // namespace ctl::mth
+
+#endif
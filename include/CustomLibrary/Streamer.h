@@ -10,13 +10,14 @@
 // -----------------------------------------------------------------------------
 
 #ifdef _CTL_MATRIX_
-template<typename T, typename A>
-auto operator<<(std::ostream &o, const ctl::mth::Matrix<T, A> &m) noexcept -> std::ostream &
+template<ctl::mth::matrix_expression E>
+auto operator<<(std::ostream &o, const E &m) noexcept -> std::ostream &
 {
 	const auto dim = m.dim();
 	o << dim.h << ' ' << dim.w << ' ';
 
-	for (auto i : m) o << i << ' ';
+	for (size_t r = 0; r < dim.h; ++r)
+		for (size_t c = 0; c < dim.w; ++c) o << m(c, r) << ' ';
 
 	return o;
 }
@@ -40,22 +41,45 @@ auto operator>>(std::istream &in, ctl::mth::Matrix<T, A> &m) -> std::istream &
 }
 #endif
 
+#ifdef _CTL_STATIC_MATRIX_
+template<typename T, size_t R, size_t C>
+auto operator>>(std::istream &in, ctl::mth::StaticMatrix<T, R, C> &m) -> std::istream &
+{
+	size_t r, c;
+	in >> r >> c;
+
+	assert(r == R && c == C && "Streamed dimensions must match the static matrix.");
+
+	for (auto &i : m)
+	{
+		double b;
+		in >> b;
+		i = static_cast<T>(b);
+	}
+
+	return in;
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // Neural Network Streams
 // -----------------------------------------------------------------------------
 
 #ifdef _CTL_NEURAL_NET_
-auto operator<<(std::ostream &o, const ctl::mcl::BasicNeuralNetwork &nn) noexcept -> std::ostream &
+template<typename Weight>
+auto operator<<(std::ostream &o, const ctl::mcl::BasicNeuralNetwork<Weight> &nn) noexcept -> std::ostream &
 {
 	o << nn.layers_n() << ' ';
-	for (auto i = nn.begin(); i != nn.end(); ++i) o << i->biases << ' ' << i->weights << ' ';
+	for (auto i = nn.begin(); i != nn.end(); ++i)
+		o << i->biases << ' ' << i->weights << ' ' << static_cast<unsigned>(i->activation) << ' ';
 
 	return o;
 }
 
-auto operator>>(std::istream &in, ctl::mcl::BasicNeuralNetwork &nn) noexcept -> std::istream &
+template<typename Weight>
+auto operator>>(std::istream &in, ctl::mcl::BasicNeuralNetwork<Weight> &nn) noexcept -> std::istream &
 {
-	ctl::mcl::BasicNeuralNetwork new_nn;
+	ctl::mcl::BasicNeuralNetwork<Weight> new_nn;
 
 	size_t n;
 	in >> n;
@@ -63,9 +87,16 @@ auto operator>>(std::istream &in, ctl::mcl::BasicNeuralNetwork &nn) noexcept ->
 	for (; n > 0 + 1; --n) // Account for 1st layer
 	{
 		ctl::mth::Matrix<double> w, b;
-		in >> b >> w;
+		unsigned				 f;
+		in >> b >> w >> f;
+
+		if (!in || f > static_cast<unsigned>(ctl::mcl::Activation::softmax))
+		{
+			in.setstate(std::ios::failbit);
+			return in;
+		}
 
-		new_nn.add_layer(w, b);
+		new_nn.add_layer(ctl::mth::Matrix<Weight>(w), ctl::mth::Matrix<Weight>(b), ctl::mcl::Activation(f));
 	}
 
 	nn = std::move(new_nn);
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <cassert>
+
+// Define CTL_NO_STD_EXECUTION when the parallel algorithms can't be linked (e.g. libstdc++ without TBB)
+#if __has_include(<execution>) && !defined(CTL_NO_STD_EXECUTION)
+#	include <execution>
+#endif
+
+namespace ctl::exe
+{
+	// -----------------------------------------------------------------------------
+	// Thread Pool
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Work stealing thread pool. Every worker owns a task deque, pops from its back and steals from the front of
+	 * the others when empty. Threads waiting on a parallel_for help executing tasks so nesting can't deadlock.
+	 */
+	class ThreadPool
+	{
+	public:
+		/**
+		 * @brief Start a pool
+		 * @param threads Amount of worker threads (The calling thread of parallel_for works as well)
+		 */
+		explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1)
+		{
+			m_queues.reserve(std::max<size_t>(threads, 1));
+			for (size_t i = 0; i < std::max<size_t>(threads, 1); ++i) m_queues.emplace_back(std::make_unique<Queue>());
+
+			m_threads.reserve(threads);
+			for (size_t i = 0; i < threads; ++i) m_threads.emplace_back([this, i] { _worker_(i); });
+		}
+
+		ThreadPool(const ThreadPool &) = delete;
+		auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+		~ThreadPool()
+		{
+			{
+				std::lock_guard lk(m_sleep_m);
+				m_stop = true;
+			}
+			m_sleep_cv.notify_all();
+
+			for (auto &t : m_threads) t.join();
+		}
+
+		/**
+		 * @brief Queue a task for execution
+		 * @param f Task taking no arguments
+		 */
+		template<std::invocable F>
+		void submit(F &&f)
+		{
+			const auto idx =
+				t_pool == this ? t_index : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+			{
+				std::lock_guard lk(m_queues[idx]->m);
+				m_queues[idx]->tasks.emplace_back(std::forward<F>(f));
+			}
+			m_pending.fetch_add(1, std::memory_order_release);
+
+			{
+				std::lock_guard lk(m_sleep_m);
+			}
+			m_sleep_cv.notify_one();
+		}
+
+		/**
+		 * @brief Calls f(block_begin, block_end) over [begin, end) split into blocks of grain size. Blocks are run by
+		 * the workers and the calling thread. Returns once all blocks are done. f must not throw.
+		 *
+		 * @param begin Range begin
+		 * @param end Range end
+		 * @param grain Block size
+		 * @param f Block function. Sig.: void f(size_t, size_t);
+		 */
+		template<typename F>
+		void parallel_for(size_t begin, size_t end, size_t grain, F &&f)
+		{
+			grain = std::max<size_t>(grain, 1);
+
+			const auto blocks = (end - begin + grain - 1) / grain;
+			if (blocks <= 1 || m_threads.empty())
+			{
+				if (begin < end)
+					f(begin, end);
+				return;
+			}
+
+			std::atomic<size_t> remaining = blocks - 1;
+
+			for (size_t b = 1; b < blocks; ++b)
+				submit([&f, &remaining, lo = begin + b * grain, hi = std::min(end, begin + (b + 1) * grain)] {
+					f(lo, hi);
+					remaining.fetch_sub(1, std::memory_order_release);
+				});
+
+			f(begin, std::min(end, begin + grain));
+
+			while (remaining.load(std::memory_order_acquire) != 0)
+				if (!_try_run_(t_pool == this ? t_index : 0))
+					std::this_thread::yield();
+		}
+
+		/**
+		 * @brief Amount of worker threads
+		 * @return size
+		 */
+		[[nodiscard]] auto size() const noexcept -> size_t { return m_threads.size(); }
+
+	private:
+		struct Queue
+		{
+			std::mutex						  m;
+			std::deque<std::function<void()>> tasks;
+		};
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread>			m_threads;
+
+		std::atomic<size_t> m_pending = 0;
+		std::atomic<size_t> m_next	  = 0;
+
+		std::mutex				m_sleep_m;
+		std::condition_variable m_sleep_cv;
+		bool					m_stop = false;
+
+		static inline thread_local ThreadPool *t_pool  = nullptr;
+		static inline thread_local size_t	   t_index = 0;
+
+		auto _try_run_(size_t home) -> bool
+		{
+			std::function<void()> task;
+
+			for (size_t i = 0; i < m_queues.size() && !task; ++i)
+			{
+				auto &q = *m_queues[(home + i) % m_queues.size()];
+
+				std::lock_guard lk(q.m);
+				if (q.tasks.empty())
+					continue;
+
+				if (i == 0) // Own queue: newest first
+					task = std::move(q.tasks.back()), q.tasks.pop_back();
+				else // Steal: oldest first
+					task = std::move(q.tasks.front()), q.tasks.pop_front();
+			}
+
+			if (!task)
+				return false;
+
+			m_pending.fetch_sub(1, std::memory_order_relaxed);
+			task();
+
+			return true;
+		}
+
+		void _worker_(size_t idx)
+		{
+			t_pool	= this;
+			t_index = idx;
+
+			while (true)
+			{
+				if (_try_run_(idx))
+					continue;
+
+				std::unique_lock lk(m_sleep_m);
+				m_sleep_cv.wait(lk, [this] { return m_stop || m_pending.load(std::memory_order_acquire) != 0; });
+
+				if (m_stop && m_pending.load(std::memory_order_acquire) == 0)
+					return;
+			}
+		}
+	};
+
+	/**
+	 * @brief Process wide pool used by the parallel policy by default
+	 * @return Pool
+	 */
+	inline auto default_pool() -> ThreadPool &
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Execution Policies
+	// -----------------------------------------------------------------------------
+
+	/**
+	 * @brief Run everything on the calling thread
+	 */
+	struct Sequenced
+	{
+	};
+
+	/**
+	 * @brief Run on a thread pool once the work of a call reaches a threshold
+	 */
+	struct Parallel
+	{
+		ThreadPool *pool	 = &default_pool();
+		size_t		min_work = 1 << 16;
+	};
+
+	/**
+	 * @brief Run through the standard library's parallel algorithms. With libstdc++ this needs linking against TBB,
+	 * which the CMake target does when TBB is found and otherwise defines CTL_NO_STD_EXECUTION to run sequentially.
+	 * The blocks are coarse and run with std::execution::par, not unsequenced, so the block functions may allocate
+	 * and lock.
+	 */
+	struct ParallelUnsequenced
+	{
+		size_t min_work = 1 << 16;
+	};
+
+	inline constexpr Sequenced			 seq;
+	inline constexpr ParallelUnsequenced par_unseq;
+
+	/**
+	 * @brief Create a parallel policy
+	 *
+	 * @param pool Pool to run on
+	 * @param min_work Work from which on the call is split up
+	 * @return Policy
+	 */
+	inline auto par(ThreadPool &pool = default_pool(), size_t min_work = 1 << 16) noexcept -> Parallel
+	{
+		return { &pool, min_work };
+	}
+
+	template<typename T>
+	concept execution_policy = std::same_as<T, Sequenced> || std::same_as<T, Parallel>
+		|| std::same_as<T, ParallelUnsequenced>;
+
+	/**
+	 * @brief Amount of threads work may be spread over with the policy. Used to size per-thread buffers.
+	 * @param policy Execution policy
+	 * @return Thread count
+	 */
+	template<execution_policy Policy>
+	auto concurrency([[maybe_unused]] const Policy &policy) noexcept -> size_t
+	{
+		if constexpr (std::same_as<Policy, Sequenced>)
+			return 1;
+		else if constexpr (std::same_as<Policy, Parallel>)
+			return policy.pool->size() + 1;
+		else
+			return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/**
+	 * @brief Calls f(block_begin, block_end) over [0, n) split up according to the policy
+	 *
+	 * @param policy Execution policy
+	 * @param n Amount of items
+	 * @param work_per_item Estimated work of a single item. Compared against the policy threshold.
+	 * @param f Block function. Sig.: void f(size_t, size_t);
+	 */
+	template<execution_policy Policy, typename F>
+	void for_blocks(const Policy &policy, size_t n, size_t work_per_item, F &&f)
+	{
+		if constexpr (std::same_as<Policy, Sequenced>)
+			f(size_t(0), n);
+		else
+		{
+			if (n * work_per_item < policy.min_work)
+				return f(size_t(0), n);
+
+			if constexpr (std::same_as<Policy, Parallel>)
+			{
+				const auto threads = policy.pool->size() + 1;
+				policy.pool->parallel_for(0, n, (n + threads * 4 - 1) / (threads * 4), std::forward<F>(f));
+			}
+			else
+			{
+				const auto threads = std::max(1u, std::thread::hardware_concurrency());
+				const auto grain   = (n + threads * 4 - 1) / (threads * 4);
+
+				std::vector<size_t> blocks((n + grain - 1) / grain);
+				for (size_t i = 0; i < blocks.size(); ++i) blocks[i] = i * grain;
+
+#if defined(__cpp_lib_execution) && !defined(CTL_NO_STD_EXECUTION)
+				std::for_each(std::execution::par, blocks.begin(), blocks.end(),
+							  [&](size_t b) { f(b, std::min(n, b + grain)); });
+#else
+				for (auto b : blocks) f(b, std::min(n, b + grain));
+#endif
+			}
+		}
+	}
+
+} // namespace ctl::exe
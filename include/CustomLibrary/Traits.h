@@ -108,11 +108,11 @@ namespace ctl
 			return static_cast<const T &>(*this);
 		}
 
-		auto underlying() noexcept -> T * { return static_cast<T *>(this); }
-		auto underlying() const noexcept -> const T * { return static_cast<const T *>(this); }
+		constexpr auto underlying() noexcept -> T * { return static_cast<T *>(this); }
+		constexpr auto underlying() const noexcept -> const T * { return static_cast<const T *>(this); }
 
 	private:
-		crtp() = default;
+		constexpr crtp() = default;
 		friend crtpType<T>;
 	};
 
@@ -1,10 +1,1281 @@
 #include <gtest/gtest.h>
 
+#include <CustomLibrary/Allocator.h>
+#include <CustomLibrary/ConvNet.h>
+#include <CustomLibrary/Decomposition.h>
+#include <CustomLibrary/GeneticAlgorithm.h>
+#include <CustomLibrary/Matrix.h>
+#include <CustomLibrary/MatrixFile.h>
+#include <CustomLibrary/NeuralNet.h>
+#include <CustomLibrary/NetworkFile.h>
+#include <CustomLibrary/Half.h>
+#include <CustomLibrary/Optimizer.h>
+#include <CustomLibrary/Quantize.h>
+#include <CustomLibrary/RandomGenerator.h>
+#include <CustomLibrary/Simd.h>
+#include <CustomLibrary/SparseMatrix.h>
+#include <CustomLibrary/StaticMatrix.h>
+#include <CustomLibrary/ThreadPool.h>
+#include <CustomLibrary/Streamer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace ctl;
+
+static rnd::Random<rnd::Mersenne> g_rand;
+
+static auto random_matrix(size_t r, size_t c) -> mth::Matrix<double>
+{
+    return mth::Matrix<double>(r, c, [] { return g_rand.rand_number(-1., 1.); });
+}
+
+// Textbook triple loop the kernels are checked against
+template<typename A, typename B>
+static auto naive_product(const A &a, const B &b) -> mth::Matrix<double>
+{
+    mth::Matrix<double> c(a.dim().h, b.dim().w, 0.);
+    for (size_t r = 0; r < a.dim().h; ++r)
+        for (size_t k = 0; k < a.dim().w; ++k)
+            for (size_t col = 0; col < b.dim().w; ++col) c(col, r) += a(k, r) * b(col, k);
+
+    return c;
+}
+
+template<typename A, typename B>
+static auto max_difference(const A &a, const B &b) -> double
+{
+    EXPECT_EQ(a.dim().h, b.dim().h);
+    EXPECT_EQ(a.dim().w, b.dim().w);
+
+    double e = 0.;
+    for (size_t r = 0; r < a.dim().h; ++r)
+        for (size_t c = 0; c < a.dim().w; ++c) e = std::max(e, std::abs(double(a(c, r)) - double(b(c, r))));
+
+    return e;
+}
+
 TEST(sample_test_case, sample_test)
 {
     EXPECT_EQ(1, 1);
 }
 
+// -----------------------------------------------------------------------------
+// SIMD Kernels
+// -----------------------------------------------------------------------------
+
+// Compares the kernels with scalar loops over lengths covering whole packs and every tail. The elements are small
+// integers so that every result is exact in each type.
+template<typename T>
+static void check_simd_kernels()
+{
+    for (size_t n = 1; n < 80; n += n < 20 ? 1 : 9)
+    {
+        std::vector<T> a(n), b(n), dst(n), ref(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = static_cast<T>(g_rand.rand_number(-50, 50));
+            b[i] = static_cast<T>(g_rand.rand_number(1, 50));
+        }
+
+        const auto check = [&](auto op) {
+            simd::transform(dst.data(), a.data(), b.data(), n, op);
+            for (size_t i = 0; i < n; ++i) ref[i] = static_cast<T>(op(a[i], b[i]));
+            EXPECT_EQ(dst, ref);
+
+            simd::transform(dst.data(), a.data(), T(3), n, op);
+            for (size_t i = 0; i < n; ++i) ref[i] = static_cast<T>(op(a[i], T(3)));
+            EXPECT_EQ(dst, ref);
+
+            simd::transform(dst.data(), T(3), b.data(), n, op);
+            for (size_t i = 0; i < n; ++i) ref[i] = static_cast<T>(op(T(3), b[i]));
+            EXPECT_EQ(dst, ref);
+        };
+        check(simd::Add{});
+        check(simd::Sub{});
+        check(simd::Mul{});
+        check(simd::Div{});
+        check(simd::Min{});
+        check(simd::Max{});
+
+        dst = b;
+        simd::axpy(dst.data(), T(-2), a.data(), n);
+        for (size_t i = 0; i < n; ++i) ref[i] = static_cast<T>(b[i] - 2 * a[i]);
+        EXPECT_EQ(dst, ref);
+
+        T sum = 0, dot = 0;
+        for (size_t i = 0; i < n; ++i) sum += a[i], dot += a[i] * b[i];
+        EXPECT_EQ(simd::sum(a.data(), n), sum);
+        EXPECT_EQ(simd::dot(a.data(), b.data(), n), dot);
+        EXPECT_EQ(simd::min(a.data(), n), *std::min_element(a.begin(), a.end()));
+        EXPECT_EQ(simd::max(a.data(), n), *std::max_element(a.begin(), a.end()));
+    }
+}
+
+TEST(simd, kernels_match_scalar_loops)
+{
+    check_simd_kernels<float>();
+    check_simd_kernels<double>();
+    check_simd_kernels<std::int32_t>();
+    check_simd_kernels<std::int64_t>();
+}
+
+TEST(simd, exp_is_close_to_std)
+{
+    std::vector<float>  xf(67), yf(67);
+    std::vector<double> xd(67), yd(67);
+    for (size_t i = 0; i < xf.size(); ++i) xd[i] = g_rand.rand_number(-80., 80.), xf[i] = float(xd[i]);
+
+    simd::exp(yf.data(), xf.data(), xf.size());
+    simd::exp(yd.data(), xd.data(), xd.size());
+
+    for (size_t i = 0; i < xf.size(); ++i)
+    {
+        EXPECT_NEAR(yf[i] / std::exp(xf[i]), 1.f, 1e-6f);
+        EXPECT_NEAR(yd[i] / std::exp(xd[i]), 1., 1e-13);
+    }
+}
+
+TEST(simd, matrix_operators_match_elements)
+{
+    const auto a = random_matrix(13, 11), b = random_matrix(13, 11);
+
+    const mth::Matrix<double> sum = a + b, scaled = 2. * a - b;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(sum[i], a[i] + b[i]);
+        EXPECT_DOUBLE_EQ(scaled[i], 2. * a[i] - b[i]);
+    }
+
+    auto c = b;
+    c += 0.5 * a;
+    for (size_t i = 0; i < a.size(); ++i) EXPECT_DOUBLE_EQ(c[i], b[i] + 0.5 * a[i]);
+}
+
+// -----------------------------------------------------------------------------
+// Matrix Products
+// -----------------------------------------------------------------------------
+
+TEST(matrix_product, gemm_matches_triple_loop)
+{
+    // Sizes around and across the kernel's register and cache blocks
+    for (const auto &[m, k, n] : { std::array<size_t, 3>{ 1, 1, 1 }, { 7, 5, 3 }, { 64, 64, 64 }, { 131, 257, 67 } })
+    {
+        const auto a = random_matrix(m, k), b = random_matrix(k, n);
+        const auto ref = naive_product(a, b);
+
+        EXPECT_LT(max_difference(a.dot_product(b), ref), 1e-12);
+        EXPECT_LT(max_difference(a.dot_product(exe::par(exe::default_pool(), 1), b), ref), 1e-12);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Expressions
+// -----------------------------------------------------------------------------
+
+TEST(expression, fused_expressions_match_elementwise_loops)
+{
+    const auto a = random_matrix(9, 7), b = random_matrix(9, 7), c = random_matrix(9, 7), bias = random_matrix(9, 1);
+
+    // Nothing is evaluated until the expression is assigned
+    const auto e = a * b + c - a / 2.;
+    static_assert(!std::is_same_v<std::remove_cvref_t<decltype(e)>, mth::Matrix<double>>);
+
+    const mth::Matrix<double> fused = e, negated = -a, squared = (a + b).apply([](double x) { return x * x; });
+    const mth::Matrix<double> biased = a + mth::broadcast(bias, a.dim());
+
+    // Temporary operands are held by value and outlive the statement that created them
+    const auto held = mth::Matrix<double>(a) * 2.;
+
+    mth::Matrix<double> parallel;
+    parallel.assign(exe::par(exe::default_pool(), 1), e);
+
+    for (size_t r = 0; r < a.dim().h; ++r)
+        for (size_t col = 0; col < a.dim().w; ++col)
+        {
+            EXPECT_NEAR(fused(col, r), a(col, r) * b(col, r) + c(col, r) - a(col, r) / 2., 1e-14);
+            EXPECT_EQ(parallel(col, r), fused(col, r));
+            EXPECT_EQ(negated(col, r), -a(col, r));
+            EXPECT_DOUBLE_EQ(squared(col, r), (a(col, r) + b(col, r)) * (a(col, r) + b(col, r)));
+            EXPECT_EQ(biased(col, r), a(col, r) + bias(0, r));
+            EXPECT_EQ(held(col, r), a(col, r) * 2.);
+        }
+
+    EXPECT_EQ(max_difference(e.eval(), fused), 0.);
+}
+
+TEST(expression, assignment_reading_itself)
+{
+    const mth::Matrix<double> a(3, 3, { 0., 1., 2., 3., 4., 5., 6., 7., 8. });
+
+    auto x = a;
+    x      = x.view().transpose();
+    EXPECT_EQ(max_difference(x, a.transpose()), 0.);
+
+    x = a;
+    x = x.view().block(1, 1, 2, 2);
+    EXPECT_EQ(max_difference(x, mth::Matrix<double>(2, 2, { 4., 5., 7., 8. })), 0.);
+
+    x = a;
+    x = x.view().block(0, 1, 3, 2) * 2.;
+    EXPECT_EQ(max_difference(x, mth::Matrix<double>(3, 2, { 2., 4., 8., 10., 14., 16. })), 0.);
+
+    const auto b = random_matrix(37, 101);
+    auto       y = b;
+    y.assign(exe::par(exe::default_pool(), 1), y.view().transpose());
+    EXPECT_EQ(max_difference(y, b.transpose()), 0.);
+
+    // Elementwise expressions of the matrix itself are still evaluated in place
+    y = b;
+    y = y + y;
+    EXPECT_EQ(max_difference(y, b * 2.), 0.);
+}
+
+TEST(expression, scalars_promote_like_scalar_arithmetic)
+{
+    const mth::Matrix<int> m(2, 2, 3);
+    static_assert(std::is_same_v<decltype(m * 0.5)::value_type, double>);
+    static_assert(std::is_same_v<decltype(2 * m)::value_type, int>);
+
+    EXPECT_EQ(max_difference((m * 0.5).eval(), mth::Matrix<double>(2, 2, 1.5)), 0.);
+
+    const mth::Matrix<int> r = m * 0.5;
+    EXPECT_EQ(max_difference(r, mth::Matrix<int>(2, 2, 1)), 0.);
+
+    mth::Matrix<int> acc(2, 2, 1);
+    acc += 0.5 * m;
+    EXPECT_EQ(max_difference(acc, mth::Matrix<int>(2, 2, 2)), 0.);
+}
+
+// -----------------------------------------------------------------------------
+// Matrix Views
+// -----------------------------------------------------------------------------
+
+TEST(matrix_product, gemm_of_strided_views)
+{
+    const auto a = random_matrix(90, 70), b = random_matrix(80, 90);
+
+    const auto at = a.view().transpose(), bt = b.view().transpose();
+    EXPECT_LT(max_difference(at.dot_product(bt), naive_product(at, bt)), 1e-12);
+
+    const auto ab = a.view().block(3, 5, 40, 30), bb = b.view().block(7, 2, 30, 50);
+    EXPECT_LT(max_difference(ab.dot_product(bb), naive_product(ab, bb)), 1e-12);
+    EXPECT_LT(max_difference(ab.dot_product(bt.block(0, 0, 30, 20)), naive_product(ab, bt.block(0, 0, 30, 20))),
+              1e-12);
+}
+
+// -----------------------------------------------------------------------------
+// Static Matrix
+// -----------------------------------------------------------------------------
+
+TEST(static_matrix, constexpr_kernels)
+{
+    using M2 = mth::StaticMatrix<double, 2, 2>;
+
+    constexpr M2 a(1., 2., 3., 4.);
+    static_assert(a(1, 0) == 2. && a(0, 1) == 3.);
+    static_assert(a.transpose()(1, 0) == 3.);
+    static_assert(a.determinant() == -2.);
+    static_assert(a.dot_product(M2::identity())(1, 1) == 4.);
+    static_assert((a + a)(1, 1) == 8. && (2. * a - a)(0, 1) == 3. && (-a)(0, 0) == -1.);
+
+    constexpr auto inv = a.inverse();
+    static_assert(inv(0, 0) == -2. && inv(1, 0) == 1. && inv(0, 1) == 1.5 && inv(1, 1) == -.5);
+
+    constexpr mth::StaticMatrix<int, 2, 3> b(1, 2, 3, 4, 5, 6);
+    constexpr auto                         bbt = b.dot_product(b.transpose());
+    static_assert(bbt(0, 0) == 14 && bbt(1, 0) == 32 && bbt(1, 1) == 77);
+    static_assert((b * .5)(0, 0) == .5 && (3 / b)(1, 0) == 1);
+
+    constexpr mth::StaticMatrix<double, 3, 3> c(2., -1., 0., -1., 2., -1., 0., -1., 2.);
+    static_assert(c.determinant() == 4.);
+
+    SUCCEED();
+}
+
+TEST(static_matrix, matches_dynamic_kernels)
+{
+    const mth::StaticMatrix<double, 5, 5> a([] { return g_rand.rand_number(-1., 1.); });
+    const mth::Matrix<double>             dyn(a), x = random_matrix(5, 3);
+
+    EXPECT_LT(max_difference(a.dot_product(a), naive_product(dyn, dyn)), 1e-12);
+    EXPECT_LT(max_difference(a.dot_product(x), naive_product(dyn, x)), 1e-12);
+    EXPECT_NEAR(a.determinant(), mth::LU<double>(dyn).determinant(), 1e-12);
+    EXPECT_LT(max_difference(a.dot_product(a.inverse()), mth::StaticMatrix<double, 5, 5>::identity()), 1e-10);
+
+    const mth::Matrix<double> sum = dyn + a;
+    EXPECT_EQ(max_difference(sum, dyn * 2.), 0.);
+}
+
+// -----------------------------------------------------------------------------
+// Execution
+// -----------------------------------------------------------------------------
+
+TEST(execution, parallel_for_covers_every_index_once)
+{
+    exe::ThreadPool pool(3);
+
+    for (const auto &[begin, end, grain] :
+         { std::array<size_t, 3>{ 0, 0, 1 }, { 5, 6, 1 }, { 0, 1000, 1 }, { 7, 1000, 33 }, { 0, 100, 1000 } })
+    {
+        std::vector<std::atomic<int>> hits(end);
+        pool.parallel_for(begin, end, grain, [&](size_t lo, size_t hi) {
+            EXPECT_LE(hi - lo, grain);
+            for (auto i = lo; i < hi; ++i) hits[i].fetch_add(1);
+        });
+
+        for (size_t i = 0; i < end; ++i) EXPECT_EQ(hits[i].load(), i < begin ? 0 : 1);
+    }
+}
+
+TEST(execution, nested_parallel_for_and_submit)
+{
+    std::atomic<size_t> sum = 0, tasks = 0;
+    {
+        exe::ThreadPool pool(2);
+
+        // Waiting blocks run queued work, so nesting on a small pool finishes
+        pool.parallel_for(0, 8, 1, [&](size_t lo, size_t hi) {
+            pool.parallel_for(0, 100, 10, [&](size_t a, size_t b) {
+                for (auto i = a; i < b; ++i) sum.fetch_add(lo * 100 + i);
+            });
+            EXPECT_EQ(hi, lo + 1);
+        });
+
+        for (int i = 0; i < 500; ++i) pool.submit([&] { tasks.fetch_add(1); });
+    }
+
+    EXPECT_EQ(sum.load(), size_t(799 * 800 / 2));
+    EXPECT_EQ(tasks.load(), 500u);
+}
+
+TEST(execution, policies_split_the_same_range)
+{
+    exe::ThreadPool pool(3);
+
+    const auto covered = [](const auto &policy, size_t n) {
+        std::vector<std::atomic<int>> hits(n);
+        std::atomic<size_t>           blocks = 0;
+        exe::for_blocks(policy, n, 1, [&](size_t lo, size_t hi) {
+            blocks.fetch_add(1);
+            for (auto i = lo; i < hi; ++i) hits[i].fetch_add(1);
+        });
+
+        for (const auto &h : hits) EXPECT_EQ(h.load(), 1);
+        return blocks.load();
+    };
+
+    EXPECT_EQ(covered(exe::seq, 1000), 1u);
+    EXPECT_EQ(covered(exe::par(pool), 1000), 1u);
+    EXPECT_GT(covered(exe::par(pool, 1), 1000), 1u);
+    EXPECT_GE(covered(exe::ParallelUnsequenced{ 1 }, 1000), 1u);
+
+    EXPECT_EQ(exe::concurrency(exe::seq), 1u);
+    EXPECT_EQ(exe::concurrency(exe::par(pool)), 4u);
+
+    const auto a = random_matrix(70, 50);
+
+    auto b = a, c = a;
+    b.apply(exe::par(pool, 1), [](double x) { return x * 2.; });
+    c.assign(exe::par(pool, 1), a * 2.);
+    EXPECT_EQ(max_difference(b, a * 2.), 0.);
+    EXPECT_EQ(max_difference(c, a * 2.), 0.);
+}
+
+TEST(execution, parallel_unsequenced_matches_sequenced)
+{
+    const auto a = random_matrix(150, 90), b = random_matrix(90, 70), c = random_matrix(150, 90);
+
+    EXPECT_LT(max_difference(a.dot_product(exe::par_unseq, b), naive_product(a, b)), 1e-12);
+    EXPECT_EQ(max_difference(a.transpose(exe::par_unseq), a.transpose()), 0.);
+
+    mth::Matrix<double> sum;
+    sum.assign(exe::ParallelUnsequenced{ 1 }, a + c);
+    EXPECT_EQ(max_difference(sum, a + c), 0.);
+}
+
+// -----------------------------------------------------------------------------
+// Transpose
+// -----------------------------------------------------------------------------
+
+TEST(transpose, matches_index_swap)
+{
+    for (const auto &[h, w] : { std::array<size_t, 2>{ 1, 1 }, { 17, 17 }, { 64, 64 }, { 37, 101 }, { 128, 3 } })
+    {
+        const auto a = random_matrix(h, w);
+
+        mth::Matrix<double> ref(w, h, 0.);
+        for (size_t r = 0; r < h; ++r)
+            for (size_t c = 0; c < w; ++c) ref(r, c) = a(c, r);
+
+        EXPECT_EQ(max_difference(a.transpose(), ref), 0.);
+        EXPECT_EQ(max_difference(a.transpose(exe::par(exe::default_pool(), 1)), ref), 0.);
+
+        auto b = a;
+        b.transpose_inplace();
+        EXPECT_EQ(max_difference(b, ref), 0.);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Allocator
+// -----------------------------------------------------------------------------
+
+TEST(arena, rewind_to_fresh_marker_reuses_first_block)
+{
+    ctl::mem::Arena arena(1024);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const auto m = arena.mark();
+        (void)arena.allocate(100);
+        EXPECT_EQ(arena.used(), 100u);
+
+        arena.rewind(m);
+        EXPECT_EQ(arena.used(), 0u);
+        EXPECT_EQ(arena.capacity(), 1024u);
+    }
+}
+
+TEST(arena, rewind_frees_later_blocks)
+{
+    ctl::mem::Arena arena(1024);
+
+    (void)arena.allocate(64);
+    const auto m = arena.mark();
+    const auto used = arena.used();
+
+    (void)arena.allocate(900);
+    (void)arena.allocate(900);
+    EXPECT_GT(arena.capacity(), 1024u);
+
+    arena.rewind(m);
+    EXPECT_EQ(arena.used(), used);
+
+    const auto capacity = arena.capacity();
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0u);
+
+    (void)arena.allocate(1800);
+    EXPECT_EQ(arena.capacity(), capacity);
+}
+
+// -----------------------------------------------------------------------------
+// Sparse Matrices
+// -----------------------------------------------------------------------------
+
+TEST(sparse, matches_dense)
+{
+    const auto a = mth::Matrix<double>(60, 50, [] {
+        return g_rand.rand_number(0., 1.) < .1 ? g_rand.rand_number(-1., 1.) : 0.;
+    });
+    const auto b = random_matrix(50, 9);
+
+    const mth::CSRMatrix<double> csr(a);
+    const mth::CSCMatrix<double> csc(csr);
+
+    EXPECT_EQ(max_difference(csr.to_dense(), a), 0.);
+    EXPECT_EQ(max_difference(csc.to_dense(), a), 0.);
+
+    const auto ref = naive_product(a, b);
+    EXPECT_LT(max_difference(csr.dot_product(b), ref), 1e-12);
+    EXPECT_LT(max_difference(csc.dot_product(b), ref), 1e-12);
+}
+
+// -----------------------------------------------------------------------------
+// Decompositions
+// -----------------------------------------------------------------------------
+
+TEST(decompositions, solve_residuals)
+{
+    for (const size_t n : { 1, 5, 64, 150 })
+    {
+        const auto a = random_matrix(n, n), b = random_matrix(n, 3);
+
+        mth::Matrix<double> spd = a.dot_product(a.view().transpose());
+        for (size_t i = 0; i < n; ++i) spd(i, i) += double(n);
+
+        EXPECT_LT(max_difference(a.dot_product(mth::LU<double>(a).solve(b)), b), 1e-9);
+        EXPECT_LT(max_difference(a.dot_product(mth::QR<double>(a).solve(b)), b), 1e-9);
+        EXPECT_LT(max_difference(spd.dot_product(mth::Cholesky<double>(spd).solve(b)), b), 1e-9);
+    }
+}
+
+TEST(decompositions, determinant_and_inverse)
+{
+    const mth::Matrix<double> a(3, 3, { 2., -1., 0., -1., 2., -1., 0., -1., 2. });
+
+    EXPECT_NEAR(mth::LU<double>(a).determinant(), 4., 1e-12);
+    EXPECT_NEAR(mth::Cholesky<double>(a).determinant(), 4., 1e-12);
+    EXPECT_NEAR(std::abs(mth::QR<double>(a).determinant()), 4., 1e-12);
+
+    const mth::Matrix<double> identity(3, 3, { 1., 0., 0., 0., 1., 0., 0., 0., 1. });
+    EXPECT_LT(max_difference(a.dot_product(mth::LU<double>(a).inverse()), identity), 1e-12);
+}
+
+// -----------------------------------------------------------------------------
+// Reductions
+// -----------------------------------------------------------------------------
+
+TEST(reductions, norm_l1_of_infinity)
+{
+    const auto inf = std::numeric_limits<float>::infinity();
+
+    mth::Matrix<float> m(2, 16, [] { return -1.f; });
+    m(3, 0) = inf;
+    m(5, 1) = -inf;
+
+    EXPECT_EQ(mth::norm_l1(m), inf);
+
+    const auto rows = mth::norm_l1(m, mth::Axis::row), cols = mth::norm_l1(m, mth::Axis::col);
+    EXPECT_EQ(rows.data()[0], inf);
+    EXPECT_EQ(rows.data()[1], inf);
+    EXPECT_EQ(cols.data()[3], inf);
+    EXPECT_EQ(cols.data()[5], inf);
+    EXPECT_EQ(cols.data()[0], 2.f);
+}
+
+TEST(reductions, axis_results_use_the_operand_allocator)
+{
+    mem::Arena arena(1 << 16);
+
+    const mth::pmr::Matrix<double> a(4, 3, 2., &arena);
+    const mth::pmr::Matrix<int>    b(4, 3, 2, &arena);
+
+    for (const auto axis : { mth::Axis::row, mth::Axis::col })
+    {
+        EXPECT_EQ(mth::sum(a, axis).get_allocator().resource(), &arena);
+        EXPECT_EQ(mth::mean(a, axis).get_allocator().resource(), &arena);
+        EXPECT_EQ(mth::mean(b, axis).get_allocator().resource(), &arena);
+        EXPECT_EQ(mth::norm_l2(a, axis).get_allocator().resource(), &arena);
+        EXPECT_EQ(mth::norm_l2(exe::par(exe::default_pool(), 1), b, axis).get_allocator().resource(), &arena);
+
+        EXPECT_EQ(mth::mean(b, axis)[0], 2.);
+        EXPECT_EQ(mth::norm_l2(a, axis)[0], axis == mth::Axis::row ? std::sqrt(12.) : 4.);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Matrix Files
+// -----------------------------------------------------------------------------
+
+TEST(matrix_file, binary_round_trip)
+{
+    const auto a = random_matrix(33, 17);
+
+    std::stringstream s;
+    mth::write(s, a);
+    mth::write(s, a.view().block(1, 2, 5, 4));
+
+    EXPECT_EQ(max_difference(mth::read<double>(s), a), 0.);
+    EXPECT_EQ(max_difference(mth::read<double>(s), a.view().block(1, 2, 5, 4)), 0.);
+
+    s.clear();
+    s.seekg(0);
+    EXPECT_LT(max_difference(mth::read<float>(s), a), 1e-6);
+
+    const auto path = std::filesystem::temp_directory_path() / "ctl_test.mat";
+    {
+        std::ofstream o(path, std::ios::binary);
+        mth::write(o, a);
+        mth::write(o, a.transpose());
+    }
+
+    const auto mapped = mth::map_matrices<double>(path);
+    ASSERT_EQ(mapped.size(), 2u);
+    EXPECT_EQ(max_difference(mapped[0], a), 0.);
+    EXPECT_EQ(max_difference(mapped[1], a.transpose()), 0.);
+    std::filesystem::remove(path);
+}
+
+TEST(matrix_file, rejects_overflowing_headers)
+{
+    std::stringstream s;
+    mth::write(s, random_matrix(4, 4));
+    const auto good = s.str();
+
+    const auto set = [](std::string &bytes, size_t offset, std::uint64_t v) {
+        std::memcpy(bytes.data() + offset, &v, sizeof(v));
+    };
+    const auto read = [](const std::string &bytes) {
+        std::stringstream in(bytes);
+        return mth::read<double>(in);
+    };
+
+    // rows * cols * 8 wraps around to the stored data size of 0
+    auto wrapped = good;
+    set(wrapped, offsetof(mth::FileHeader, rows), std::uint64_t(1) << 32);
+    set(wrapped, offsetof(mth::FileHeader, cols), std::uint64_t(1) << 32);
+    set(wrapped, offsetof(mth::FileHeader, data_size), 0);
+    EXPECT_THROW(read(wrapped), std::runtime_error);
+
+    // A consistent header asking for far more data than the stream holds
+    auto huge = good;
+    set(huge, offsetof(mth::FileHeader, rows), std::uint64_t(1) << 20);
+    set(huge, offsetof(mth::FileHeader, cols), std::uint64_t(1) << 20);
+    set(huge, offsetof(mth::FileHeader, data_size), (std::uint64_t(1) << 40) * sizeof(double));
+    EXPECT_THROW(read(huge), std::runtime_error);
+
+    // The end of the data wraps around when mapped
+    auto far = good;
+    set(far, offsetof(mth::FileHeader, data_offset), ~std::uint64_t(0) - 64);
+
+    const auto path = std::filesystem::temp_directory_path() / "ctl_test_corrupt.mat";
+    std::ofstream(path, std::ios::binary).write(far.data(), std::streamsize(far.size()));
+    EXPECT_THROW(mth::map_matrices<double>(path), std::runtime_error);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(read(good).size(), 16u);
+}
+
+// -----------------------------------------------------------------------------
+// Mixed Precision
+// -----------------------------------------------------------------------------
+
+TEST(mixed_precision, rounding_at_compile_time)
+{
+    using mth::detail::float_to_bfloat, mth::detail::float_to_half;
+
+    static_assert(float_to_half(1.f) == 0x3c00 && float_to_half(-2.f) == 0xc000);
+    static_assert(float_to_half(65504.f) == 0x7bff && float_to_half(65520.f) == 0x7c00);
+    static_assert(float_to_half(1.f + 0x1p-11f) == 0x3c00 && float_to_half(1.f + 0x3p-11f) == 0x3c02);
+    static_assert(float_to_half(0x1p-24f) == 0x0001 && float_to_half(0x1p-25f) == 0 && float_to_half(0x3p-26f) == 1);
+    static_assert(float_to_half(std::numeric_limits<float>::quiet_NaN()) == 0x7e00);
+    static_assert(float(mth::f16(0.5f)) == 0.5f && float(mth::f16::from_bits(0x0001)) == 0x1p-24f);
+
+    static_assert(float_to_bfloat(1.f) == 0x3f80 && float_to_bfloat(-2.f) == 0xc000);
+    static_assert(float_to_bfloat(1.f + 0x1p-8f) == 0x3f80 && float_to_bfloat(1.f + 0x3p-8f) == 0x3f82);
+    static_assert(float_to_bfloat(std::numeric_limits<float>::infinity()) == 0x7f80);
+    static_assert((float_to_bfloat(std::numeric_limits<float>::quiet_NaN()) & 0x7fc0) == 0x7fc0);
+    static_assert(float(mth::bf16(3.f)) == 3.f);
+
+    SUCCEED();
+}
+
+TEST(mixed_precision, conversions_round_trip)
+{
+    // Every half that isn't a NaN converts to float and back unchanged, through the scalar and the vector path
+    std::vector<mth::f16> halves;
+    for (std::uint32_t b = 0; b < 0x10000; ++b)
+        if ((b & 0x7c00) != 0x7c00 || (b & 0x3ff) == 0)
+            halves.push_back(mth::f16::from_bits(std::uint16_t(b)));
+
+    std::vector<float>    floats(halves.size());
+    std::vector<mth::f16> back(halves.size());
+    simd::convert(floats.data(), halves.data(), halves.size());
+    simd::convert(back.data(), floats.data(), floats.size());
+
+    for (size_t i = 0; i < halves.size(); ++i)
+    {
+        ASSERT_EQ(floats[i], float(halves[i]));
+        ASSERT_EQ(back[i].bits, halves[i].bits);
+        ASSERT_EQ(mth::f16(floats[i]).bits, halves[i].bits);
+    }
+
+    // Floats round to the nearest bfloat16, through the scalar and the vector path
+    std::vector<float> samples(1001);
+    for (auto &f : samples) f = float(g_rand.rand_number(-1e6, 1e6));
+
+    std::vector<mth::bf16> brains(samples.size());
+    simd::convert(brains.data(), samples.data(), samples.size());
+
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const auto f = samples[i];
+        const auto b = mth::bf16(f);
+        EXPECT_EQ(brains[i].bits, b.bits);
+
+        const auto up   = mth::bf16::from_bits(std::uint16_t(b.bits + 1));
+        const auto down = mth::bf16::from_bits(std::uint16_t(b.bits - 1));
+
+        EXPECT_LE(std::abs(float(b) - f), std::abs(float(up) - f));
+        EXPECT_LE(std::abs(float(b) - f), std::abs(float(down) - f));
+    }
+}
+
+TEST(mixed_precision, products_accumulate_in_float)
+{
+    const auto a = random_matrix(40, 300), b = random_matrix(300, 20);
+
+    const mth::Matrix<mth::f16>  ah(a);
+    const mth::Matrix<mth::bf16> bb(b);
+    const mth::Matrix<float>     bf(b);
+
+    // Reference on the exactly representable stored values
+    const auto half  = naive_product(mth::Matrix<double>(ah), mth::Matrix<double>(bf));
+    const auto brain = naive_product(mth::Matrix<double>(ah), mth::Matrix<double>(bb));
+
+    const auto hf = ah.dot_product(bf);
+    static_assert(std::is_same_v<decltype(hf)::value_type, float>);
+
+    EXPECT_LT(max_difference(hf, half), 1e-4);
+    EXPECT_LT(max_difference(ah.dot_product(bb), brain), 1e-4);
+    EXPECT_LT(max_difference(ah.dot_product(exe::par(exe::default_pool(), 1), bb), brain), 1e-4);
+}
+
+// -----------------------------------------------------------------------------
+// Quantization
+// -----------------------------------------------------------------------------
+
+TEST(quantization, int8_gemm_is_close)
+{
+    const auto a = random_matrix(48, 96), x = random_matrix(96, 5);
+    const auto ref = a.dot_product(x);
+
+    double scale = 0.;
+    for (const auto v : ref) scale = std::max(scale, std::abs(v));
+
+    EXPECT_LT(max_difference(mth::QuantizedMatrix(a).dot_product(x), ref), .05 * scale);
+}
+
+// -----------------------------------------------------------------------------
+// Neural Network
+// -----------------------------------------------------------------------------
+
+TEST(neural_net, batched_query_matches_single_queries)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork nn({ 9, 20, 11, 4 }, { Activation::relu, Activation::tanh, Activation::softmax },
+                                   [] { return g_rand.rand_number(-1., 1.); });
+
+    const auto x     = random_matrix(9, 7);
+    const auto batch = nn.query_batch(x);
+    const auto par   = nn.query_batch(exe::par(exe::default_pool(), 1), x);
+
+    for (size_t c = 0; c < 7; ++c)
+    {
+        const auto column = nn.query(mth::Matrix<double>(x.view().block(0, c, 9, 1)));
+
+        for (size_t r = 0; r < 4; ++r)
+        {
+            EXPECT_NEAR(batch(c, r), column[r], 1e-12);
+            EXPECT_NEAR(par(c, r), column[r], 1e-12);
+        }
+    }
+}
+
+TEST(neural_net, fit_matches_mini_batch_of_one)
+{
+    using mcl::Activation;
+
+    mcl::BasicNeuralNetwork a({ 4, 6, 3 }, { Activation::tanh, Activation::sigmoid },
+                              [] { return g_rand.rand_number(-1., 1.); });
+    auto                    b = a;
+
+    mcl::MiniBatchTrainer trainer(b, 1);
+    for (int i = 0; i < 5; ++i)
+    {
+        const auto x = random_matrix(4, 1), y = random_matrix(3, 1);
+        mcl::fit(a, x, y, .1);
+        trainer.fit_batch(x, y, .1);
+    }
+
+    for (size_t i = 0; i < a.parameters().size(); ++i) EXPECT_NEAR(a.parameters()[i], b.parameters()[i], 1e-12);
+}
+
+TEST(neural_net, text_stream_keeps_activations)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork nn({ 4, 6, 5, 3 }, { Activation::tanh, Activation::relu, Activation::softmax },
+                                     [] { return g_rand.rand_number(-1., 1.); });
+
+    std::stringstream s;
+    s.precision(17);
+    s << nn;
+
+    mcl::BasicNeuralNetwork loaded;
+    s >> loaded;
+    ASSERT_TRUE(s);
+    ASSERT_EQ(loaded.layers_n(), nn.layers_n());
+
+    EXPECT_EQ(loaded.activation(0), Activation::tanh);
+    EXPECT_EQ(loaded.activation(1), Activation::relu);
+    EXPECT_EQ(loaded.activation(2), Activation::softmax);
+
+    const mth::Matrix<double> x(4, 1, [] { return g_rand.rand_number(0., 1.); });
+    const auto                a = nn.query(x), b = loaded.query(x);
+    for (size_t i = 0; i < a.size(); ++i) EXPECT_NEAR(a.data()[i], b.data()[i], 1e-12);
+}
+
+// Runs a optimizer for a few steps, updating the parameters in 2 ranges like the parallel trainers do
+template<typename T, typename Opt>
+static auto run_optimizer(Opt opt, const std::vector<std::vector<double>> &grads) -> std::vector<T>
+{
+    const auto     n = grads.front().size();
+    std::vector<T> p(n, T(1));
+
+    opt.init(0, n);
+    for (const auto &g : grads)
+    {
+        opt.step();
+        opt.update(0, p.data(), g.data(), 0, n / 3, .5);
+        opt.update(0, p.data(), g.data(), n / 3, n, .5);
+    }
+
+    return p;
+}
+
+TEST(optimizer, updates_match_reference_loops)
+{
+    const size_t n = 37;
+
+    std::vector<std::vector<double>> grads(5, std::vector<double>(n));
+    for (auto &g : grads)
+        for (auto &x : g) x = g_rand.rand_number(-1., 1.);
+
+    std::vector<double> sgd(n, 1.), mom(n, 1.), rms(n, 1.), adam(n, 1.);
+    std::vector<double> v(n, 0.), s(n, 0.), m1(n, 0.), m2(n, 0.);
+
+    for (size_t t = 1; t <= grads.size(); ++t)
+        for (size_t i = 0; i < n; ++i)
+        {
+            const auto g = grads[t - 1][i] * .5;
+
+            sgd[i] += .1 * g;
+
+            v[i] = .9 * v[i] + .01 * g;
+            mom[i] += v[i];
+
+            s[i] = .9 * s[i] + .1 * g * g;
+            rms[i] += .001 * g / (std::sqrt(s[i]) + 1e-8);
+
+            m1[i]            = .9 * m1[i] + .1 * g;
+            m2[i]            = .999 * m2[i] + .001 * g * g;
+            const auto m_hat = m1[i] / (1. - std::pow(.9, double(t)));
+            const auto v_hat = m2[i] / (1. - std::pow(.999, double(t)));
+            adam[i] += .001 * m_hat / (std::sqrt(v_hat) + 1e-8);
+        }
+
+    const auto expect_near = [](const auto &a, const std::vector<double> &b, double tolerance) {
+        for (size_t i = 0; i < b.size(); ++i) EXPECT_NEAR(double(a[i]), b[i], tolerance);
+    };
+
+    expect_near(run_optimizer<double>(mcl::SGD(), grads), sgd, 1e-12);
+    expect_near(run_optimizer<double>(mcl::Momentum(), grads), mom, 1e-12);
+    expect_near(run_optimizer<double>(mcl::RMSProp(), grads), rms, 1e-12);
+    expect_near(run_optimizer<double>(mcl::Adam(), grads), adam, 1e-12);
+
+    // Other parameter types take the scalar path and are rounded once per step
+    expect_near(run_optimizer<float>(mcl::Adam(), grads), adam, 1e-6);
+}
+
+TEST(optimizer, fit_descends_with_every_optimizer)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork start({ 2, 8, 1 }, { Activation::tanh, Activation::sigmoid },
+                                        [i = 0]() mutable { return std::sin(double(++i)); });
+
+    const auto x = mth::Matrix<double>(2, 1, { .3, -.6 });
+    const auto y = mth::Matrix<double>(1, 1, .8);
+
+    const auto error = [&](const auto &nn) { return std::abs(nn.query(x)[0] - .8); };
+
+    const auto check = [&](auto opt) {
+        auto nn = start;
+        for (int i = 0; i < 200; ++i) mcl::fit(nn, x, y, opt);
+        EXPECT_LT(error(nn), error(start) / 10.);
+    };
+
+    check(mcl::SGD(.5));
+    check(mcl::Momentum(.1));
+    check(mcl::RMSProp(.01));
+    check(mcl::Adam(.01));
+}
+
+TEST(neural_net, checkpoint_round_trip)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork nn({ 5, 7, 3 }, { Activation::relu, Activation::softmax },
+                                     [] { return g_rand.rand_number(-1., 1.); });
+
+    const auto equal = [&](const auto &loaded) {
+        ASSERT_EQ(loaded.layers_n(), nn.layers_n());
+        for (auto [a, b] = std::pair(nn.begin(), loaded.begin()); a != nn.end(); ++a, ++b)
+        {
+            EXPECT_EQ(a->activation, b->activation);
+            for (size_t i = 0; i < a->weights.size(); ++i) EXPECT_EQ(a->weights.data()[i], b->weights.data()[i]);
+            for (size_t i = 0; i < a->biases.size(); ++i) EXPECT_EQ(a->biases.data()[i], b->biases.data()[i]);
+        }
+    };
+
+    // Own alignment is copied in one go, others are converted layer by layer
+    for (const size_t alignment : { 64, 8, 256 })
+    {
+        std::stringstream s;
+        mcl::save(s, nn, alignment);
+        equal(mcl::load(s));
+    }
+
+    std::stringstream s;
+    mcl::save(s, nn);
+    const auto f = mcl::load<float>(s);
+    EXPECT_FLOAT_EQ(f.begin()->weights.data()[3], static_cast<float>(nn.begin()->weights.data()[3]));
+
+    const auto path = std::filesystem::temp_directory_path() / "ctl_test.ckpt";
+    mcl::save(path, nn);
+    equal(mcl::load(path));
+    equal(mcl::MappedNeuralNetwork(path).to_network());
+    std::filesystem::remove(path);
+}
+
+TEST(neural_net, assigning_layer_views_copies_parameters)
+{
+    using mcl::Activation;
+
+    mcl::BasicNeuralNetwork a({ 3, 4, 2 }, { Activation::tanh, Activation::sigmoid },
+                              [] { return g_rand.rand_number(-1., 1.); });
+    mcl::BasicNeuralNetwork b({ 3, 4, 2 }, { Activation::tanh, Activation::sigmoid },
+                              [] { return g_rand.rand_number(-1., 1.); });
+
+    a.weights(0) = b.weights(0);
+    a.biases(0)  = b.biases(0);
+    EXPECT_EQ(max_difference(a.weights(0), b.weights(0)), 0.);
+    EXPECT_EQ(max_difference(a.biases(0), b.biases(0)), 0.);
+    EXPECT_NE(a.weights(0).data(), b.weights(0).data());
+
+    // A named view is rebound instead
+    const mth::Matrix<double> before(a.weights(1));
+    auto                      view = a.weights(1);
+    view                           = b.weights(1);
+    EXPECT_EQ(view.data(), b.weights(1).data());
+    EXPECT_EQ(max_difference(a.weights(1), before), 0.);
+}
+
+TEST(neural_net, checkpoint_rejects_overflowing_sizes)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork nn({ 3, 5, 2 }, { Activation::relu, Activation::sigmoid },
+                                   [] { return g_rand.rand_number(-1., 1.); });
+
+    std::stringstream s;
+    mcl::save(s, nn);
+    const auto good = s.str();
+
+    const auto set = [](std::string &bytes, size_t offset, std::uint64_t v) {
+        std::memcpy(bytes.data() + offset, &v, sizeof(v));
+    };
+    const auto load = [](const std::string &bytes) {
+        std::stringstream in(bytes);
+        return mcl::load<double>(in);
+    };
+
+    // More parameters than the stream holds
+    auto huge = good;
+    set(huge, offsetof(mcl::NetworkHeader, data_size), std::uint64_t(1) << 50);
+    EXPECT_THROW(load(huge), std::runtime_error);
+
+    // The end of the parameter blob wraps around
+    auto wrapped = good;
+    set(wrapped, offsetof(mcl::NetworkHeader, data_size), ~std::uint64_t(0) - 64);
+    EXPECT_THROW(load(wrapped), std::runtime_error);
+
+    // rows * cols * 8 of the first layer wraps around
+    auto layer = good;
+    set(layer, sizeof(mcl::NetworkHeader) + offsetof(mcl::LayerRecord, rows), std::uint64_t(1) << 62);
+    EXPECT_THROW(load(layer), std::runtime_error);
+
+    EXPECT_EQ(load(good).parameters().size(), nn.parameters().size());
+}
+
+// Mean loss of a dataset from one query per sample
+static auto reference_loss(const mcl::BasicNeuralNetwork<double> &nn, const mth::Matrix<double> &inputs,
+                           const mth::Matrix<double> &outputs, mcl::Loss f) -> double
+{
+    const auto n = inputs.dim().w, rows = outputs.dim().h;
+
+    double sum = 0.;
+    for (size_t c = 0; c < n; ++c)
+    {
+        const auto pred = nn.query(mth::Matrix<double>(inputs.block(0, c, inputs.dim().h, 1)));
+
+        for (size_t r = 0; r < rows; ++r)
+        {
+            const auto y = outputs[r * n + c];
+            if (f == mcl::Loss::mse)
+                sum += (pred[r] - y) * (pred[r] - y);
+            else if (y != 0.)
+                sum -= y * std::log(pred[r]);
+        }
+    }
+
+    return sum / double(f == mcl::Loss::mse ? n * rows : n);
+}
+
+TEST(loss, matches_per_sample_queries)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork<double> nn({ 5, 9, 3 }, { Activation::relu, Activation::softmax },
+                                             [] { return g_rand.rand_number(-1., 1.); });
+
+    const size_t n      = 70;
+    const auto   inputs = random_matrix(5, n);
+
+    mth::Matrix<double> outputs(3, n, 0.);
+    for (size_t c = 0; c < n; ++c) outputs[(c % 3) * n + c] = 1.;
+
+    const auto pool = exe::par(exe::default_pool(), 1);
+
+    for (const auto f : { mcl::Loss::mse, mcl::Loss::cross_entropy })
+    {
+        const auto ref = reference_loss(nn, inputs, outputs, f);
+
+        // Batches that split the samples unevenly, all of them and more than there are
+        for (const size_t batch : { 1u, 16u, 70u, 256u })
+        {
+            const auto seq = mcl::loss(nn, inputs, outputs, f, batch);
+
+            EXPECT_NEAR(seq, ref, 1e-12);
+            EXPECT_EQ(mcl::loss(pool, nn, inputs, outputs, f, batch), seq);
+        }
+    }
+
+    // Views into larger matrices and an empty dataset
+    const auto wide = random_matrix(5, n + 4);
+    const auto view = wide.block(0, 2, 5, n);
+    EXPECT_NEAR(mcl::loss(nn, view, outputs), reference_loss(nn, mth::Matrix<double>(view), outputs, mcl::Loss::mse),
+                1e-12);
+    EXPECT_EQ(mcl::loss(nn, inputs.block(0, 0, 5, 0), outputs.block(0, 0, 3, 0)), 0.);
+}
+
+TEST(neural_net, frozen_inference_matches_query)
+{
+    using mcl::Activation;
+
+    const mcl::BasicNeuralNetwork nn({ 9, 20, 11, 4 }, { Activation::relu, Activation::tanh, Activation::softmax },
+                                   [] { return g_rand.rand_number(-1., 1.); });
+    mcl::FrozenNeuralNetwork frozen(nn);
+
+    ASSERT_EQ(frozen.inputs(), 9u);
+    ASSERT_EQ(frozen.outputs(), 4u);
+
+    for (size_t c = 0; c < 7; ++c)
+    {
+        const auto x = random_matrix(9, 1);
+        const auto y = nn.query(x);
+
+        std::vector<float> in(9), out(4);
+        for (size_t r = 0; r < 9; ++r) in[r] = float(x[r]);
+        frozen.infer(in, out);
+
+        for (size_t r = 0; r < 4; ++r) EXPECT_NEAR(out[r], y[r], 1e-5);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Convolution
+// -----------------------------------------------------------------------------
+
+// Half the summed squared error, whose gradient fit descends
+static auto half_sse(const mcl::ConvNeuralNetwork<> &nn, const mth::Matrix<double> &x, const mth::Matrix<double> &y)
+    -> double
+{
+    const auto p = nn.query(x);
+
+    double s = 0.;
+    for (size_t i = 0; i < p.size(); ++i) s += .5 * (y[i] - p[i]) * (y[i] - p[i]);
+
+    return s;
+}
+
+// Compares the step of fit with a learning rate of 1 against central differences of the loss
+template<typename Build>
+static void check_gradients(mcl::Shape in, size_t batch, Build build)
+{
+    mcl::ConvNeuralNetwork<> nn(in);
+    build(nn);
+    nn.initialize([] { return g_rand.rand_number(-.5, .5); });
+
+    const auto x = random_matrix(in.size(), batch);
+    const auto y = mth::Matrix<double>(nn.output_shape().size(), batch, [] { return g_rand.rand_number(0., 1.); });
+
+    auto stepped = nn;
+    mcl::fit(stepped, x, y, 1.);
+
+    const auto p = nn.parameters();
+    for (size_t i = 0; i < p.size(); ++i)
+    {
+        const auto analytic = (stepped.parameters()[i] - p[i]) * double(batch);
+
+        const auto old = p[i];
+        p[i]           = old + 1e-6;
+        const auto up  = half_sse(nn, x, y);
+        p[i]           = old - 1e-6;
+        const auto down = half_sse(nn, x, y);
+        p[i]            = old;
+
+        EXPECT_NEAR(analytic, -(up - down) / 2e-6, 1e-6) << "parameter " << i;
+    }
+}
+
+TEST(conv_net, gradients_match_finite_differences)
+{
+    using mcl::Activation;
+
+    check_gradients({ 2, 7, 6 }, 2, [](auto &nn) {
+        nn.add_conv2d(3, 3, Activation::tanh, 2, 1);
+        nn.add_flatten();
+        nn.add_dense(2, Activation::identity);
+    });
+    check_gradients({ 2, 6, 7 }, 5, [](auto &nn) {
+        nn.add_conv2d(3, 3, Activation::leaky_relu, 1, 1);
+        nn.add_max_pool(2);
+        nn.add_conv2d(2, 3, Activation::tanh, 1, 0, mcl::ConvAlgorithm::im2col);
+        nn.add_flatten();
+        nn.add_dense(3, Activation::softmax);
+    });
+    check_gradients({ 1, 8, 8 }, 4, [](auto &nn) {
+        nn.add_conv2d(2, 3, Activation::sigmoid, 1, 0);
+        nn.add_avg_pool(3, 1);
+        nn.add_conv2d(2, 5, Activation::identity, 1, 2);
+        nn.add_flatten();
+        nn.add_dense(2, Activation::identity);
+    });
+}
+
+TEST(conv_net, convolution_algorithms_match_naive)
+{
+    const mcl::Shape in{ 3, 9, 11 };
+
+    for (const size_t pad : { 0, 1, 2 })
+        for (const size_t batch : { 1, 3, 16 })
+        {
+            mcl::ConvNeuralNetwork<> direct(in), im2col(in);
+            direct.add_conv2d(4, 3, mcl::Activation::identity, 1, pad, mcl::ConvAlgorithm::direct);
+            im2col.add_conv2d(4, 3, mcl::Activation::identity, 1, pad, mcl::ConvAlgorithm::im2col);
+            direct.initialize([] { return g_rand.rand_number(-1., 1.); });
+            std::copy_n(direct.parameters().begin(), direct.parameters().size(), im2col.parameters().begin());
+
+            const auto x  = random_matrix(in.size(), batch);
+            const auto pd = direct.query_batch(exe::par(exe::default_pool(), 1), x), pi = im2col.query(x);
+            const auto o  = direct.output_shape();
+            const auto &l = *direct.begin();
+
+            for (size_t co = 0; co < o.channels; ++co)
+                for (size_t oy = 0; oy < o.height; ++oy)
+                    for (size_t ox = 0; ox < o.width; ++ox)
+                        for (size_t n = 0; n < batch; ++n)
+                        {
+                            double s = l.biases.data()[co];
+                            for (size_t ci = 0; ci < in.channels; ++ci)
+                                for (size_t ky = 0; ky < 3; ++ky)
+                                    for (size_t kx = 0; kx < 3; ++kx)
+                                    {
+                                        const auto iy = oy + ky, ix = ox + kx;
+                                        if (iy < pad || ix < pad || iy - pad >= in.height || ix - pad >= in.width)
+                                            continue;
+
+                                        s += l.weights.data()[co * 27 + ci * 9 + ky * 3 + kx]
+                                            * x[((ci * in.height + iy - pad) * in.width + ix - pad) * batch + n];
+                                    }
+
+                            const auto i = ((co * o.height + oy) * o.width + ox) * batch + n;
+                            EXPECT_NEAR(pd[i], s, 1e-12);
+                            EXPECT_NEAR(pi[i], s, 1e-12);
+                        }
+        }
+}
+
+// -----------------------------------------------------------------------------
+// Genetic Algorithm
+// -----------------------------------------------------------------------------
+
+struct Individual
+{
+    double score = 0.;
+    int    id    = 0;
+
+    auto fitness() const noexcept -> double { return score; }
+};
+
+struct MoveOnlyIndividual
+{
+    std::unique_ptr<double> score;
+
+    auto fitness() const noexcept -> double { return *score; }
+};
+
+TEST(genetic_algorithm, select_carries_elites_unchanged)
+{
+    std::vector<Individual> pop(8), next(8);
+    for (int i = 0; i < 8; ++i) pop[i] = { double((i * 5) % 8), i };
+
+    for (const auto selection : { mcl::Selection::roulette, mcl::Selection::rank, mcl::Selection::tournament,
+                                  mcl::Selection::universal })
+    {
+        mcl::select(
+            pop.begin(), pop.end(), next.begin(), g_rand,
+            [](const Individual &a, const Individual &) { return Individual{ a.score, -1 }; },
+            { selection, 3, 3 });
+
+        // Fittest first: scores 7, 6, 5 belong to 3, 6, 1
+        EXPECT_EQ(next[0].id, 3);
+        EXPECT_EQ(next[1].id, 6);
+        EXPECT_EQ(next[2].id, 1);
+        for (size_t i = 3; i < next.size(); ++i) EXPECT_EQ(next[i].id, -1);
+    }
+}
+
+TEST(genetic_algorithm, select_rejects_elites_of_move_only_types)
+{
+    std::vector<MoveOnlyIndividual> pop(4), next(4);
+    for (auto &p : pop) p.score = std::make_unique<double>(1.);
+
+    const auto breed = [](const MoveOnlyIndividual &a, const MoveOnlyIndividual &) {
+        return MoveOnlyIndividual{ std::make_unique<double>(*a.score) };
+    };
+
+    EXPECT_THROW(mcl::select(pop.begin(), pop.end(), next.begin(), g_rand, breed, { mcl::Selection::roulette, 2, 1 }),
+                 std::runtime_error);
+
+    mcl::select(pop.begin(), pop.end(), next.begin(), g_rand, breed);
+    for (const auto &n : next) EXPECT_TRUE(n.score);
+}
+
+TEST(genetic_algorithm, engine_is_independent_of_policy)
+{
+    std::vector<Individual> init(1000);
+    for (int i = 0; i < 1000; ++i) init[i] = { double(i % 10), i };
+
+    const auto breed = [](const Individual &a, const Individual &b, Individual &child, rnd::Mersenne &rng) {
+        child.score = (a.score + b.score) / 2. + std::uniform_real_distribution<>(-.5, .5)(rng);
+        child.id    = a.id;
+    };
+
+    exe::ThreadPool pool(2);
+    for (const auto selection : { mcl::Selection::roulette, mcl::Selection::rank, mcl::Selection::tournament,
+                                  mcl::Selection::universal })
+    {
+        mcl::GeneticEngine<Individual> seq(init, 7, { selection, 4, 5 }), par(init, 7, { selection, 4, 5 });
+        for (int g = 0; g < 4; ++g)
+        {
+            seq.evolve(breed);
+            par.evolve(exe::par(pool, 1), breed);
+        }
+
+        for (size_t i = 0; i < init.size(); ++i) EXPECT_EQ(seq.population()[i].score, par.population()[i].score);
+    }
+}
+
 auto main(int argc, char **argv) -> int
 {
     testing::InitGoogleTest(&argc, argv);